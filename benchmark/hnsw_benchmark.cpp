@@ -0,0 +1,114 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Recall against queries per second for hnsw_index over a range of ef, with brute_force_knn as
+// the baseline. Each benchmark reports `recall` (mean recall@10) and `qps` as counters.
+//
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/hnsw_index.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+	constexpr auto corpus_size = std::size_t{100'000};
+	constexpr auto query_count = std::size_t{200};
+	constexpr auto dimensions = 64;
+	constexpr auto k = std::size_t{10};
+
+	auto make_vectors(std::size_t count, unsigned seed) -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		vectors.reserve(count);
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	// Built once and shared by every benchmark
+	struct fixture {
+		std::vector<comp6771::euclidean_vector> corpus = make_vectors(corpus_size, 1);
+		std::vector<comp6771::euclidean_vector> queries = make_vectors(query_count, 2);
+		std::vector<std::vector<comp6771::neighbour>> exact =
+		   comp6771::brute_force_knn(corpus, queries, k);
+		comp6771::hnsw_index index = build(corpus);
+
+		static auto build(std::vector<comp6771::euclidean_vector> const& corpus)
+		   -> comp6771::hnsw_index {
+			auto index = comp6771::hnsw_index(dimensions);
+			index.add_all(corpus);
+			return index;
+		}
+	};
+
+	auto shared_fixture() -> fixture const& {
+		static auto const instance = fixture();
+		return instance;
+	}
+
+	void report(benchmark::State& state, double total_recall) {
+		auto const searches =
+		   static_cast<double>(state.iterations()) * static_cast<double>(query_count);
+		state.counters["recall"] = total_recall / searches;
+		state.counters["qps"] = benchmark::Counter(searches, benchmark::Counter::kIsRate);
+	}
+
+	void bm_brute_force(benchmark::State& state) {
+		auto const& f = shared_fixture();
+		auto total_recall = 0.0;
+		for (auto _ : state) {
+			for (auto q = std::size_t{0}; q < query_count; ++q) {
+				auto const found = comp6771::brute_force_knn(f.corpus, f.queries[q], k);
+				total_recall += comp6771::recall(found, f.exact[q]);
+				benchmark::DoNotOptimize(found.data());
+			}
+		}
+		report(state, total_recall);
+	}
+	BENCHMARK(bm_brute_force)->Unit(benchmark::kMillisecond);
+
+	void bm_hnsw_search(benchmark::State& state) {
+		auto const& f = shared_fixture();
+		auto const ef = static_cast<std::size_t>(state.range(0));
+		auto total_recall = 0.0;
+		for (auto _ : state) {
+			for (auto q = std::size_t{0}; q < query_count; ++q) {
+				auto const found = f.index.search(f.queries[q], k, ef);
+				total_recall += comp6771::recall(found, f.exact[q]);
+				benchmark::DoNotOptimize(found.data());
+			}
+		}
+		report(state, total_recall);
+	}
+	BENCHMARK(bm_hnsw_search)
+	   ->ArgName("ef")
+	   ->Arg(10)
+	   ->Arg(20)
+	   ->Arg(40)
+	   ->Arg(80)
+	   ->Arg(160)
+	   ->Arg(320)
+	   ->Unit(benchmark::kMillisecond);
+
+	void bm_hnsw_build(benchmark::State& state) {
+		auto const& f = shared_fixture();
+		for (auto _ : state) {
+			auto const index = fixture::build(f.corpus);
+			benchmark::DoNotOptimize(index.size());
+		}
+		auto const inserts =
+		   static_cast<double>(state.iterations()) * static_cast<double>(corpus_size);
+		state.counters["inserts_per_second"] =
+		   benchmark::Counter(inserts, benchmark::Counter::kIsRate);
+	}
+	BENCHMARK(bm_hnsw_build)->Unit(benchmark::kSecond)->Iterations(1);
+} // namespace
@@ -0,0 +1,70 @@
+#ifndef COMP6771_BALL_TREE_HPP
+#define COMP6771_BALL_TREE_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// Static ball tree for exact Euclidean search. It shares kd_tree's implicit layout and median
+	// splits, but bounds each node by a ball around its centroid rather than by a splitting plane.
+	// That prunes better on clustered data and degrades more gently as the dimension grows, at the
+	// cost of a centroid and radius per node.
+	//
+	// Results identify vectors by their position in the span the tree was built from, and report
+	// Euclidean distances, closest first with ties broken by id. A built tree is read-only, so any
+	// number of queries may run concurrently.
+	class ball_tree {
+	public:
+		explicit ball_tree(std::span<euclidean_vector const> vectors,
+		                   std::size_t leaf_size = 16,
+		                   thread_pool& pool = default_thread_pool());
+
+		// 0 for an empty tree
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		std::size_t size() const noexcept {
+			return ids_.size();
+		}
+
+		auto knn(euclidean_vector const& query, std::size_t k) const -> std::vector<neighbour>;
+		// Every vector within `radius` of `query`, inclusive
+		auto radius_search(euclidean_vector const& query, double radius) const
+		   -> std::vector<neighbour>;
+		// Whether any vector lies within `radius` of `query`. Stops at the first one found.
+		auto any_within(euclidean_vector const& query, double radius) const -> bool;
+
+		// Batched forms, with the queries shared out across `pool`
+		auto knn(std::span<euclidean_vector const> queries,
+		         std::size_t k,
+		         thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<std::vector<neighbour>>;
+		auto radius_search(std::span<euclidean_vector const> queries,
+		                   double radius,
+		                   thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<std::vector<neighbour>>;
+
+	private:
+		int dimensions_ = 0;
+		int depth_ = 0;
+		std::vector<double> arena_;
+		std::vector<std::size_t> ids_;
+		// One centroid per node, in heap order
+		std::vector<double> centres_;
+		// Distance from each node's centroid to its furthest vector; negative for an empty leaf
+		std::vector<double> radii_;
+
+		auto row(std::size_t i) const noexcept -> double const*;
+		auto centre(std::size_t node) const noexcept -> double const*;
+		template<typename Visit>
+		auto visit_within(double const* query, double radius, Visit& visit) const -> bool;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_BALL_TREE_HPP
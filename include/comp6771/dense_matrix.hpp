@@ -0,0 +1,100 @@
+#ifndef COMP6771_DENSE_MATRIX_HPP
+#define COMP6771_DENSE_MATRIX_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/euclidean_vector_view.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	enum class matrix_layout { row_major, column_major };
+
+	class dense_matrix {
+	public:
+		dense_matrix() noexcept;
+		dense_matrix(int rows, int cols, matrix_layout layout = matrix_layout::row_major);
+		dense_matrix(int rows, int cols, double value, matrix_layout layout = matrix_layout::row_major);
+
+		// One matrix row per euclidean_vector; all of them must have the same dimensions
+		static auto from_rows(std::span<euclidean_vector const> rows,
+		                      matrix_layout layout = matrix_layout::row_major) -> dense_matrix;
+		// One matrix column per euclidean_vector; all of them must have the same dimensions
+		static auto from_columns(std::span<euclidean_vector const> columns,
+		                         matrix_layout layout = matrix_layout::row_major) -> dense_matrix;
+
+		int rows() const noexcept {
+			return rows_;
+		}
+
+		int cols() const noexcept {
+			return cols_;
+		}
+
+		matrix_layout layout() const noexcept {
+			return layout_;
+		}
+
+		// Distance in elements between (r, c) and (r + 1, c), and between (r, c) and (r, c + 1)
+		std::ptrdiff_t row_stride() const noexcept {
+			return layout_ == matrix_layout::row_major ? cols_ : 1;
+		}
+
+		std::ptrdiff_t col_stride() const noexcept {
+			return layout_ == matrix_layout::row_major ? 1 : rows_;
+		}
+
+		double& operator()(int row, int col) noexcept {
+			return values_[offset(row, col)];
+		}
+
+		double operator()(int row, int col) const noexcept {
+			return values_[offset(row, col)];
+		}
+
+		double* data() noexcept {
+			return values_.data();
+		}
+
+		double const* data() const noexcept {
+			return values_.data();
+		}
+
+		// Views stay valid until the matrix is destroyed or assigned to
+		auto row(int index) const noexcept -> euclidean_vector_view {
+			return euclidean_vector_view(values_.data() + index * row_stride(), cols_, col_stride());
+		}
+
+		auto column(int index) const noexcept -> euclidean_vector_view {
+			return euclidean_vector_view(values_.data() + index * col_stride(), rows_, row_stride());
+		}
+
+	private:
+		std::vector<double> values_;
+		int rows_;
+		int cols_;
+		matrix_layout layout_;
+
+		std::size_t offset(int row, int col) const noexcept {
+			return static_cast<std::size_t>(row * row_stride() + col * col_stride());
+		}
+	};
+
+	// y = A x
+	auto gemv(dense_matrix const& a, euclidean_vector_view x) -> euclidean_vector;
+	// y = alpha A x + beta y, in place. y may be viewed by x.
+	auto gemv(double alpha,
+	          dense_matrix const& a,
+	          euclidean_vector_view x,
+	          double beta,
+	          euclidean_vector& y) -> euclidean_vector&;
+
+	// C = A B, laid out like A
+	auto gemm(dense_matrix const& a, dense_matrix const& b) -> dense_matrix;
+	// C = alpha A B + beta C, in place. C must not share storage with A or B.
+	auto gemm(double alpha, dense_matrix const& a, dense_matrix const& b, double beta, dense_matrix& c)
+	   -> dense_matrix&;
+} // namespace comp6771
+
+#endif // COMP6771_DENSE_MATRIX_HPP
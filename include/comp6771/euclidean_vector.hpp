@@ -1,15 +1,39 @@
 #ifndef COMP6771_EUCLIDEAN_VECTOR_HPP
 #define COMP6771_EUCLIDEAN_VECTOR_HPP
 
+#include <comp6771/thread_pool.hpp>
+
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <list>
-#include <memory>
+#include <ranges>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// Index policy used by euclidean_vector::operator[]. Define as one of `unchecked`, `debug_assert`
+// or `checked` before including this header to change it for a build.
+#ifndef COMP6771_EUCLIDEAN_VECTOR_INDEX_POLICY
+#define COMP6771_EUCLIDEAN_VECTOR_INDEX_POLICY unchecked
+#endif
+
 namespace comp6771 {
+	// How element access validates its index: `checked` throws std::out_of_range, `debug_assert`
+	// asserts (and so disappears under NDEBUG), and `unchecked` trusts the caller.
+	enum class index_policy { unchecked, debug_assert, checked };
+
+	inline constexpr auto default_index_policy =
+	   index_policy::COMP6771_EUCLIDEAN_VECTOR_INDEX_POLICY;
+
 	class euclidean_vector_error : public std::runtime_error {
 	public:
 		explicit euclidean_vector_error(std::string const& what)
@@ -27,6 +51,27 @@ namespace comp6771 {
 		friend auto euclidean_norm(euclidean_vector const& v) noexcept -> double;
 		friend auto unit(euclidean_vector const& v) -> euclidean_vector;
 		friend auto dot(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto approx_equal(euclidean_vector const& x,
+		                         euclidean_vector const& y,
+		                         double abs_tol,
+		                         double rel_tol) noexcept -> bool;
+		friend auto ulp_equal(euclidean_vector const& x,
+		                      euclidean_vector const& y,
+		                      std::uint64_t max_ulps) noexcept -> bool;
+		friend auto ulp_distance(euclidean_vector const& x, euclidean_vector const& y) -> std::uint64_t;
+		friend auto hash_value(euclidean_vector const& v) noexcept -> std::size_t;
+		friend auto distance(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto squared_distance(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto manhattan_distance(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto chebyshev_distance(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto cosine_similarity(euclidean_vector const& x, euclidean_vector const& y) -> double;
+		friend auto axpy(double alpha, euclidean_vector const& x, euclidean_vector& y)
+		   -> euclidean_vector&;
+		friend auto axpby(double alpha, euclidean_vector const& x, double beta, euclidean_vector& y)
+		   -> euclidean_vector&;
+		friend auto lincomb(std::span<double const> coefficients,
+		                    std::span<euclidean_vector const> vectors,
+		                    euclidean_vector& y) -> euclidean_vector&;
 
 	public:
 		euclidean_vector() noexcept;
@@ -35,52 +80,164 @@ namespace comp6771 {
 		euclidean_vector(std::vector<double>::const_iterator,
 		                 std::vector<double>::const_iterator) noexcept;
 		euclidean_vector(std::initializer_list<double>) noexcept;
+		// Adopts the buffer of a std::vector<double> without copying its elements
+		explicit euclidean_vector(std::vector<double>&&) noexcept;
+
+		// Builds from any input range of arithmetic values. Contiguous ranges are copied (and
+		// converted, for non-double elements) in a single pass over raw pointers, and sized ranges
+		// allocate once.
+		template<std::ranges::input_range R>
+		requires std::is_arithmetic_v<std::ranges::range_value_t<R>>
+		explicit euclidean_vector(R&& range)
+		: euclidean_vector(collect(std::forward<R>(range))) {}
+
+		template<std::input_iterator I, std::sentinel_for<I> S>
+		requires std::is_arithmetic_v<std::iter_value_t<I>>
+		euclidean_vector(I first, S last)
+		: euclidean_vector(collect(std::ranges::subrange(std::move(first), std::move(last)))) {}
+
 		euclidean_vector(euclidean_vector const&) noexcept;
 		euclidean_vector(euclidean_vector&&) noexcept;
 		~euclidean_vector() = default;
 
+		// Same as the std::vector<double>&& constructor, spelled out for readability at call sites
+		static auto from(std::vector<double>&&) noexcept -> euclidean_vector;
+		// Hands the underlying buffer back as a std::vector<double>, leaving this object with
+		// zero dimensions
+		auto release_to_vector() && noexcept -> std::vector<double>;
+
 		euclidean_vector& operator=(euclidean_vector const&) noexcept;
 		euclidean_vector& operator=(euclidean_vector&&) noexcept;
-		double& operator[](int index) noexcept;
-		double operator[](int index) const noexcept;
+		double& operator[](int index) noexcept(default_index_policy != index_policy::checked) {
+			return this->at<default_index_policy>(index);
+		}
+
+		double operator[](int index) const noexcept(default_index_policy != index_policy::checked) {
+			return this->at<default_index_policy>(index);
+		}
+
 		euclidean_vector operator+() const noexcept;
 		euclidean_vector operator-() const noexcept;
 		euclidean_vector& operator+=(euclidean_vector const&);
 		euclidean_vector& operator-=(euclidean_vector const&);
 		euclidean_vector& operator*=(double) noexcept;
 		euclidean_vector& operator/=(double);
-		double at(int) const;
-		double& at(int);
+		// Scales this vector to unit length in place, reusing the cached norm. Multiplies by the
+		// reciprocal of the norm, so elements may differ from unit()'s by an ulp.
+		euclidean_vector& normalize();
+
+		double at(int index) const {
+			return this->at<index_policy::checked>(index);
+		}
+
+		double& at(int index) {
+			return this->at<index_policy::checked>(index);
+		}
+
+		// Element access with an explicit index policy, e.g. `v.at<index_policy::unchecked>(i)` in
+		// loops whose indices are already validated
+		template<index_policy Policy>
+		double at(int index) const noexcept(Policy != index_policy::checked) {
+			this->check_index<Policy>(index);
+			return this->magnitude_.data()[index];
+		}
+
+		template<index_policy Policy>
+		double& at(int index) noexcept(Policy != index_policy::checked) {
+			this->check_index<Policy>(index);
+			this->update_altered();
+			return this->magnitude_.data()[index];
+		}
 
 		int dimensions() const noexcept {
-			return dim_;
+			return static_cast<int>(magnitude_.size());
+		}
+
+		// Read-only access to the contiguous magnitudes, for kernels outside this class
+		double const* data() const noexcept {
+			return magnitude_.data();
+		}
+
+		// Writable access for in-place kernels. Invalidates the cached norm and hash, so finish
+		// writing before the next query of either.
+		double* mutable_data() noexcept {
+			this->update_altered();
+			return magnitude_.data();
+		}
+
+		explicit operator std::vector<double>() const& noexcept {
+			return std::vector<double>(magnitude_.begin(), magnitude_.end());
 		}
 
-		explicit operator std::vector<double>() const noexcept {
-			auto vector = std::vector<double>(static_cast<size_t>(this->dimensions()));
-			std::copy(this->begin(), this->end(), vector.begin());
-			return vector;
+		explicit operator std::vector<double>() && noexcept {
+			return std::move(*this).release_to_vector();
 		}
 
-		explicit operator std::list<double>() const noexcept {
+		explicit operator std::list<double>() const& noexcept {
 			auto list = std::list<double>(static_cast<size_t>(this->dimensions()));
 			std::copy(this->begin(), this->end(), list.begin());
 			return list;
 		}
 
 	private:
-		std::unique_ptr<double[]> magnitude_;
-		int dim_;
+		std::vector<double> magnitude_;
 		mutable bool altered_ = true;
 		mutable double cache_;
+		mutable bool hash_altered_ = true;
+		mutable std::size_t hash_cache_ = 0;
 
 		void swap(euclidean_vector&) noexcept;
 
+		// Kept out of line so that formatting the message never lands on the fast path
+		[[noreturn, gnu::cold]] static void throw_index_error(int index);
+
+		template<index_policy Policy>
+		void check_index(int index) const {
+			if constexpr (Policy == index_policy::checked) {
+				// A negative index wraps to a huge size_t, so one comparison covers both bounds
+				if (static_cast<size_t>(index) >= this->magnitude_.size()) [[unlikely]]
+					throw_index_error(index);
+			}
+			else if constexpr (Policy == index_policy::debug_assert) {
+				assert(static_cast<size_t>(index) < this->magnitude_.size());
+			}
+		}
+
+		template<std::ranges::input_range R>
+		static auto collect(R&& range) -> std::vector<double> {
+			if constexpr (std::ranges::contiguous_range<R> and std::ranges::sized_range<R>) {
+				// Pointer ranges hit std::vector's trivially-copyable fast path (a memmove for
+				// doubles, a vectorisable conversion loop for other arithmetic types)
+				auto const* first = std::ranges::data(range);
+				return std::vector<double>(first, first + std::ranges::size(range));
+			}
+			else {
+				auto storage = std::vector<double>();
+				if constexpr (std::ranges::sized_range<R>)
+					storage.reserve(static_cast<size_t>(std::ranges::size(range)));
+				for (auto&& value : range)
+					storage.push_back(static_cast<double>(value));
+				return storage;
+			}
+		}
+
+		// Zero dimension vectors still own an allocation so that element addresses are never shared
+		// between two objects
+		static auto make_storage(std::vector<double>&& storage) noexcept -> std::vector<double> {
+			if (storage.capacity() == 0)
+				storage.reserve(1);
+			return std::move(storage);
+		}
+
 		// Helper function for norm cache
 		void update_altered() noexcept {
 			this->altered_ = true;
+			this->hash_altered_ = true;
 		}
 
+		// Caches the norm given its fast-path square, rescaling if that square over- or underflowed
+		void cache_squared_norm(double squared_norm) const noexcept;
+
 		class Iterator {
 		public:
 			using iterator_category = std::input_iterator_tag;
@@ -181,18 +338,51 @@ namespace comp6771 {
 		};
 
 		Iterator begin() {
-			return Iterator(&magnitude_[0]);
+			return Iterator(magnitude_.data());
 		}
 		Iterator end() {
-			return Iterator(&magnitude_[static_cast<size_t>(dim_)]);
+			return Iterator(magnitude_.data() + magnitude_.size());
 		}
 		Iterator begin() const {
-			return Iterator(&magnitude_[0]);
+			return Iterator(const_cast<double*>(magnitude_.data()));
 		}
 		Iterator end() const {
-			return Iterator(&magnitude_[static_cast<size_t>(dim_)]);
+			return Iterator(const_cast<double*>(magnitude_.data()) + magnitude_.size());
 		}
 	};
 
+
+	// The batch functions below spread the collection across `pool`.
+
+	// Normalises every vector. If one of them has no unit vector, the vectors before it are
+	// normalised, the rest are left alone, and its exception is thrown, just as a loop would.
+	void normalize_all(std::span<euclidean_vector> vectors,
+	                   thread_pool& pool = default_thread_pool());
+
+	// Indices of every vector in `corpus` that compares equal (==) to `x`
+	auto find_equal(std::span<euclidean_vector const> corpus,
+	                euclidean_vector const& x,
+	                thread_pool& pool = default_thread_pool()) -> std::vector<std::size_t>;
+
+	// cosine_similarity(query, candidate) for each candidate. `query` may be one of the candidates.
+	auto cosine_similarity(euclidean_vector const& query,
+	                       std::span<euclidean_vector const> candidates,
+	                       thread_pool& pool = default_thread_pool()) -> std::vector<double>;
+
+	// Dot products, norms, distances, ==, the compound operators and the BLAS-style updates spread
+	// their work across threads for vectors with at least this many dimensions. Reductions are
+	// always summed in the same blocked order, so results do not depend on this setting or on the
+	// number of threads. Defaults to 2^20.
+	void set_parallel_threshold(std::size_t dimensions) noexcept;
+	auto parallel_threshold() noexcept -> std::size_t;
 } // namespace comp6771
+
+// Consistent with operator==: -0.0 and +0.0 hash alike, and the result is cached until the vector
+// is next modified.
+template<>
+struct std::hash<comp6771::euclidean_vector> {
+	auto operator()(comp6771::euclidean_vector const& v) const noexcept -> std::size_t {
+		return hash_value(v);
+	}
+};
 #endif // COMP6771_EUCLIDEAN_VECTOR_HPP
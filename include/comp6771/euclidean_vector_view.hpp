@@ -0,0 +1,78 @@
+#ifndef COMP6771_EUCLIDEAN_VECTOR_VIEW_HPP
+#define COMP6771_EUCLIDEAN_VECTOR_VIEW_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace comp6771 {
+	// Non-owning, read-only view of `dimensions` magnitudes spaced `stride` elements apart. Used for
+	// rows and columns of a dense_matrix and for vectors stored in index arenas. A view is only valid
+	// while the storage it refers to is alive and unmoved.
+	class euclidean_vector_view {
+	public:
+		euclidean_vector_view() noexcept = default;
+
+		euclidean_vector_view(double const* data, int dimensions, std::ptrdiff_t stride = 1) noexcept
+		: data_(data)
+		, dim_(dimensions)
+		, stride_(stride) {}
+
+		// Views the whole of an existing euclidean_vector
+		euclidean_vector_view(euclidean_vector const& v) noexcept
+		: euclidean_vector_view(v.data(), v.dimensions()) {}
+
+		int dimensions() const noexcept {
+			return dim_;
+		}
+
+		std::ptrdiff_t stride() const noexcept {
+			return stride_;
+		}
+
+		bool contiguous() const noexcept {
+			return stride_ == 1;
+		}
+
+		double const* data() const noexcept {
+			return data_;
+		}
+
+		double operator[](int index) const noexcept {
+			return data_[index * stride_];
+		}
+
+		double at(int index) const {
+			if (index < 0 or index >= dim_) {
+				throw std::out_of_range("Index " + std::to_string(index)
+				                        + " is not valid for this euclidean_vector_view object");
+			}
+			return (*this)[index];
+		}
+
+		// Copies the viewed magnitudes into an owning euclidean_vector
+		explicit operator euclidean_vector() const {
+			auto values = std::vector<double>(static_cast<std::size_t>(dim_));
+			for (auto i = 0; i < dim_; ++i)
+				values[static_cast<std::size_t>(i)] = (*this)[i];
+			return euclidean_vector::from(std::move(values));
+		}
+
+	private:
+		double const* data_ = nullptr;
+		int dim_ = 0;
+		std::ptrdiff_t stride_ = 1;
+	};
+
+	// These mirror the euclidean_vector friends of the same names (including their exceptions), and
+	// accept euclidean_vectors through the implicit conversion.
+	auto dot(euclidean_vector_view x, euclidean_vector_view y) -> double;
+	auto squared_distance(euclidean_vector_view x, euclidean_vector_view y) -> double;
+	auto distance(euclidean_vector_view x, euclidean_vector_view y) -> double;
+	auto euclidean_norm(euclidean_vector_view v) noexcept -> double;
+} // namespace comp6771
+
+#endif // COMP6771_EUCLIDEAN_VECTOR_VIEW_HPP
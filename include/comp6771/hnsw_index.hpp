@@ -0,0 +1,136 @@
+#ifndef COMP6771_HNSW_INDEX_HPP
+#define COMP6771_HNSW_INDEX_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/euclidean_vector_view.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace comp6771 {
+	struct hnsw_parameters {
+		// Links kept per vector on the upper layers; layer 0 keeps twice as many
+		std::size_t m = 16;
+		// Candidate list size while inserting. Larger builds a better graph, more slowly.
+		std::size_t ef_construction = 200;
+		// Default candidate list size while searching; at least k is always used
+		std::size_t ef_search = 64;
+		std::uint64_t seed = 0;
+	};
+
+	// Hierarchical navigable small world graph (Malkov and Yashunin, 2018) for approximate nearest
+	// neighbour search. Vectors are copied into one contiguous arena, and ids are assigned in
+	// insertion order starting at 0.
+	//
+	// add_all() inserts in parallel, with each vector's links guarded by a striped lock. Searches
+	// may run concurrently with each other, but not with insertion.
+	class hnsw_index {
+	public:
+		explicit hnsw_index(int dimensions,
+		                    search_metric metric = search_metric::l2,
+		                    hnsw_parameters const& parameters = {});
+
+		hnsw_index(hnsw_index&&) noexcept;
+		hnsw_index& operator=(hnsw_index&&) noexcept;
+		~hnsw_index();
+
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		search_metric metric() const noexcept {
+			return metric_;
+		}
+
+		hnsw_parameters const& parameters() const noexcept {
+			return parameters_;
+		}
+
+		std::size_t size() const noexcept {
+			return levels_.size();
+		}
+
+		void set_ef_search(std::size_t ef) noexcept {
+			parameters_.ef_search = ef;
+		}
+
+		// Makes room for `capacity` vectors in total, so that later insertions do not reallocate
+		void reserve(std::size_t capacity);
+
+		// Returns the new vector's id
+		auto add(euclidean_vector const& v) -> std::size_t;
+		// Returns the id of the first vector; the rest follow in order
+		auto add_all(std::span<euclidean_vector const> vectors, thread_pool& pool = default_thread_pool())
+		   -> std::size_t;
+
+		// Up to k approximate nearest neighbours, closest first
+		auto search(euclidean_vector const& query, std::size_t k) const -> std::vector<neighbour>;
+		auto search(euclidean_vector const& query, std::size_t k, std::size_t ef) const
+		   -> std::vector<neighbour>;
+
+		// The stored copy of a vector. Valid until the next insertion.
+		auto view(std::size_t id) const noexcept -> euclidean_vector_view {
+			return euclidean_vector_view(arena_.data() + id * static_cast<std::size_t>(dimensions_),
+			                             dimensions_);
+		}
+
+		// Binary format in native byte order, holding the graph, the arena and the level generator
+		// state, so that a loaded index continues exactly where the saved one left off
+		void save(std::string const& path) const;
+		static auto load(std::string const& path) -> hnsw_index;
+
+	private:
+		struct visited_list;
+		struct search_state;
+
+		int dimensions_;
+		search_metric metric_;
+		hnsw_parameters parameters_;
+
+		std::vector<double> arena_;
+		std::vector<int> levels_;
+		// Layer 0 links, (1 + 2m) per vector: a count followed by the ids
+		std::vector<std::uint32_t> base_links_;
+		// Layers 1 to level for each vector, (1 + m) per layer
+		std::vector<std::vector<std::uint32_t>> upper_links_;
+
+		std::uint32_t entry_point_ = 0;
+		int max_level_ = -1;
+		std::mt19937_64 level_generator_;
+
+		std::unique_ptr<search_state> state_;
+
+		auto stored(std::uint32_t id) const noexcept -> double const*;
+		auto distance(double const* x, double const* y) const noexcept -> double;
+		auto links(std::uint32_t id, int layer) noexcept -> std::uint32_t*;
+		auto links(std::uint32_t id, int layer) const noexcept -> std::uint32_t const*;
+		auto max_links(int layer) const noexcept -> std::size_t;
+		auto random_level() -> int;
+		// Whether every level and link is in range, so that a loaded graph is safe to search
+		auto graph_consistent() const noexcept -> bool;
+
+		template<bool Locked>
+		auto search_layer(double const* query,
+		                  std::vector<neighbour> const& entry_points,
+		                  std::size_t ef,
+		                  int layer) const -> std::vector<neighbour>;
+		template<bool Locked>
+		void copy_links(std::uint32_t id, int layer, std::vector<std::uint32_t>& out) const;
+		template<bool Locked>
+		auto greedy_closest(double const* query, neighbour entry, int from_layer, int to_layer) const
+		   -> neighbour;
+		auto select_neighbours(std::vector<neighbour> candidates, std::size_t limit) const
+		   -> std::vector<neighbour>;
+		void connect(std::uint32_t id, std::vector<neighbour> const& neighbours, int layer);
+		void insert(std::uint32_t id);
+	};
+} // namespace comp6771
+
+#endif // COMP6771_HNSW_INDEX_HPP
@@ -0,0 +1,95 @@
+#ifndef COMP6771_INCREMENTAL_PCA_HPP
+#define COMP6771_INCREMENTAL_PCA_HPP
+
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// Principal component analysis over a stream of vectors, without holding the stream or its
+	// covariance matrix in memory. Only the running mean and the top `components` singular vectors
+	// and values of the centred data seen so far are kept.
+	//
+	// Each update is the incremental SVD of Ross et al. (2008): the current basis scaled by its
+	// singular values is stacked with the new batch centred on its own mean, and one row
+	// correcting for the shift in mean. The top components of that small stack are exactly those
+	// of all the data seen, so the result does not depend on how the stream is split into batches
+	// beyond rounding and the components discarded along the way.
+	//
+	// Components are orthonormal, ordered by decreasing variance, and each is signed so that its
+	// largest coordinate is positive. Fewer than `components` are available until the data seen
+	// spans that many directions.
+	class incremental_pca {
+	public:
+		incremental_pca(int dimensions, std::size_t components);
+
+		int dimensions() const noexcept {
+			return mean_.dimensions();
+		}
+
+		// The number of components asked for; components().size() may be smaller
+		std::size_t max_components() const noexcept {
+			return max_components_;
+		}
+
+		std::size_t samples_seen() const noexcept {
+			return samples_seen_;
+		}
+
+		auto mean() const noexcept -> euclidean_vector const& {
+			return mean_;
+		}
+
+		auto components() const noexcept -> std::span<euclidean_vector const> {
+			return components_;
+		}
+
+		auto singular_values() const noexcept -> std::span<double const> {
+			return singular_values_;
+		}
+
+		// Sample variance along each component, and its share of the total variance
+		auto explained_variance() const -> std::vector<double>;
+		auto explained_variance_ratio() const -> std::vector<double>;
+
+		void partial_fit(euclidean_vector const& sample);
+		// Large batches are folded in a block at a time. Centring, the stacked products and the
+		// new components are computed in parallel on `pool`.
+		void partial_fit(std::span<euclidean_vector const> samples,
+		                 thread_pool& pool = default_thread_pool());
+
+		// Coordinates of `v - mean()` along each component
+		auto transform(euclidean_vector const& v) const -> euclidean_vector;
+		// transform() for each vector, a gemm per block of vectors
+		auto transform_all(std::span<euclidean_vector const> vectors,
+		                   thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<euclidean_vector>;
+		// mean() plus the components weighted by `coordinates`
+		auto inverse_transform(euclidean_vector const& coordinates) const -> euclidean_vector;
+
+	private:
+		std::size_t max_components_;
+		std::size_t samples_seen_ = 0;
+		euclidean_vector mean_;
+		// Sum of squared distances of every sample from the mean
+		double squared_deviation_ = 0.0;
+
+		std::vector<euclidean_vector> components_;
+		std::vector<double> singular_values_;
+		// The components as matrix rows, and its transpose for projecting row blocks
+		dense_matrix basis_;
+		dense_matrix basis_by_column_;
+		// The coordinates of the mean, subtracted from every projection
+		std::vector<double> projected_mean_;
+
+		void update(std::span<euclidean_vector const> block, thread_pool& pool);
+		void set_components(std::vector<euclidean_vector> components,
+		                    std::vector<double> singular_values);
+	};
+} // namespace comp6771
+
+#endif // COMP6771_INCREMENTAL_PCA_HPP
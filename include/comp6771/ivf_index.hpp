@@ -0,0 +1,113 @@
+#ifndef COMP6771_IVF_INDEX_HPP
+#define COMP6771_IVF_INDEX_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/kmeans.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/product_quantizer.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	struct ivf_parameters {
+		// Number of posting lists, which is the k of the coarse k-means
+		std::size_t lists = 256;
+		// Lists searched per query by default
+		std::size_t nprobe = 8;
+		// 0 keeps every vector in full. Otherwise each vector is stored as the product-quantized
+		// code, this many bytes long, of its residual from its list's centroid (IVFADC).
+		std::size_t code_size = 0;
+		kmeans_options kmeans = {};
+	};
+
+	// Inverted-file index (Sivic and Zisserman, 2003; Jegou et al., 2011). A coarse k-means splits
+	// the space into cells, and each vector is filed in the posting list of its nearest centroid.
+	// A query only scans the nprobe lists whose centroids are closest to it (largest dot product
+	// for inner_product), which are searched in parallel.
+	//
+	// Each list stores its vectors (or codes) contiguously in one slab, so a scan streams through
+	// memory. Ids are assigned in insertion order starting at 0. Searches may run concurrently with
+	// each other, but not with insertion.
+	class ivf_index {
+	public:
+		// Trains the coarse quantizer (and, with a code size, the residual quantizer) on a sample of
+		// the data. The index starts empty.
+		static auto train(std::span<euclidean_vector const> training,
+		                  search_metric metric = search_metric::l2,
+		                  ivf_parameters const& parameters = {},
+		                  thread_pool& pool = default_thread_pool()) -> ivf_index;
+
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		search_metric metric() const noexcept {
+			return metric_;
+		}
+
+		ivf_parameters const& parameters() const noexcept {
+			return parameters_;
+		}
+
+		std::size_t size() const noexcept {
+			return size_;
+		}
+
+		auto centroids() const noexcept -> std::span<euclidean_vector const> {
+			return centroids_;
+		}
+
+		auto list_size(std::size_t list) const noexcept -> std::size_t {
+			return lists_[list].ids.size();
+		}
+
+		void set_nprobe(std::size_t nprobe) noexcept {
+			parameters_.nprobe = nprobe;
+		}
+
+		// Returns the new vector's id
+		auto add(euclidean_vector const& v) -> std::size_t;
+		// Returns the id of the first vector; the rest follow in order
+		auto add_all(std::span<euclidean_vector const> vectors,
+		             thread_pool& pool = default_thread_pool()) -> std::size_t;
+
+		// Approximate k nearest neighbours, closest first with ties broken by id. Distances are
+		// exact for full vectors, and asymmetric distance estimates for codes.
+		auto search(euclidean_vector const& query,
+		            std::size_t k,
+		            thread_pool& pool = default_thread_pool()) const -> std::vector<neighbour>;
+		auto search(euclidean_vector const& query,
+		            std::size_t k,
+		            std::size_t nprobe,
+		            thread_pool& pool = default_thread_pool()) const -> std::vector<neighbour>;
+
+	private:
+		struct posting_list {
+			std::vector<std::size_t> ids;
+			// One row of dimensions() magnitudes per vector, or of code_size bytes per code
+			std::vector<double> vectors;
+			std::vector<std::uint8_t> codes;
+		};
+
+		int dimensions_ = 0;
+		search_metric metric_ = search_metric::l2;
+		ivf_parameters parameters_;
+		std::vector<euclidean_vector> centroids_;
+		std::optional<product_quantizer> residual_quantizer_;
+		std::vector<posting_list> lists_;
+		std::size_t size_ = 0;
+
+		ivf_index() = default;
+		auto probe_order(euclidean_vector const& query, std::size_t nprobe) const
+		   -> std::vector<std::size_t>;
+		auto scan(std::size_t list, euclidean_vector const& query, std::size_t k) const
+		   -> std::vector<neighbour>;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_IVF_INDEX_HPP
@@ -0,0 +1,73 @@
+#ifndef COMP6771_KD_TREE_HPP
+#define COMP6771_KD_TREE_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// Static k-d tree for exact Euclidean search in low dimensions (roughly 2 to 10; above that
+	// brute_force_knn or hnsw_index usually wins).
+	//
+	// The tree is balanced and implicit: nodes are stored in heap order, and the vectors are copied
+	// into one arena in tree order so that every leaf is a contiguous block of at most `leaf_size`
+	// rows. Each internal node splits at the median of its widest dimension. Results identify
+	// vectors by their position in the span the tree was built from, and report Euclidean
+	// distances, closest first with ties broken by id. A built tree is read-only, so any number of
+	// queries may run concurrently.
+	class kd_tree {
+	public:
+		explicit kd_tree(std::span<euclidean_vector const> vectors,
+		                 std::size_t leaf_size = 16,
+		                 thread_pool& pool = default_thread_pool());
+
+		// 0 for an empty tree
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		std::size_t size() const noexcept {
+			return ids_.size();
+		}
+
+		auto knn(euclidean_vector const& query, std::size_t k) const -> std::vector<neighbour>;
+		// Every vector within `radius` of `query`, inclusive
+		auto radius_search(euclidean_vector const& query, double radius) const
+		   -> std::vector<neighbour>;
+		// Whether any vector lies within `radius` of `query`. Stops at the first one found.
+		auto any_within(euclidean_vector const& query, double radius) const -> bool;
+
+		// Batched forms, with the queries shared out across `pool`
+		auto knn(std::span<euclidean_vector const> queries,
+		         std::size_t k,
+		         thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<std::vector<neighbour>>;
+		auto radius_search(std::span<euclidean_vector const> queries,
+		                   double radius,
+		                   thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<std::vector<neighbour>>;
+
+	private:
+		struct split {
+			double value;
+			int dimension;
+		};
+
+		int dimensions_ = 0;
+		int depth_ = 0;
+		std::vector<double> arena_;
+		std::vector<std::size_t> ids_;
+		// One per internal node. The left child holds coordinates <= value, the right >= value.
+		std::vector<split> splits_;
+
+		auto row(std::size_t i) const noexcept -> double const*;
+		template<typename Visit>
+		auto visit_within(double const* query, double squared_radius, Visit& visit) const -> bool;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_KD_TREE_HPP
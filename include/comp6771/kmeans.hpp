@@ -0,0 +1,79 @@
+#ifndef COMP6771_KMEANS_HPP
+#define COMP6771_KMEANS_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	struct kmeans_options {
+		int max_iterations = 300;
+		// Stop once no centroid moves further than this between iterations. With 0, iterations
+		// continue until no vector changes cluster.
+		double tolerance = 0.0;
+		std::uint64_t seed = 0;
+	};
+
+	struct kmeans_result {
+		std::vector<euclidean_vector> centroids;
+		// Index into centroids of the cluster each input vector belongs to
+		std::vector<std::size_t> assignments;
+		// Sum of squared distances from each vector to its centroid
+		double inertia = 0.0;
+		int iterations = 0;
+		bool converged = false;
+	};
+
+	// k vectors from `data` chosen by k-means++ (D^2) sampling. The same seed always gives the same
+	// centroids, whatever the size of the pool.
+	auto kmeans_plus_plus(std::span<euclidean_vector const> data,
+	                      std::size_t k,
+	                      std::uint64_t seed,
+	                      thread_pool& pool = default_thread_pool()) -> std::vector<euclidean_vector>;
+
+	// Lloyd's algorithm seeded with k-means++, using Hamerly's bounds to skip most distance
+	// computations. Assignment runs across the pool, and centroid sums are accumulated per fixed
+	// chunk of the data and merged in order, so results do not depend on the number of threads.
+	// Clusters that become empty keep their previous centroid. Every vector in `data` must have the
+	// same dimensions, and their norms are cached as a side effect.
+	auto kmeans(std::span<euclidean_vector const> data,
+	            std::size_t k,
+	            kmeans_options const& options = {},
+	            thread_pool& pool = default_thread_pool()) -> kmeans_result;
+
+	// Index of the centroid nearest to x; ties go to the lowest index
+	auto nearest_centroid(std::span<euclidean_vector const> centroids, euclidean_vector const& x)
+	   -> std::size_t;
+
+	// Mini-batch k-means (Sculley, 2010) for data that arrives in batches. Each vector pulls its
+	// nearest centroid towards it with a step of 1 / (vectors seen by that centroid so far).
+	class minibatch_kmeans {
+	public:
+		explicit minibatch_kmeans(std::size_t k, std::uint64_t seed = 0);
+
+		// The first batch seeds the centroids with k-means++, so it needs at least k vectors
+		void partial_fit(std::span<euclidean_vector const> batch,
+		                 thread_pool& pool = default_thread_pool());
+
+		// Empty until the first call to partial_fit
+		auto centroids() const noexcept -> std::span<euclidean_vector const> {
+			return centroids_;
+		}
+
+		auto predict(euclidean_vector const& x) const -> std::size_t {
+			return nearest_centroid(centroids_, x);
+		}
+
+	private:
+		std::size_t k_;
+		std::uint64_t seed_;
+		std::vector<euclidean_vector> centroids_;
+		std::vector<std::size_t> counts_;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_KMEANS_HPP
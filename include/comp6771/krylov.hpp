@@ -0,0 +1,92 @@
+#ifndef COMP6771_KRYLOV_HPP
+#define COMP6771_KRYLOV_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// Computes y = A x for the system's matrix A. y already has the right dimensions and must be
+	// overwritten; it never refers to the same vector as x.
+	using linear_operator = std::function<void(euclidean_vector const& x, euclidean_vector& y)>;
+
+	struct solver_options {
+		// Products with A allowed, not counting those that recompute the residual on starting or
+		// restarting
+		std::size_t max_iterations = 1000;
+		// Converged once the residual ||b - A x|| is at most tolerance ||b||
+		double tolerance = 1e-10;
+		// GMRES only: Krylov vectors kept before restarting
+		std::size_t restart = 30;
+	};
+
+	struct solver_result {
+		std::size_t iterations = 0;
+		// The solver's own running estimate of ||b - A x||, which can drift from the true residual
+		// by a few ulps of ||b|| times the iteration count
+		double residual_norm = 0.0;
+		bool converged = false;
+	};
+
+	// Vectors and scalars for the solvers, kept between solves so that a sequence of solves of the
+	// same size allocates only during the first. The solvers allocate nothing else themselves.
+	// Their dot and axpy kernels split long vectors across the default thread pool.
+	class krylov_workspace {
+	public:
+		// `count` vectors of `dimensions`, reallocated only if they are not already that shape.
+		// Their contents are unspecified.
+		auto vectors(std::size_t count, int dimensions) -> std::span<euclidean_vector>;
+		// At least `count` scalars, set to zero
+		auto scalars(std::size_t count) -> std::span<double>;
+
+	private:
+		std::vector<euclidean_vector> vectors_;
+		std::vector<double> scalars_;
+	};
+
+	// Each solver refines the initial guess in `x` towards the solution of A x = b, leaving the
+	// final iterate there whether or not it converged. A zero b gives a zero x. A breakdown of the
+	// recurrence, such as A not being positive definite for conjugate_gradient, stops the solver
+	// early without converging.
+
+	// For symmetric positive definite A. One product with A per iteration.
+	auto conjugate_gradient(linear_operator const& a,
+	                        euclidean_vector const& b,
+	                        euclidean_vector& x,
+	                        solver_options const& options = {}) -> solver_result;
+	auto conjugate_gradient(linear_operator const& a,
+	                        euclidean_vector const& b,
+	                        euclidean_vector& x,
+	                        solver_options const& options,
+	                        krylov_workspace& workspace) -> solver_result;
+
+	// Stabilised biconjugate gradients (van der Vorst, 1992) for general A. Two products with A
+	// per iteration, each counted towards max_iterations.
+	auto bicgstab(linear_operator const& a,
+	              euclidean_vector const& b,
+	              euclidean_vector& x,
+	              solver_options const& options = {}) -> solver_result;
+	auto bicgstab(linear_operator const& a,
+	              euclidean_vector const& b,
+	              euclidean_vector& x,
+	              solver_options const& options,
+	              krylov_workspace& workspace) -> solver_result;
+
+	// Restarted GMRES (Saad and Schultz, 1986) for general A, which minimises the residual over
+	// each Krylov subspace. The basis is built with two passes of modified Gram-Schmidt, and the
+	// least-squares problem is kept triangular with Givens rotations.
+	auto gmres(linear_operator const& a,
+	           euclidean_vector const& b,
+	           euclidean_vector& x,
+	           solver_options const& options = {}) -> solver_result;
+	auto gmres(linear_operator const& a,
+	           euclidean_vector const& b,
+	           euclidean_vector& x,
+	           solver_options const& options,
+	           krylov_workspace& workspace) -> solver_result;
+} // namespace comp6771
+
+#endif // COMP6771_KRYLOV_HPP
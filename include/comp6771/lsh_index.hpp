@@ -0,0 +1,121 @@
+#ifndef COMP6771_LSH_INDEX_HPP
+#define COMP6771_LSH_INDEX_HPP
+
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace comp6771 {
+	// random_hyperplane (Charikar, 2002) hashes by the signs of random projections, so vectors at a
+	// small angle collide; results are ranked by cosine distance, 1 - cosine similarity.
+	// p_stable (Datar et al., 2004) hashes by quantized Gaussian projections, so vectors a small
+	// Euclidean distance apart collide; results are ranked by Euclidean distance.
+	enum class lsh_family { random_hyperplane, p_stable };
+
+	struct lsh_parameters {
+		// More tables find more true neighbours, at the cost of memory and query time
+		std::size_t tables = 8;
+		// Projections per table, at most 64. More bits make buckets smaller and more selective.
+		std::size_t hash_bits = 12;
+		// Width of a p_stable bucket along each projection, in the units of the data
+		double bucket_width = 4.0;
+		std::uint64_t seed = 0;
+	};
+
+	// Locality-sensitive hashing index for approximate similarity search on data that changes
+	// constantly: insertion and removal are a hash per table, with no rebalancing. Every candidate
+	// found through the tables is checked against the stored vector, so results never contain
+	// false positives, only misses.
+	//
+	// Queries may probe more buckets than the one the query hashes to, in order of how close the
+	// query is to their boundaries (multi-probe LSH, Lv et al., 2007). That trades query time for
+	// recall without more tables.
+	//
+	// Ids of removed vectors are reused by later insertions. Queries may run concurrently with each
+	// other, but not with insertion or removal.
+	class lsh_index {
+	public:
+		lsh_index(int dimensions, lsh_family family, lsh_parameters const& parameters = {});
+
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		lsh_family family() const noexcept {
+			return family_;
+		}
+
+		lsh_parameters const& parameters() const noexcept {
+			return parameters_;
+		}
+
+		// Vectors currently in the index
+		std::size_t size() const noexcept {
+			return alive_.size() - free_.size();
+		}
+
+		auto contains(std::size_t id) const noexcept -> bool {
+			return id < alive_.size() and alive_[id];
+		}
+
+		auto insert(euclidean_vector const& v) -> std::size_t;
+		// Projects each vector with its own gemv, as insert() does, spreading the vectors across
+		// `pool`, then fills the tables in parallel. Returns the id of each vector, in order.
+		auto insert_all(std::span<euclidean_vector const> vectors,
+		                thread_pool& pool = default_thread_pool()) -> std::vector<std::size_t>;
+		// Throws std::out_of_range if `id` is not in the index
+		void remove(std::size_t id);
+
+		// Ids sharing a bucket with `query` in any table, sorted and without repeats. `probes` more
+		// buckets are searched per table.
+		auto candidates(euclidean_vector const& query, std::size_t probes = 0) const
+		   -> std::vector<std::size_t>;
+		// The k closest candidates, closest first with ties broken by id
+		auto query(euclidean_vector const& query, std::size_t k, std::size_t probes = 0) const
+		   -> std::vector<neighbour>;
+		auto query(std::span<euclidean_vector const> queries,
+		           std::size_t k,
+		           std::size_t probes = 0,
+		           thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<std::vector<neighbour>>;
+
+	private:
+		using bucket = std::vector<std::uint32_t>;
+
+		int dimensions_;
+		lsh_family family_;
+		lsh_parameters parameters_;
+
+		// One row per projection, table by table
+		dense_matrix projections_;
+		// p_stable offsets, uniform in [0, bucket_width)
+		std::vector<double> shifts_;
+
+		std::vector<std::unordered_map<std::uint64_t, bucket>> tables_;
+		// Per id: the stored vector, its norm, and its key in each table
+		std::vector<double> arena_;
+		std::vector<double> norms_;
+		std::vector<std::uint64_t> keys_;
+		std::vector<char> alive_;
+		std::vector<std::size_t> free_;
+
+		auto allocate() -> std::size_t;
+		void project(euclidean_vector const& v, euclidean_vector& projected) const;
+		void store(std::size_t id, euclidean_vector const& v, double const* projected);
+		void link(std::size_t id);
+		auto table_key(double const* projected, std::size_t table) const noexcept -> std::uint64_t;
+		auto probe_keys(double const* projected, std::size_t table, std::size_t probes) const
+		   -> std::vector<std::uint64_t>;
+		auto distance_to(euclidean_vector const& query, double query_norm, std::size_t id) const
+		   noexcept -> double;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_LSH_INDEX_HPP
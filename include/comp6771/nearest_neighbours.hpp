@@ -0,0 +1,45 @@
+#ifndef COMP6771_NEAREST_NEIGHBOURS_HPP
+#define COMP6771_NEAREST_NEIGHBOURS_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// How the search functions and indexes measure closeness. inner_product ranks by the largest dot
+	// product, reported as a distance of -dot so that a smaller distance is always closer.
+	enum class search_metric { l2, inner_product };
+
+	struct neighbour {
+		// Position of the vector in the corpus, or its id in an index
+		std::size_t id;
+		// The Euclidean distance for l2, and the negated dot product for inner_product
+		double distance;
+
+		friend bool operator==(neighbour const&, neighbour const&) = default;
+	};
+
+	// Exact k nearest neighbours of `query` in `corpus`, closest first with ties broken by id
+	auto brute_force_knn(std::span<euclidean_vector const> corpus,
+	                     euclidean_vector const& query,
+	                     std::size_t k,
+	                     search_metric metric = search_metric::l2,
+	                     thread_pool& pool = default_thread_pool()) -> std::vector<neighbour>;
+
+	// brute_force_knn for each query, with the queries shared out across `pool`
+	auto brute_force_knn(std::span<euclidean_vector const> corpus,
+	                     std::span<euclidean_vector const> queries,
+	                     std::size_t k,
+	                     search_metric metric = search_metric::l2,
+	                     thread_pool& pool = default_thread_pool())
+	   -> std::vector<std::vector<neighbour>>;
+
+	// Fraction of the ids in `exact` that also appear in `approximate` (recall@k when both hold k
+	// results). 1 when `exact` is empty.
+	auto recall(std::span<neighbour const> approximate, std::span<neighbour const> exact) -> double;
+} // namespace comp6771
+
+#endif // COMP6771_NEAREST_NEIGHBOURS_HPP
@@ -0,0 +1,49 @@
+#ifndef COMP6771_ORTHONORMALIZE_HPP
+#define COMP6771_ORTHONORMALIZE_HPP
+
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace comp6771 {
+	// modified_gram_schmidt: each vector is projected out of every later vector as soon as it is
+	// normalised, with those updates shared out across the pool, and then orthogonalised against
+	// the earlier vectors a second time before it is normalised. Two passes keep the result
+	// orthonormal to rounding however ill-conditioned the input ("twice is enough").
+	// householder: Householder reflections applied a panel at a time in compact WY form (Schreiber
+	// and Van Loan, 1989), with the trailing columns updated in parallel. Orthonormal to rounding
+	// unconditionally, and the faster choice for large sets.
+	enum class orthonormalization_method { modified_gram_schmidt, householder };
+
+	// Makes `v` orthogonal to the orthonormal vectors in `basis` with two passes of modified
+	// Gram-Schmidt, and returns its remaining length; v is not normalised. coefficients[i]
+	// receives the total component removed along basis[i], so the old v is the sum of
+	// coefficients[i] * basis[i] plus the new v. v must not be one of the basis vectors.
+	auto orthogonalize(std::span<euclidean_vector const> basis,
+	                   euclidean_vector& v,
+	                   std::span<double> coefficients) -> double;
+
+	// QR factorisation of the matrix whose columns are `vectors`. Q overwrites the vectors and the
+	// k x k upper triangular R is returned, with a nonnegative diagonal.
+	//
+	// A vector whose remaining length is less than 1e-10 of its original length depends on the
+	// ones before it. modified_gram_schmidt gives it a zero column in Q and a zero diagonal entry
+	// in R. householder still gives it a unit column, orthogonal to the rest, so Q is
+	// orthonormal; only vectors past the dimensions get zero columns.
+	auto qr(std::span<euclidean_vector> vectors,
+	        orthonormalization_method method = orthonormalization_method::modified_gram_schmidt,
+	        thread_pool& pool = default_thread_pool()) -> dense_matrix;
+
+	// Replaces `vectors` with an orthonormal basis of their span and returns its size. The first i
+	// outputs span the same space as the first i inputs. Vectors that depend on the ones before
+	// them, as defined for qr(), are set to zero.
+	auto orthonormalize(
+	   std::span<euclidean_vector> vectors,
+	   orthonormalization_method method = orthonormalization_method::modified_gram_schmidt,
+	   thread_pool& pool = default_thread_pool()) -> std::size_t;
+} // namespace comp6771
+
+#endif // COMP6771_ORTHONORMALIZE_HPP
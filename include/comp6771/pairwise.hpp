@@ -0,0 +1,55 @@
+#ifndef COMP6771_PAIRWISE_HPP
+#define COMP6771_PAIRWISE_HPP
+
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <span>
+
+namespace comp6771 {
+	// Entry (i, j) compares x[i] with y[j]. The L2 metrics use ||x||^2 + ||y||^2 - 2 x.y, so they
+	// are slightly less exact than distance() for vectors that are almost equal (the squared
+	// distance is clamped at zero). cosine throws for zero vectors, like cosine_similarity().
+	enum class pairwise_metric { inner_product, squared_l2, l2, cosine };
+
+	// A block of a pairwise result: entry (i, j) compares x[row_offset + i] with y[col_offset + j]
+	struct pairwise_tile {
+		std::size_t row_offset;
+		std::size_t col_offset;
+		std::size_t rows;
+		std::size_t cols;
+		// Row-major, rows * cols entries
+		double const* values;
+
+		double operator()(std::size_t i, std::size_t j) const noexcept {
+			return values[i * cols + j];
+		}
+	};
+
+	// Computes the x.size() x y.size() result one tile (at most tile_size square) at a time and hands
+	// each tile to `on_tile`, so the whole result never has to be held in memory. on_tile is called
+	// concurrently from the threads of `pool`, and the tile is only valid during the call. Every
+	// vector in x and y must have the same dimensions. Their norms are cached as a side effect.
+	void for_each_pairwise_tile(std::span<euclidean_vector const> x,
+	                            std::span<euclidean_vector const> y,
+	                            pairwise_metric metric,
+	                            std::function<void(pairwise_tile const&)> const& on_tile,
+	                            std::size_t tile_size = 256,
+	                            thread_pool& pool = default_thread_pool());
+
+	// The full x.size() x y.size() result as a row-major matrix
+	auto pairwise_matrix(std::span<euclidean_vector const> x,
+	                     std::span<euclidean_vector const> y,
+	                     pairwise_metric metric,
+	                     thread_pool& pool = default_thread_pool()) -> dense_matrix;
+
+	// Inner products of every pair in x. Only the upper triangle is computed; the result is exactly
+	// symmetric.
+	auto gram_matrix(std::span<euclidean_vector const> x, thread_pool& pool = default_thread_pool())
+	   -> dense_matrix;
+} // namespace comp6771
+
+#endif // COMP6771_PAIRWISE_HPP
@@ -0,0 +1,123 @@
+#ifndef COMP6771_PRODUCT_QUANTIZER_HPP
+#define COMP6771_PRODUCT_QUANTIZER_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/kmeans.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+#include <comp6771/vector_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// Product quantization (Jegou, Douze and Schmid, 2011). The dimensions are cut into code_size
+	// contiguous subspaces, whose widths differ by at most one, and each subspace gets its own
+	// codebook of up to 256 centroids trained with kmeans. A vector is encoded as one byte per
+	// subspace, naming the nearest centroid in each.
+	class product_quantizer {
+	public:
+		// Trains on a sample of the data. `centroids` is clamped to the number of training vectors.
+		static auto train(std::span<euclidean_vector const> training,
+		                  std::size_t code_size,
+		                  std::size_t centroids = 256,
+		                  kmeans_options const& options = {},
+		                  thread_pool& pool = default_thread_pool()) -> product_quantizer;
+
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		// Bytes per encoded vector, which is also the number of subspaces
+		std::size_t code_size() const noexcept {
+			return offsets_.size() - 1;
+		}
+
+		// Centroids per codebook
+		std::size_t centroids() const noexcept {
+			return centroids_;
+		}
+
+		// Writes code_size() bytes to `code`
+		void encode(euclidean_vector const& v, std::span<std::uint8_t> code) const;
+		auto encode(euclidean_vector const& v) const -> std::vector<std::uint8_t>;
+		// The codes of every vector, back to back
+		auto encode_all(std::span<euclidean_vector const> vectors,
+		                thread_pool& pool = default_thread_pool()) const -> std::vector<std::uint8_t>;
+
+		// The vector made of the coded centroids
+		auto decode(std::span<std::uint8_t const> code) const -> euclidean_vector;
+
+		// Asymmetric distance computation. The table holds, for each subspace and centroid, that
+		// centroid's contribution to the distance from `query`: its squared distance for l2 and its
+		// negated dot product for inner_product. Summing the entries a code selects gives the
+		// squared l2 distance or the negated dot product between the query and the decoded vector.
+		auto distance_table(euclidean_vector const& query, search_metric metric) const
+		   -> std::vector<double>;
+		auto adc_distance(std::span<double const> table, std::span<std::uint8_t const> code) const
+		   noexcept -> double;
+
+	private:
+		int dimensions_ = 0;
+		std::size_t centroids_ = 0;
+		// Subspace j covers dimensions [offsets_[j], offsets_[j + 1])
+		std::vector<std::size_t> offsets_;
+		// Codebook j starts at centroids_ * offsets_[j], with one row per centroid
+		std::vector<double> codebooks_;
+
+		product_quantizer() = default;
+		auto codebook(std::size_t subspace) const noexcept -> double const*;
+	};
+
+	// Flat index of product-quantized codes, searched by scanning every code against a distance
+	// table. With 16-byte codes, a 128-dimension corpus takes 64 times less memory than as
+	// euclidean_vectors. Ids are assigned in insertion order starting at 0.
+	class pq_index {
+	public:
+		explicit pq_index(product_quantizer quantizer, search_metric metric = search_metric::l2);
+
+		auto quantizer() const noexcept -> product_quantizer const& {
+			return quantizer_;
+		}
+
+		search_metric metric() const noexcept {
+			return metric_;
+		}
+
+		std::size_t size() const noexcept {
+			return codes_.size() / quantizer_.code_size();
+		}
+
+		auto code(std::size_t id) const noexcept -> std::span<std::uint8_t const> {
+			return std::span(codes_).subspan(id * quantizer_.code_size(), quantizer_.code_size());
+		}
+
+		// Returns the id of the first vector; the rest follow in order
+		auto add_all(std::span<euclidean_vector const> vectors,
+		             thread_pool& pool = default_thread_pool()) -> std::size_t;
+
+		// The k closest codes by asymmetric distance, with the scan shared out across `pool`.
+		// Distances are approximate, and for l2 are the square root of the summed table entries.
+		auto search(euclidean_vector const& query,
+		            std::size_t k,
+		            thread_pool& pool = default_thread_pool()) const -> std::vector<neighbour>;
+
+		// Takes the `rerank` closest codes (at least k), reads those vectors from `originals`, and
+		// returns the k closest by exact distance. `originals` must hold the indexed vectors in id
+		// order, as written by vector_file::write.
+		auto search(euclidean_vector const& query,
+		            std::size_t k,
+		            std::size_t rerank,
+		            vector_file const& originals,
+		            thread_pool& pool = default_thread_pool()) const -> std::vector<neighbour>;
+
+	private:
+		product_quantizer quantizer_;
+		search_metric metric_;
+		std::vector<std::uint8_t> codes_;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_PRODUCT_QUANTIZER_HPP
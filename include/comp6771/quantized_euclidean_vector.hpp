@@ -0,0 +1,87 @@
+#ifndef COMP6771_QUANTIZED_EUCLIDEAN_VECTOR_HPP
+#define COMP6771_QUANTIZED_EUCLIDEAN_VECTOR_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// A euclidean_vector compressed to one signed byte per magnitude. Magnitude i is approximately
+	// offset() + scale() * values()[i], with the offset at the middle of the vector's range and the
+	// values spread over [-127, 127], so each magnitude is within scale() / 2 of the original.
+	//
+	// Dot products and distances between quantized vectors run on integer kernels, using sums of
+	// the values cached when quantizing. euclidean_norm returns the exact norm of the original
+	// vector, which is also cached.
+	class quantized_euclidean_vector {
+		friend auto dot(quantized_euclidean_vector const& x, quantized_euclidean_vector const& y)
+		   -> double;
+		// Asymmetric form, for ranking quantized vectors against a full-precision query
+		friend auto dot(quantized_euclidean_vector const& x, euclidean_vector const& y) -> double;
+		// Exact on the values when x and y share a scale and offset. Otherwise it is expanded as
+		// |x|^2 + |y|^2 - 2 x.y, which loses precision for vectors much closer together than they
+		// are long.
+		friend auto squared_distance(quantized_euclidean_vector const& x,
+		                             quantized_euclidean_vector const& y) -> double;
+		friend auto distance(quantized_euclidean_vector const& x, quantized_euclidean_vector const& y)
+		   -> double;
+		friend auto euclidean_norm(quantized_euclidean_vector const& v) noexcept -> double;
+
+	public:
+		quantized_euclidean_vector() noexcept = default;
+		// Throws std::invalid_argument if any magnitude is not finite
+		explicit quantized_euclidean_vector(euclidean_vector const& v);
+
+		int dimensions() const noexcept {
+			return static_cast<int>(values_.size());
+		}
+
+		double scale() const noexcept {
+			return scale_;
+		}
+
+		double offset() const noexcept {
+			return offset_;
+		}
+
+		auto values() const noexcept -> std::span<std::int8_t const> {
+			return values_;
+		}
+
+		// The dequantized magnitude
+		double operator[](int index) const noexcept {
+			return offset_ + scale_ * values_[static_cast<std::size_t>(index)];
+		}
+
+		auto dequantize() const -> euclidean_vector;
+
+		explicit operator euclidean_vector() const {
+			return dequantize();
+		}
+
+		friend bool operator==(quantized_euclidean_vector const&,
+		                       quantized_euclidean_vector const&) = default;
+
+	private:
+		std::vector<std::int8_t> values_;
+		double scale_ = 0.0;
+		double offset_ = 0.0;
+		// Sums of the values and of their squares, for the integer forms of dot and distance
+		std::int64_t sum_ = 0;
+		std::int64_t sum_of_squares_ = 0;
+		double norm_ = 0.0;
+
+		auto squared_norm() const noexcept -> double;
+	};
+
+	// Quantizes every vector, spread across `pool`
+	auto quantize_all(std::span<euclidean_vector const> vectors,
+	                  thread_pool& pool = default_thread_pool())
+	   -> std::vector<quantized_euclidean_vector>;
+} // namespace comp6771
+
+#endif // COMP6771_QUANTIZED_EUCLIDEAN_VECTOR_HPP
@@ -0,0 +1,75 @@
+#ifndef COMP6771_RANDOM_PROJECTION_HPP
+#define COMP6771_RANDOM_PROJECTION_HPP
+
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace comp6771 {
+	// gaussian: a dense matrix of N(0, 1 / k) entries.
+	// achlioptas: entries of +-sqrt(3 / k) with probability 1/6 each and 0 otherwise (Achlioptas,
+	// 2003), which are as accurate as Gaussian entries and cheaper to generate.
+	// fast_hadamard: the subsampled randomized Hadamard transform (Ailon and Chazelle, 2009). The
+	// input is zero-padded to a power of two, its signs flipped at random, and a fast Walsh-Hadamard
+	// transform applied, before k of the results are kept. It costs O(d log d) per vector rather
+	// than O(dk), and needs no matrix.
+	enum class random_projection_kind { gaussian, achlioptas, fast_hadamard };
+
+	// A linear map from `input_dimensions` to `output_dimensions` that preserves Euclidean lengths
+	// and distances in expectation, and within a factor of 1 +- eps with high probability once
+	// the output has O(log n / eps^2) dimensions (the Johnson-Lindenstrauss lemma). The same seed
+	// always gives the same map.
+	class random_projection {
+	public:
+		random_projection(int input_dimensions,
+		                  int output_dimensions,
+		                  random_projection_kind kind = random_projection_kind::gaussian,
+		                  std::uint64_t seed = 0);
+
+		int input_dimensions() const noexcept {
+			return input_dimensions_;
+		}
+
+		int output_dimensions() const noexcept {
+			return output_dimensions_;
+		}
+
+		random_projection_kind kind() const noexcept {
+			return kind_;
+		}
+
+		auto apply(euclidean_vector const& v) const -> euclidean_vector;
+
+		// Projects `vectors` into `out`, which must be the same length, reusing its storage where
+		// the dimensions already match. The matrix kinds project a block of vectors at a time with
+		// one gemm, so a stream can be passed through in batches of any size.
+		void apply_all(std::span<euclidean_vector const> vectors,
+		               std::span<euclidean_vector> out,
+		               thread_pool& pool = default_thread_pool()) const;
+		auto apply_all(std::span<euclidean_vector const> vectors,
+		               thread_pool& pool = default_thread_pool()) const
+		   -> std::vector<euclidean_vector>;
+
+	private:
+		int input_dimensions_;
+		int output_dimensions_;
+		random_projection_kind kind_;
+
+		// The matrix kinds: output x input, and its transpose for projecting row blocks
+		dense_matrix matrix_;
+		dense_matrix matrix_by_column_;
+
+		// fast_hadamard: a sign per padded input dimension, and the transformed coordinates kept
+		std::vector<double> signs_;
+		std::vector<std::size_t> kept_;
+
+		void hadamard(double const* x, std::vector<double>& work, double* y) const;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_RANDOM_PROJECTION_HPP
@@ -0,0 +1,70 @@
+#ifndef COMP6771_THREAD_POOL_HPP
+#define COMP6771_THREAD_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace comp6771 {
+	// `pinned` binds worker i to logical CPU i (modulo the CPU count) where the platform supports
+	// it, and is ignored elsewhere
+	enum class thread_affinity { none, pinned };
+
+	// Work-stealing scheduler. Every worker owns a deque of subranges: it splits and runs work from
+	// the back of its own deque, and when that runs dry it steals from the front of another's, so
+	// uneven work spreads itself across the pool. The thread calling parallel_for runs subranges
+	// too until its loop is done, which also makes nested parallel_for calls safe.
+	class thread_pool {
+	public:
+		// `threads` includes the calling thread, so a pool of one runs everything inline. 0 means
+		// one per hardware thread.
+		explicit thread_pool(std::size_t threads = 0, thread_affinity affinity = thread_affinity::none);
+		~thread_pool();
+
+		thread_pool(thread_pool const&) = delete;
+		thread_pool& operator=(thread_pool const&) = delete;
+
+		auto size() const noexcept -> std::size_t;
+
+		// Calls fn(first, last) over disjoint subranges that together cover [0, n). A range is only
+		// split while both halves would be at least `grain` long; a grain of 0 picks one from n and
+		// size(). Returns once every call has finished. If fn throws, the subranges not yet started
+		// are skipped and the first exception is rethrown here.
+		template<typename Fn>
+		void parallel_for(std::size_t n, std::size_t grain, Fn&& fn) {
+			using function = std::remove_reference_t<Fn>;
+			auto const call = [](void const* context, std::size_t first, std::size_t last) {
+				(*static_cast<function*>(const_cast<void*>(context)))(first, last);
+			};
+			run(n, grain, call, std::addressof(fn));
+		}
+
+		template<typename Fn>
+		void parallel_for(std::size_t n, Fn&& fn) {
+			parallel_for(n, 0, fn);
+		}
+
+		// Calls fn(item) for every element of `items`
+		template<typename T, typename Fn>
+		void parallel_for_each(std::span<T> items, Fn&& fn, std::size_t grain = 0) {
+			parallel_for(items.size(), grain, [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					fn(items[i]);
+			});
+		}
+
+	private:
+		struct state;
+		std::unique_ptr<state> state_;
+
+		using erased_function = void (*)(void const*, std::size_t, std::size_t);
+		void run(std::size_t n, std::size_t grain, erased_function fn, void const* context);
+	};
+
+	// Pool used by the library's own parallel kernels. It is created on first use with one thread
+	// per hardware thread.
+	auto default_thread_pool() -> thread_pool&;
+} // namespace comp6771
+
+#endif // COMP6771_THREAD_POOL_HPP
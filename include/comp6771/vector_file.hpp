@@ -0,0 +1,46 @@
+#ifndef COMP6771_VECTOR_FILE_HPP
+#define COMP6771_VECTOR_FILE_HPP
+
+#include <comp6771/euclidean_vector.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace comp6771 {
+	// Read-only random access to full-precision vectors kept on disk, for corpora that do not fit in
+	// memory. The file holds a small header followed by the magnitudes row by row, as native-order
+	// doubles. Reads are serialised internally, so a vector_file may be shared between threads.
+	class vector_file {
+	public:
+		// Writes `vectors` to `path`, replacing it. Every vector must have the same dimensions.
+		static void write(std::string const& path, std::span<euclidean_vector const> vectors);
+
+		explicit vector_file(std::string const& path);
+
+		vector_file(vector_file&&) noexcept;
+		vector_file& operator=(vector_file&&) noexcept;
+		~vector_file();
+
+		int dimensions() const noexcept {
+			return dimensions_;
+		}
+
+		std::size_t size() const noexcept {
+			return size_;
+		}
+
+		// Throws std::out_of_range for an id past the end, and std::runtime_error if reading fails
+		auto read(std::size_t id) const -> euclidean_vector;
+
+	private:
+		struct stream;
+
+		int dimensions_ = 0;
+		std::size_t size_ = 0;
+		std::unique_ptr<stream> stream_;
+	};
+} // namespace comp6771
+
+#endif // COMP6771_VECTOR_FILE_HPP
@@ -0,0 +1,174 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/ball_tree.hpp>
+
+#include "kernels.hpp"
+#include "spatial_tree.hpp"
+
+namespace comp6771 {
+	ball_tree::ball_tree(std::span<euclidean_vector const> vectors,
+	                     std::size_t leaf_size,
+	                     thread_pool& pool) {
+		auto layout = spatial::build_layout(vectors, leaf_size, pool);
+		dimensions_ = layout.dimensions;
+		depth_ = layout.depth;
+		arena_ = std::move(layout.arena);
+		ids_ = std::move(layout.ids);
+		if (ids_.empty())
+			return;
+
+		auto const nodes = spatial::node_count(depth_);
+		auto first = std::vector<std::size_t>{0};
+		auto last = std::vector<std::size_t>{size()};
+		for (auto node = std::size_t{0}; 2 * node + 2 < nodes; ++node) {
+			auto const mid = spatial::middle(first[node], last[node]);
+			first.insert(first.end(), {first[node], mid});
+			last.insert(last.end(), {mid, last[node]});
+		}
+
+		auto const d = static_cast<std::size_t>(dimensions_);
+		centres_.assign(nodes * d, 0.0);
+		radii_.assign(nodes, -1.0);
+		pool.parallel_for(nodes, [&](std::size_t begin, std::size_t end) {
+			for (auto node = begin; node < end; ++node) {
+				if (first[node] == last[node])
+					continue;
+
+				auto* const c = centres_.data() + node * d;
+				for (auto i = first[node]; i < last[node]; ++i)
+					for (auto j = std::size_t{0}; j < d; ++j)
+						c[j] += row(i)[j];
+				kernels::scale(c, d, 1.0 / static_cast<double>(last[node] - first[node]));
+
+				auto furthest = 0.0;
+				for (auto i = first[node]; i < last[node]; ++i)
+					furthest = std::max(furthest, kernels::squared_distance(c, row(i), d));
+				// Rounded up, so that pruning never drops a vector that lies exactly on a boundary
+				radii_[node] = std::sqrt(furthest) * (1.0 + 1e-12);
+			}
+		});
+	}
+
+	auto ball_tree::row(std::size_t i) const noexcept -> double const* {
+		return arena_.data() + i * static_cast<std::size_t>(dimensions_);
+	}
+
+	auto ball_tree::centre(std::size_t node) const noexcept -> double const* {
+		return centres_.data() + node * static_cast<std::size_t>(dimensions_);
+	}
+
+	auto ball_tree::knn(euclidean_vector const& query, std::size_t k) const -> std::vector<neighbour> {
+		spatial::check_query(*this, query);
+		auto best = spatial::nearest_set(k);
+		if (ids_.empty() or k == 0)
+			return best.take();
+
+		auto const* const q = query.data();
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto const lower_bound = [&](std::size_t node) {
+			auto const gap =
+			   std::max(0.0, std::sqrt(kernels::squared_distance(q, centre(node), d)) - radii_[node]);
+			return gap * gap;
+		};
+
+		auto stack = spatial::frame_stack();
+		auto top = std::size_t{0};
+		stack[top++] = {0, 0, size(), 0, 0.0};
+		while (top > 0) {
+			auto const f = stack[--top];
+			if (f.bound > best.bound())
+				continue;
+
+			if (f.level == depth_) {
+				for (auto i = f.first; i < f.last; ++i)
+					best.offer(ids_[i], kernels::squared_distance(q, row(i), d));
+				continue;
+			}
+
+			// The child whose ball is nearer is searched first
+			auto const mid = spatial::middle(f.first, f.last);
+			auto left = spatial::frame{2 * f.node + 1, f.first, mid, f.level + 1, 0.0};
+			auto right = spatial::frame{2 * f.node + 2, mid, f.last, f.level + 1, 0.0};
+			left.bound = lower_bound(left.node);
+			right.bound = lower_bound(right.node);
+			if (left.bound < right.bound)
+				std::swap(left, right);
+			stack[top++] = left;
+			stack[top++] = right;
+		}
+		return best.take();
+	}
+
+	// Calls visit(id, squared distance) for every vector within the radius, until visit returns
+	// false. Returns whether the search ran to completion.
+	template<typename Visit>
+	auto ball_tree::visit_within(double const* query, double radius, Visit& visit) const -> bool {
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto const squared_radius = radius * radius;
+		auto stack = spatial::frame_stack();
+		auto top = std::size_t{0};
+		stack[top++] = {0, 0, size(), 0, 0.0};
+		while (top > 0) {
+			auto const f = stack[--top];
+			auto const to_centre = std::sqrt(kernels::squared_distance(query, centre(f.node), d));
+			if (to_centre - radii_[f.node] > radius)
+				continue;
+
+			if (f.level == depth_) {
+				for (auto i = f.first; i < f.last; ++i) {
+					auto const squared = kernels::squared_distance(query, row(i), d);
+					if (squared <= squared_radius and not visit(ids_[i], squared))
+						return false;
+				}
+				continue;
+			}
+
+			auto const mid = spatial::middle(f.first, f.last);
+			stack[top++] = {2 * f.node + 2, mid, f.last, f.level + 1, 0.0};
+			stack[top++] = {2 * f.node + 1, f.first, mid, f.level + 1, 0.0};
+		}
+		return true;
+	}
+
+	auto ball_tree::radius_search(euclidean_vector const& query, double radius) const
+	   -> std::vector<neighbour> {
+		spatial::check_query(*this, query);
+		auto found = std::vector<neighbour>();
+		if (ids_.empty() or radius < 0)
+			return found;
+
+		auto collect = [&](std::size_t id, double squared) {
+			found.push_back({id, squared});
+			return true;
+		};
+		visit_within(query.data(), radius, collect);
+		spatial::finish_radius_search(found);
+		return found;
+	}
+
+	auto ball_tree::any_within(euclidean_vector const& query, double radius) const -> bool {
+		spatial::check_query(*this, query);
+		if (ids_.empty() or radius < 0)
+			return false;
+
+		auto stop = [](std::size_t, double) { return false; };
+		return not visit_within(query.data(), radius, stop);
+	}
+
+	auto ball_tree::knn(std::span<euclidean_vector const> queries,
+	                    std::size_t k,
+	                    thread_pool& pool) const -> std::vector<std::vector<neighbour>> {
+		return spatial::search_all(*this, queries, pool, [&](euclidean_vector const& query) {
+			return knn(query, k);
+		});
+	}
+
+	auto ball_tree::radius_search(std::span<euclidean_vector const> queries,
+	                              double radius,
+	                              thread_pool& pool) const -> std::vector<std::vector<neighbour>> {
+		return spatial::search_all(*this, queries, pool, [&](euclidean_vector const& query) {
+			return radius_search(query, radius);
+		});
+	}
+} // namespace comp6771
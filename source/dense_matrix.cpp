@@ -0,0 +1,365 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/dense_matrix.hpp>
+
+#include "kernels.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// Products with fewer multiply-adds than this stay on the calling thread
+		constexpr auto parallel_threshold = std::size_t{1} << 20;
+
+		// GEMV walks x (row-major) or y (column-major) in panels of this many elements so that the
+		// reused operand stays in L1
+		constexpr auto gemv_panel = std::size_t{2048};
+
+		// GEMM blocking: MR x NR register tile, KC x NC packed panel of B, MC x KC packed block of A
+		constexpr auto gemm_mr = std::size_t{4};
+		constexpr auto gemm_nr = std::size_t{8};
+		constexpr auto gemm_kc = std::size_t{256};
+		constexpr auto gemm_mc = std::size_t{128};
+		constexpr auto gemm_nc = std::size_t{1024};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		// Splits `rows` units of work, each costing `work_per_row` multiply-adds, across threads
+		// when the total is large enough to pay for them
+		template<typename Fn>
+		void for_each_row_block(std::size_t rows, std::size_t work_per_row, Fn fn) {
+			if (rows * work_per_row < parallel_threshold) {
+				fn(std::size_t{0}, rows);
+				return;
+			}
+			auto const per_row = std::max(work_per_row, std::size_t{1});
+			auto const grain = std::max(std::size_t{1}, (parallel_threshold / 16) / per_row);
+			parallel::for_each_block(rows, grain, fn);
+		}
+
+		// Four dot products of consecutive rows (lda apart) against x, sharing each load of x
+		void dot4(double const* a,
+		          std::size_t lda,
+		          double const* x,
+		          std::size_t n,
+		          double (&out)[4]) noexcept {
+			constexpr auto lanes = std::size_t{4};
+			double acc[4][lanes] = {};
+			auto i = std::size_t{0};
+			for (; i + lanes <= n; i += lanes)
+				for (auto row = std::size_t{0}; row < 4; ++row)
+					for (auto lane = std::size_t{0}; lane < lanes; ++lane)
+						acc[row][lane] =
+						   kernels::multiply_add(a[row * lda + i + lane], x[i + lane], acc[row][lane]);
+			for (; i < n; ++i)
+				for (auto row = std::size_t{0}; row < 4; ++row)
+					acc[row][0] = kernels::multiply_add(a[row * lda + i], x[i], acc[row][0]);
+			for (auto row = std::size_t{0}; row < 4; ++row)
+				out[row] = (acc[row][0] + acc[row][1]) + (acc[row][2] + acc[row][3]);
+		}
+
+		void scale_or_zero(double* y, std::size_t n, double beta) noexcept {
+			if (beta == 0)
+				std::fill(y, y + n, 0.0);
+			else if (beta != 1)
+				kernels::scale(y, n, beta);
+		}
+
+		// y[first, last) = alpha A[first, last) x + beta y[first, last) for a row-major A
+		void gemv_row_major(double alpha,
+		                    double const* a,
+		                    std::size_t lda,
+		                    std::size_t cols,
+		                    double const* x,
+		                    double beta,
+		                    double* y,
+		                    std::size_t first,
+		                    std::size_t last) noexcept {
+			scale_or_zero(y + first, last - first, beta);
+			for (auto p0 = std::size_t{0}; p0 < cols; p0 += gemv_panel) {
+				auto const width = std::min(gemv_panel, cols - p0);
+				auto i = first;
+				for (; i + 4 <= last; i += 4) {
+					double sums[4];
+					dot4(a + i * lda + p0, lda, x + p0, width, sums);
+					for (auto row = std::size_t{0}; row < 4; ++row)
+						y[i + row] = kernels::multiply_add(alpha, sums[row], y[i + row]);
+				}
+				for (; i < last; ++i)
+					y[i] =
+					   kernels::multiply_add(alpha, kernels::dot(a + i * lda + p0, x + p0, width), y[i]);
+			}
+		}
+
+		// y[first, last) = alpha A[first, last) x + beta y[first, last) for a column-major A
+		void gemv_column_major(double alpha,
+		                       double const* a,
+		                       std::size_t lda,
+		                       std::size_t cols,
+		                       double const* x,
+		                       double beta,
+		                       double* y,
+		                       std::size_t first,
+		                       std::size_t last) noexcept {
+			scale_or_zero(y + first, last - first, beta);
+			for (auto i0 = first; i0 < last; i0 += gemv_panel) {
+				auto const i1 = std::min(last, i0 + gemv_panel);
+				auto j = std::size_t{0};
+				for (; j + 4 <= cols; j += 4) {
+					auto const* c0 = a + j * lda;
+					auto const* c1 = c0 + lda;
+					auto const* c2 = c1 + lda;
+					auto const* c3 = c2 + lda;
+					auto const x0 = alpha * x[j];
+					auto const x1 = alpha * x[j + 1];
+					auto const x2 = alpha * x[j + 2];
+					auto const x3 = alpha * x[j + 3];
+					for (auto i = i0; i < i1; ++i)
+						y[i] += (x0 * c0[i] + x1 * c1[i]) + (x2 * c2[i] + x3 * c3[i]);
+				}
+				for (; j < cols; ++j) {
+					auto const* c = a + j * lda;
+					auto const xj = alpha * x[j];
+					for (auto i = i0; i < i1; ++i)
+						y[i] = kernels::multiply_add(xj, c[i], y[i]);
+				}
+			}
+		}
+
+		void gemv_into(double alpha, dense_matrix const& a, double const* x, double beta, double* y) {
+			auto const rows = static_cast<std::size_t>(a.rows());
+			auto const cols = static_cast<std::size_t>(a.cols());
+			if (a.layout() == matrix_layout::row_major) {
+				for_each_row_block(rows, cols, [&](std::size_t first, std::size_t last) {
+					gemv_row_major(alpha, a.data(), cols, cols, x, beta, y, first, last);
+				});
+			}
+			else {
+				for_each_row_block(rows, cols, [&](std::size_t first, std::size_t last) {
+					gemv_column_major(alpha, a.data(), rows, cols, x, beta, y, first, last);
+				});
+			}
+		}
+
+		// Strided access to a matrix operand, independent of its layout
+		struct operand {
+			double const* data;
+			std::ptrdiff_t row_stride;
+			std::ptrdiff_t col_stride;
+
+			double operator()(std::size_t row, std::size_t col) const noexcept {
+				return data[static_cast<std::ptrdiff_t>(row) * row_stride
+				            + static_cast<std::ptrdiff_t>(col) * col_stride];
+			}
+		};
+
+		// Packs B[pc, pc + kc) x [jc, jc + nc) as NR-wide slivers, each stored p-major and padded
+		// with zeros past the last column
+		void pack_b(operand b,
+		            std::size_t pc,
+		            std::size_t kc,
+		            std::size_t jc,
+		            std::size_t nc,
+		            double* packed) noexcept {
+			for (auto js = std::size_t{0}; js < nc; js += gemm_nr) {
+				auto const width = std::min(gemm_nr, nc - js);
+				for (auto p = std::size_t{0}; p < kc; ++p)
+					for (auto j = std::size_t{0}; j < gemm_nr; ++j)
+						*packed++ = j < width ? b(pc + p, jc + js + j) : 0.0;
+			}
+		}
+
+		// Packs A[ic, ic + mc) x [pc, pc + kc) as MR-tall slivers, each stored p-major and padded
+		// with zeros past the last row
+		void pack_a(operand a,
+		            std::size_t ic,
+		            std::size_t mc,
+		            std::size_t pc,
+		            std::size_t kc,
+		            double* packed) noexcept {
+			for (auto is = std::size_t{0}; is < mc; is += gemm_mr) {
+				auto const height = std::min(gemm_mr, mc - is);
+				for (auto p = std::size_t{0}; p < kc; ++p)
+					for (auto i = std::size_t{0}; i < gemm_mr; ++i)
+						*packed++ = i < height ? a(ic + is + i, pc + p) : 0.0;
+			}
+		}
+
+		void micro_kernel(std::size_t kc,
+		                  double const* a,
+		                  double const* b,
+		                  double (&acc)[gemm_mr][gemm_nr]) noexcept {
+			for (auto p = std::size_t{0}; p < kc; ++p)
+				for (auto i = std::size_t{0}; i < gemm_mr; ++i)
+					for (auto j = std::size_t{0}; j < gemm_nr; ++j)
+						acc[i][j] =
+						   kernels::multiply_add(a[p * gemm_mr + i], b[p * gemm_nr + j], acc[i][j]);
+		}
+
+		// C += alpha A B for an m x k A and k x n B, with C already scaled by beta. Blocks of C rows
+		// are shared out between threads; each packs its own block of A against a shared panel of B.
+		void gemm_accumulate(double alpha,
+		                     operand a,
+		                     operand b,
+		                     std::size_t m,
+		                     std::size_t n,
+		                     std::size_t k,
+		                     double* c,
+		                     std::ptrdiff_t c_row_stride,
+		                     std::ptrdiff_t c_col_stride) {
+			auto const padded_nc = (std::min(n, gemm_nc) + gemm_nr - 1) / gemm_nr * gemm_nr;
+			auto packed_b = std::vector<double>(gemm_kc * padded_nc);
+			auto const row_blocks = (m + gemm_mc - 1) / gemm_mc;
+
+			for (auto jc = std::size_t{0}; jc < n; jc += gemm_nc) {
+				auto const nc = std::min(gemm_nc, n - jc);
+				for (auto pc = std::size_t{0}; pc < k; pc += gemm_kc) {
+					auto const kc = std::min(gemm_kc, k - pc);
+					pack_b(b, pc, kc, jc, nc, packed_b.data());
+
+					auto const block_work = gemm_mc * nc * kc;
+					for_each_row_block(row_blocks, block_work, [&](std::size_t first, std::size_t last) {
+						auto packed_a = std::vector<double>(gemm_mc * gemm_kc);
+						for (auto block = first; block < last; ++block) {
+							auto const ic = block * gemm_mc;
+							auto const mc = std::min(gemm_mc, m - ic);
+							pack_a(a, ic, mc, pc, kc, packed_a.data());
+
+							for (auto js = std::size_t{0}; js < nc; js += gemm_nr) {
+								auto const width = std::min(gemm_nr, nc - js);
+								for (auto is = std::size_t{0}; is < mc; is += gemm_mr) {
+									auto const height = std::min(gemm_mr, mc - is);
+									double acc[gemm_mr][gemm_nr] = {};
+									micro_kernel(kc, packed_a.data() + is * kc, packed_b.data() + js * kc, acc);
+
+									for (auto i = std::size_t{0}; i < height; ++i) {
+										auto const row = static_cast<std::ptrdiff_t>(ic + is + i);
+										for (auto j = std::size_t{0}; j < width; ++j) {
+											auto const col = static_cast<std::ptrdiff_t>(jc + js + j);
+											auto& out = c[row * c_row_stride + col * c_col_stride];
+											out = kernels::multiply_add(alpha, acc[i][j], out);
+										}
+									}
+								}
+							}
+						}
+					});
+				}
+			}
+		}
+	} // namespace
+
+	// Constructors
+	dense_matrix::dense_matrix() noexcept
+	: rows_(0)
+	, cols_(0)
+	, layout_(matrix_layout::row_major) {}
+
+	dense_matrix::dense_matrix(int rows, int cols, matrix_layout layout)
+	: dense_matrix(rows, cols, 0.0, layout) {}
+
+	dense_matrix::dense_matrix(int rows, int cols, double value, matrix_layout layout)
+	: values_(static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols), value)
+	, rows_(rows)
+	, cols_(cols)
+	, layout_(layout) {}
+
+	auto dense_matrix::from_rows(std::span<euclidean_vector const> rows, matrix_layout layout)
+	   -> dense_matrix {
+		if (rows.empty())
+			return dense_matrix(0, 0, layout);
+
+		auto matrix = dense_matrix(static_cast<int>(rows.size()), rows.front().dimensions(), layout);
+		for (auto r = 0; r < matrix.rows(); ++r) {
+			auto const& row = rows[static_cast<std::size_t>(r)];
+			check_same_dimensions(matrix.cols(), row.dimensions());
+			for (auto c = 0; c < matrix.cols(); ++c)
+				matrix(r, c) = row.data()[c];
+		}
+		return matrix;
+	}
+
+	auto dense_matrix::from_columns(std::span<euclidean_vector const> columns, matrix_layout layout)
+	   -> dense_matrix {
+		if (columns.empty())
+			return dense_matrix(0, 0, layout);
+
+		auto matrix =
+		   dense_matrix(columns.front().dimensions(), static_cast<int>(columns.size()), layout);
+		for (auto c = 0; c < matrix.cols(); ++c) {
+			auto const& column = columns[static_cast<std::size_t>(c)];
+			check_same_dimensions(matrix.rows(), column.dimensions());
+			for (auto r = 0; r < matrix.rows(); ++r)
+				matrix(r, c) = column.data()[r];
+		}
+		return matrix;
+	}
+
+	// Products
+	auto gemv(dense_matrix const& a, euclidean_vector_view x) -> euclidean_vector {
+		auto y = euclidean_vector(a.rows());
+		return std::move(gemv(1.0, a, x, 0.0, y));
+	}
+
+	auto gemv(double alpha,
+	          dense_matrix const& a,
+	          euclidean_vector_view x,
+	          double beta,
+	          euclidean_vector& y) -> euclidean_vector& {
+		check_same_dimensions(a.cols(), x.dimensions());
+		check_same_dimensions(a.rows(), y.dimensions());
+
+		// The kernels want a contiguous x that is not overwritten while y is written
+		auto const* const y_first = y.data();
+		auto const* const y_last = y_first + y.dimensions();
+		auto const overlaps =
+		   std::less_equal<>()(y_first, x.data()) and std::less<>()(x.data(), y_last);
+		auto copy = std::vector<double>();
+		auto const* x_data = x.data();
+		if (not x.contiguous() or overlaps) {
+			copy.resize(static_cast<std::size_t>(x.dimensions()));
+			for (auto i = 0; i < x.dimensions(); ++i)
+				copy[static_cast<std::size_t>(i)] = x[i];
+			x_data = copy.data();
+		}
+
+		gemv_into(alpha, a, x_data, beta, y.mutable_data());
+		return y;
+	}
+
+	auto gemm(dense_matrix const& a, dense_matrix const& b) -> dense_matrix {
+		auto c = dense_matrix(a.rows(), b.cols(), a.layout());
+		return std::move(gemm(1.0, a, b, 0.0, c));
+	}
+
+	auto gemm(double alpha, dense_matrix const& a, dense_matrix const& b, double beta, dense_matrix& c)
+	   -> dense_matrix& {
+		check_same_dimensions(a.cols(), b.rows());
+		check_same_dimensions(a.rows(), c.rows());
+		check_same_dimensions(b.cols(), c.cols());
+
+		auto const c_size = static_cast<std::size_t>(c.rows()) * static_cast<std::size_t>(c.cols());
+		scale_or_zero(c.data(), c_size, beta);
+		gemm_accumulate(alpha,
+		                operand{a.data(), a.row_stride(), a.col_stride()},
+		                operand{b.data(), b.row_stride(), b.col_stride()},
+		                static_cast<std::size_t>(a.rows()),
+		                static_cast<std::size_t>(b.cols()),
+		                static_cast<std::size_t>(a.cols()),
+		                c.data(),
+		                c.row_stride(),
+		                c.col_stride());
+		return c;
+	}
+} // namespace comp6771
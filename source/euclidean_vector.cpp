@@ -2,8 +2,91 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 #include <comp6771/euclidean_vector.hpp>
+#include <comp6771/euclidean_vector_view.hpp>
+
+#include "kernels.hpp"
+#include "parallel.hpp"
+
+#include <atomic>
 
 namespace comp6771 {
+	namespace {
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		void check_same_dimensions(euclidean_vector const& x, euclidean_vector const& y) {
+			check_same_dimensions(x.dimensions(), y.dimensions());
+		}
+
+		// Norm of a vector that is about to be scaled to unit length
+		auto unit_norm(euclidean_vector const& v) -> double {
+			if (v.dimensions() == 0) {
+				const std::string message = "euclidean_vector with no dimensions does not have a unit "
+				                            "vector";
+				throw std::invalid_argument(message);
+			}
+
+			double norm = euclidean_norm(v);
+			if (norm == 0) {
+				const std::string message = "euclidean_vector with zero euclidean normal does not have "
+				                            "a unit vector";
+				throw std::invalid_argument(message);
+			}
+			return norm;
+		}
+
+		auto parallel_dimensions = std::atomic<std::size_t>(std::size_t{1} << 20);
+
+		auto run_parallel(std::size_t n) noexcept -> bool {
+			return n >= parallel_dimensions.load(std::memory_order_relaxed);
+		}
+
+		// Every reduction over a euclidean_vector goes through here, so that the serial and
+		// parallel paths (and the norm caches filled by fused kernels) agree bit for bit
+		template<typename T, typename Fn, typename Combine = std::plus<>>
+		auto reduce(std::size_t n, Fn fn, Combine combine = {}) -> T {
+			return parallel::blocked_reduce<T>(n, run_parallel(n), fn, combine);
+		}
+
+		// Calls fn(first, last) over [0, n), split across threads above the threshold
+		template<typename Fn>
+		void for_each_range(std::size_t n, Fn fn) {
+			if (run_parallel(n))
+				parallel::for_each_block(n, parallel::reduction_block, fn);
+			else
+				fn(std::size_t{0}, n);
+		}
+
+		auto blocked_squared_norm(double const* x, std::size_t n) noexcept -> double {
+			return reduce<double>(n, [x](std::size_t first, std::size_t last) {
+				return kernels::squared_norm(x + first, last - first);
+			});
+		}
+
+		auto blocked_dot(double const* x, double const* y, std::size_t n) noexcept -> double {
+			return reduce<double>(n, [x, y](std::size_t first, std::size_t last) {
+				return kernels::dot(x + first, y + first, last - first);
+			});
+		}
+
+		auto blocked_squared_distance(double const* x, double const* y, std::size_t n) noexcept
+		   -> double {
+			return reduce<double>(n, [x, y](std::size_t first, std::size_t last) {
+				return kernels::squared_distance(x + first, y + first, last - first);
+			});
+		}
+
+		void scale(double* x, std::size_t n, double factor) noexcept {
+			for_each_range(n, [=](std::size_t first, std::size_t last) {
+				kernels::scale(x + first, last - first, factor);
+			});
+		}
+	} // namespace
 
 	// Constructors
 	euclidean_vector::euclidean_vector() noexcept
@@ -13,44 +96,56 @@ namespace comp6771 {
 	: euclidean_vector(dim, 0) {}
 
 	euclidean_vector::euclidean_vector(int dim, double mag) noexcept
-	: magnitude_(std::make_unique<double[]>(static_cast<size_t>(dim)))
-	, dim_(dim) {
-		for (double& mag_ : *this)
-			mag_ = mag;
-	}
+	: euclidean_vector(std::vector<double>(static_cast<size_t>(dim), mag)) {}
+
+
 	euclidean_vector::euclidean_vector(std::vector<double>::const_iterator start,
 	                                   std::vector<double>::const_iterator end) noexcept
-	: euclidean_vector(static_cast<int>(end - start), 0) {
-		std::copy(start, end, this->begin());
-	}
+	: euclidean_vector(std::vector<double>(start, end)) {}
 
 	euclidean_vector::euclidean_vector(std::initializer_list<double> list_param) noexcept
-	: euclidean_vector(static_cast<int>(list_param.size()), 0) {
-		std::copy(list_param.begin(), list_param.end(), this->begin());
-	}
+	: euclidean_vector(std::vector<double>(list_param)) {}
 
-	euclidean_vector::euclidean_vector(euclidean_vector const& copy) noexcept
-	: euclidean_vector(copy.dim_) {
-		if (this == &copy)
-			return;
+	euclidean_vector::euclidean_vector(std::vector<double>&& storage) noexcept
+	: magnitude_(make_storage(std::move(storage))) {}
 
-		std::swap(this->altered_, copy.altered_);
-		std::swap(this->cache_, copy.cache_);
-		std::copy(copy.begin(), copy.end(), this->begin());
-	}
+	// The source's caches are only read, so vectors shared between threads can be copied
+	euclidean_vector::euclidean_vector(euclidean_vector const& copy) noexcept
+	: magnitude_(make_storage(std::vector<double>(copy.magnitude_)))
+	, altered_(copy.altered_)
+	, cache_(copy.cache_)
+	, hash_altered_(copy.hash_altered_)
+	, hash_cache_(copy.hash_cache_) {}
 
 	euclidean_vector::euclidean_vector(euclidean_vector&& right) noexcept
-	: magnitude_(std::exchange(right.magnitude_, std::make_unique<double[]>(static_cast<size_t>(0))))
-	, dim_(std::exchange(right.dim_, 0))
+	: magnitude_(std::exchange(right.magnitude_, make_storage(std::vector<double>())))
 	, altered_(std::exchange(right.altered_, true))
-	, cache_(std::exchange(right.cache_, 0.0)) {}
+	, cache_(std::exchange(right.cache_, 0.0))
+	, hash_altered_(std::exchange(right.hash_altered_, true))
+	, hash_cache_(std::exchange(right.hash_cache_, 0)) {}
+
+	auto euclidean_vector::from(std::vector<double>&& storage) noexcept -> euclidean_vector {
+		return euclidean_vector(std::move(storage));
+	}
+
+	auto euclidean_vector::release_to_vector() && noexcept -> std::vector<double> {
+		this->update_altered();
+		return std::exchange(this->magnitude_, make_storage(std::vector<double>()));
+	}
 
 	// Swap function for copy and move assignments
 	void euclidean_vector::swap(euclidean_vector& other) noexcept {
-		std::swap(this->dim_, other.dim_);
 		std::swap(this->magnitude_, other.magnitude_);
 		std::swap(this->altered_, other.altered_);
 		std::swap(this->cache_, other.cache_);
+		std::swap(this->hash_altered_, other.hash_altered_);
+		std::swap(this->hash_cache_, other.hash_cache_);
+	}
+
+	void euclidean_vector::cache_squared_norm(double squared_norm) const noexcept {
+		this->cache_ =
+		   kernels::norm_from_squared(squared_norm, this->magnitude_.data(), this->magnitude_.size());
+		this->altered_ = false;
 	}
 
 	// Member functions
@@ -60,12 +155,10 @@ namespace comp6771 {
 	}
 
 	euclidean_vector& euclidean_vector::operator=(euclidean_vector&& right) noexcept {
-		euclidean_vector(right).swap(*this);
-
-		right.dim_ = 0;
-		right.altered_ = true;
-		right.cache_ = 0.0;
-		right.magnitude_ = std::make_unique<double[]>(static_cast<size_t>(0));
+		// Moving out first leaves `right` empty, which also covers self-move assignment
+		auto moved = euclidean_vector(std::move(right));
+		if (this != &right)
+			moved.swap(*this);
 		return *this;
 	}
 
@@ -78,35 +171,17 @@ namespace comp6771 {
 	}
 
 	euclidean_vector& euclidean_vector::operator+=(euclidean_vector const& right) {
-		if (this->dimensions() != right.dimensions()) {
-			const std::string message = "Dimensions of LHS(" + std::to_string(this->dimensions())
-			                            + ") and RHS(" + std::to_string(right.dimensions())
-			                            + ") do not match";
-			throw std::invalid_argument(message);
-		}
-
-		for (auto right_it{right.begin()}; auto& mag : *this)
-			mag += *right_it++;
-		this->update_altered();
-		return *this;
+		check_same_dimensions(*this, right);
+		return axpy(1.0, right, *this);
 	}
 
 	euclidean_vector& euclidean_vector::operator-=(euclidean_vector const& right) {
-		if (this->dimensions() != right.dimensions()) {
-			const std::string message = "Dimensions of LHS(" + std::to_string(this->dimensions())
-			                            + ") and RHS(" + std::to_string(right.dimensions())
-			                            + ") do not match";
-			throw std::invalid_argument(message);
-		}
-
-		for (auto right_it{right.begin()}; auto& mag : *this)
-			mag -= *right_it++;
-		this->update_altered();
-		return *this;
+		check_same_dimensions(*this, right);
+		return axpy(-1.0, right, *this);
 	}
 
 	euclidean_vector& euclidean_vector::operator*=(double multiple) noexcept {
-		std::for_each (this->begin(), this->end(), [&](auto& mag) { mag = mag * multiple; });
+		scale(this->magnitude_.data(), this->magnitude_.size(), multiple);
 		this->update_altered();
 		return *this;
 	}
@@ -116,32 +191,26 @@ namespace comp6771 {
 		return *this *= 1.0 / multiple;
 	}
 
-	double& euclidean_vector::operator[](int index) noexcept {
+	euclidean_vector& euclidean_vector::normalize() {
+		auto const norm = unit_norm(*this);
+		// The reciprocal of a subnormal norm overflows, so those are divided through like unit()
+		auto const reciprocal = 1.0 / norm;
+		if (std::isfinite(reciprocal)) {
+			scale(this->magnitude_.data(), this->magnitude_.size(), reciprocal);
+		}
+		else {
+			for (auto& magnitude : this->magnitude_)
+				magnitude /= norm;
+		}
 		this->update_altered();
-		return this->magnitude_[static_cast<size_t>(index)];
-	}
-
-	double euclidean_vector::operator[](int index) const noexcept {
-		return this->magnitude_[static_cast<size_t>(index)];
-	}
-
-	double euclidean_vector::at(int index) const {
-		const std::string message =
-		   "Index " + std::to_string(index) + " is not valid for this euclidean_vector object";
-		if (index < 0 || index >= static_cast<int>(this->dim_))
-			throw std::out_of_range(message);
-
-		return this->magnitude_[static_cast<size_t>(index)];
+		this->cache_ = 1.0;
+		this->altered_ = false;
+		return *this;
 	}
 
-	double& euclidean_vector::at(int index) {
-		const std::string message =
-		   "Index " + std::to_string(index) + " is not valid for this euclidean_vector object";
-		if (index < 0 || index >= static_cast<int>(this->dim_))
-			throw std::out_of_range(message);
-		this->update_altered();
-
-		return this->magnitude_[static_cast<size_t>(index)];
+	void euclidean_vector::throw_index_error(int index) {
+		throw std::out_of_range("Index " + std::to_string(index)
+		                        + " is not valid for this euclidean_vector object");
 	}
 
 	// Friend functions
@@ -149,10 +218,18 @@ namespace comp6771 {
 		if (left.dimensions() != right.dimensions())
 			return false;
 
-		for (auto r{right.begin()}; auto& l : left)
-			if (l != *r++)
-				return false;
-		return true;
+		auto const* const x = left.magnitude_.data();
+		auto const* const y = right.magnitude_.data();
+		auto mismatch = std::atomic<bool>(false);
+		for_each_range(left.magnitude_.size(), [&](std::size_t first, std::size_t last) {
+			for (; first < last and not mismatch.load(std::memory_order_relaxed);
+			     first += parallel::reduction_block) {
+				auto const n = std::min(last - first, parallel::reduction_block);
+				if (not kernels::equal(x + first, y + first, n))
+					mismatch.store(true, std::memory_order_relaxed);
+			}
+		});
+		return not mismatch.load(std::memory_order_relaxed);
 	}
 
 	bool operator!=(euclidean_vector const& left, euclidean_vector const& right) noexcept {
@@ -195,32 +272,18 @@ namespace comp6771 {
 			return v.cache_;
 		}
 		else {
-			double sum{0};
-			for (double i : v)
-				sum += i * i;
-			v.cache_ = std::sqrt(sum);
-			v.altered_ = false;
+			v.cache_squared_norm(blocked_squared_norm(v.magnitude_.data(), v.magnitude_.size()));
 			return v.cache_;
 		}
 	}
 
 	auto unit(euclidean_vector const& v) -> euclidean_vector {
-		if (v.dimensions() == 0) {
-			const std::string message = "euclidean_vector with no dimensions does not have a unit "
-			                            "vector";
-			throw std::invalid_argument(message);
-		}
-
-		double norm = euclidean_norm(v);
-		if (norm == 0) {
-			const std::string message = "euclidean_vector with zero euclidean normal does not have a "
-			                            "unit vector";
-			throw std::invalid_argument(message);
-		}
+		double norm = unit_norm(v);
 
 		auto unit_vec = comp6771::euclidean_vector(v);
 		for (double& mag : unit_vec)
 			mag /= norm;
+		unit_vec.update_altered();
 		return unit_vec;
 	}
 
@@ -232,10 +295,271 @@ namespace comp6771 {
 			throw std::invalid_argument(message);
 		}
 
-		auto result{0.0};
-		for (auto y_mag{y.begin()}; auto& x_mag : x)
-			result += (*y_mag++) * x_mag;
+		return blocked_dot(x.magnitude_.data(), y.magnitude_.data(), x.magnitude_.size());
+	}
+
+	auto approx_equal(euclidean_vector const& x,
+	                  euclidean_vector const& y,
+	                  double abs_tol,
+	                  double rel_tol) noexcept -> bool {
+		if (x.dimensions() != y.dimensions())
+			return false;
+
+		return kernels::approx_equal(x.magnitude_.data(),
+		                             y.magnitude_.data(),
+		                             x.magnitude_.size(),
+		                             abs_tol,
+		                             rel_tol);
+	}
+
+	auto ulp_equal(euclidean_vector const& x,
+	               euclidean_vector const& y,
+	               std::uint64_t max_ulps) noexcept -> bool {
+		if (x.dimensions() != y.dimensions())
+			return false;
+
+		return kernels::ulp_equal(x.magnitude_.data(),
+		                          y.magnitude_.data(),
+		                          x.magnitude_.size(),
+		                          max_ulps);
+	}
+
+	auto ulp_distance(euclidean_vector const& x, euclidean_vector const& y) -> std::uint64_t {
+		check_same_dimensions(x, y);
+		return kernels::max_ulp_distance(x.magnitude_.data(),
+		                                 y.magnitude_.data(),
+		                                 x.magnitude_.size());
+	}
+
+	auto hash_value(euclidean_vector const& v) noexcept -> std::size_t {
+		if (v.hash_altered_) {
+			v.hash_cache_ =
+			   static_cast<std::size_t>(kernels::hash(v.magnitude_.data(), v.magnitude_.size()));
+			v.hash_altered_ = false;
+		}
+		return v.hash_cache_;
+	}
+
+	auto distance(euclidean_vector const& x, euclidean_vector const& y) -> double {
+		return std::sqrt(squared_distance(x, y));
+	}
+
+	auto squared_distance(euclidean_vector const& x, euclidean_vector const& y) -> double {
+		check_same_dimensions(x, y);
+		return blocked_squared_distance(x.magnitude_.data(),
+		                                y.magnitude_.data(),
+		                                x.magnitude_.size());
+	}
+
+	auto manhattan_distance(euclidean_vector const& x, euclidean_vector const& y) -> double {
+		check_same_dimensions(x, y);
+		auto const* const xs = x.magnitude_.data();
+		auto const* const ys = y.magnitude_.data();
+		return reduce<double>(x.magnitude_.size(), [=](std::size_t first, std::size_t last) {
+			return kernels::manhattan_distance(xs + first, ys + first, last - first);
+		});
+	}
+
+	auto chebyshev_distance(euclidean_vector const& x, euclidean_vector const& y) -> double {
+		check_same_dimensions(x, y);
+		auto const* const xs = x.magnitude_.data();
+		auto const* const ys = y.magnitude_.data();
+		return reduce<double>(
+		   x.magnitude_.size(),
+		   [=](std::size_t first, std::size_t last) {
+			   return kernels::chebyshev_distance(xs + first, ys + first, last - first);
+		   },
+		   [](double a, double b) { return std::max(a, b); });
+	}
+
+	auto cosine_similarity(euclidean_vector const& x, euclidean_vector const& y) -> double {
+		check_same_dimensions(x, y);
+
+		auto xy = 0.0;
+		if (not x.altered_ and not y.altered_) {
+			xy = blocked_dot(x.magnitude_.data(), y.magnitude_.data(), x.magnitude_.size());
+		}
+		else {
+			auto const* const xs = x.magnitude_.data();
+			auto const* const ys = y.magnitude_.data();
+			auto const fused = reduce<kernels::dot_with_norms>(
+			   x.magnitude_.size(),
+			   [=](std::size_t first, std::size_t last) {
+				   return kernels::dot_and_squared_norms(xs + first, ys + first, last - first);
+			   });
+			xy = fused.xy;
+			x.cache_squared_norm(fused.xx);
+			y.cache_squared_norm(fused.yy);
+		}
+
+		auto const norms = x.cache_ * y.cache_;
+		if (norms == 0) {
+			const std::string message = "euclidean_vector with zero euclidean normal does not have a "
+			                            "cosine similarity";
+			throw std::invalid_argument(message);
+		}
+		return xy / norms;
+	}
+
+	// The BLAS-style updates below compute the new norm in the same pass that writes y
+	auto axpy(double alpha, euclidean_vector const& x, euclidean_vector& y) -> euclidean_vector& {
+		check_same_dimensions(x, y);
+		auto const* const xs = x.magnitude_.data();
+		auto* const ys = y.magnitude_.data();
+		auto const squared_norm =
+		   reduce<double>(y.magnitude_.size(), [=](std::size_t first, std::size_t last) {
+			   return kernels::axpy(alpha, xs + first, ys + first, last - first);
+		   });
+		y.update_altered();
+		y.cache_squared_norm(squared_norm);
+		return y;
+	}
+
+	auto axpby(double alpha, euclidean_vector const& x, double beta, euclidean_vector& y)
+	   -> euclidean_vector& {
+		check_same_dimensions(x, y);
+		auto const* const xs = x.magnitude_.data();
+		auto* const ys = y.magnitude_.data();
+		auto const squared_norm =
+		   reduce<double>(y.magnitude_.size(), [=](std::size_t first, std::size_t last) {
+			   return kernels::axpby(alpha, xs + first, beta, ys + first, last - first);
+		   });
+		y.update_altered();
+		y.cache_squared_norm(squared_norm);
+		return y;
+	}
+
+	auto lincomb(std::span<double const> coefficients,
+	             std::span<euclidean_vector const> vectors,
+	             euclidean_vector& y) -> euclidean_vector& {
+		if (coefficients.size() != vectors.size()) {
+			const std::string message = "Number of coefficients(" + std::to_string(coefficients.size())
+			                            + ") and vectors(" + std::to_string(vectors.size())
+			                            + ") do not match";
+			throw std::invalid_argument(message);
+		}
+
+		auto aliased = false;
+		for (auto const& x : vectors) {
+			check_same_dimensions(x, y);
+			aliased = aliased or &x == &y;
+		}
+
+		// Writing over an input before it has been read would be wrong, so aliased calls build the
+		// result in a fresh buffer instead
+		auto result = aliased ? std::vector<double>(y.magnitude_.size()) : std::vector<double>();
+		auto* const out = aliased ? result.data() : y.magnitude_.data();
+		auto const squared_norm =
+		   reduce<double>(y.magnitude_.size(), [&](std::size_t first, std::size_t last) {
+			   auto const input = [&](std::size_t j) { return vectors[j].magnitude_.data() + first; };
+			   return kernels::lincomb(coefficients.data(),
+			                           input,
+			                           vectors.size(),
+			                           out + first,
+			                           last - first);
+		   });
+		if (aliased)
+			y.magnitude_.swap(result);
+
+		y.update_altered();
+		y.cache_squared_norm(squared_norm);
+		return y;
+	}
+
+	void normalize_all(std::span<euclidean_vector> vectors, thread_pool& pool) {
+		// Caching every norm first finds the vector a loop would have stopped at
+		pool.parallel_for(vectors.size(), [vectors](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				euclidean_norm(vectors[i]);
+		});
+		auto const invalid = std::ranges::find_if(vectors, [](euclidean_vector const& v) {
+			return v.dimensions() == 0 or euclidean_norm(v) == 0;
+		});
+		auto const count = static_cast<std::size_t>(invalid - vectors.begin());
+
+		pool.parallel_for(count, [vectors](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				vectors[i].normalize();
+		});
+		if (count < vectors.size())
+			vectors[count].normalize();
+	}
+
+	auto find_equal(std::span<euclidean_vector const> corpus,
+	                euclidean_vector const& x,
+	                thread_pool& pool) -> std::vector<std::size_t> {
+		auto equal = std::vector<char>(corpus.size());
+		pool.parallel_for(corpus.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				equal[i] = corpus[i] == x;
+		});
+
+		auto matches = std::vector<std::size_t>();
+		for (auto i = std::size_t{0}; i < corpus.size(); ++i)
+			if (equal[i])
+				matches.push_back(i);
+		return matches;
+	}
+
+	auto cosine_similarity(euclidean_vector const& query,
+	                       std::span<euclidean_vector const> candidates,
+	                       thread_pool& pool) -> std::vector<double> {
+		// With both norms already cached, cosine_similarity() only reads `query`, so it can be shared
+		// between threads
+		euclidean_norm(query);
+		auto similarities = std::vector<double>(candidates.size());
+		pool.parallel_for(candidates.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i) {
+				euclidean_norm(candidates[i]);
+				similarities[i] = cosine_similarity(query, candidates[i]);
+			}
+		});
+		return similarities;
+	}
+
+	void set_parallel_threshold(std::size_t dimensions) noexcept {
+		parallel_dimensions.store(dimensions, std::memory_order_relaxed);
+	}
+
+	auto parallel_threshold() noexcept -> std::size_t {
+		return parallel_dimensions.load(std::memory_order_relaxed);
+	}
+
+	// Views
+	auto dot(euclidean_vector_view x, euclidean_vector_view y) -> double {
+		check_same_dimensions(x.dimensions(), y.dimensions());
+		auto const n = static_cast<std::size_t>(x.dimensions());
+		if (x.contiguous() and y.contiguous())
+			return blocked_dot(x.data(), y.data(), n);
+
+		auto result = 0.0;
+		for (auto i = 0; i < x.dimensions(); ++i)
+			result += x[i] * y[i];
+		return result;
+	}
+
+	auto squared_distance(euclidean_vector_view x, euclidean_vector_view y) -> double {
+		check_same_dimensions(x.dimensions(), y.dimensions());
+		auto const n = static_cast<std::size_t>(x.dimensions());
+		if (x.contiguous() and y.contiguous())
+			return blocked_squared_distance(x.data(), y.data(), n);
+
+		auto result = 0.0;
+		for (auto i = 0; i < x.dimensions(); ++i)
+			result += (x[i] - y[i]) * (x[i] - y[i]);
 		return result;
 	}
 
+	auto distance(euclidean_vector_view x, euclidean_vector_view y) -> double {
+		return std::sqrt(squared_distance(x, y));
+	}
+
+	auto euclidean_norm(euclidean_vector_view v) noexcept -> double {
+		auto const n = static_cast<std::size_t>(v.dimensions());
+		if (v.contiguous())
+			return kernels::norm_from_squared(blocked_squared_norm(v.data(), n), v.data(), n);
+
+		return std::sqrt(dot(v, v));
+	}
+
 } // namespace comp6771
@@ -0,0 +1,499 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/hnsw_index.hpp>
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace comp6771 {
+	namespace {
+		// Links are guarded by one of this many mutexes, chosen by vector id
+		constexpr auto lock_stripes = std::size_t{1024};
+
+		constexpr auto file_magic = std::uint32_t{0x57534e48}; // "HNSW"
+		constexpr auto file_version = std::uint32_t{1};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+			return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+		}
+
+		struct further_first {
+			auto operator()(neighbour const& a, neighbour const& b) const noexcept -> bool {
+				return closer(a, b);
+			}
+		};
+
+		struct closest_first {
+			auto operator()(neighbour const& a, neighbour const& b) const noexcept -> bool {
+				return closer(b, a);
+			}
+		};
+
+		template<typename T>
+		void write_value(std::ostream& out, T const& value) {
+			out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+		}
+
+		template<typename T>
+		void write_values(std::ostream& out, std::vector<T> const& values) {
+			write_value(out, static_cast<std::uint64_t>(values.size()));
+			out.write(reinterpret_cast<char const*>(values.data()),
+			          static_cast<std::streamsize>(values.size() * sizeof(T)));
+		}
+
+		template<typename T>
+		auto read_value(std::istream& in) -> T {
+			auto value = T();
+			in.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return value;
+		}
+
+		template<typename T>
+		auto read_values(std::istream& in) -> std::vector<T> {
+			auto const size = read_value<std::uint64_t>(in);
+			auto values = std::vector<T>();
+			// Grows as it reads, so that a corrupt size fails on reading rather than allocating
+			constexpr auto step = std::uint64_t{1} << 16;
+			for (auto done = std::uint64_t{0}; in and done < size; done += step) {
+				auto const count = std::min(step, size - done);
+				values.resize(static_cast<std::size_t>(done + count));
+				in.read(reinterpret_cast<char*>(values.data() + done),
+				        static_cast<std::streamsize>(count * sizeof(T)));
+			}
+			return values;
+		}
+	} // namespace
+
+	// Marks the vectors seen by one search, cleared in O(1) by moving to a new epoch
+	struct hnsw_index::visited_list {
+		std::vector<std::uint32_t> marks;
+		std::uint32_t epoch = 0;
+
+		void reset(std::size_t size) {
+			if (marks.size() < size)
+				marks.resize(size, 0);
+			if (++epoch == 0) {
+				std::ranges::fill(marks, 0);
+				epoch = 1;
+			}
+		}
+
+		auto visit(std::uint32_t id) noexcept -> bool {
+			if (marks[id] == epoch)
+				return false;
+			marks[id] = epoch;
+			return true;
+		}
+	};
+
+	struct hnsw_index::search_state {
+		std::array<std::mutex, lock_stripes> link_locks;
+		// Held while reading the entry point, and for the whole insertion of a vector that will
+		// become the new entry point
+		std::mutex entry_lock;
+
+		std::mutex visited_lock;
+		std::vector<std::unique_ptr<visited_list>> visited_lists;
+
+		auto lock_for(std::uint32_t id) -> std::mutex& {
+			return link_locks[id % lock_stripes];
+		}
+
+		auto acquire(std::size_t size) -> std::unique_ptr<visited_list> {
+			auto list = std::unique_ptr<visited_list>();
+			{
+				auto const lock = std::lock_guard(visited_lock);
+				if (not visited_lists.empty()) {
+					list = std::move(visited_lists.back());
+					visited_lists.pop_back();
+				}
+			}
+			if (not list)
+				list = std::make_unique<visited_list>();
+			list->reset(size);
+			return list;
+		}
+
+		void release(std::unique_ptr<visited_list> list) {
+			auto const lock = std::lock_guard(visited_lock);
+			visited_lists.push_back(std::move(list));
+		}
+	};
+
+	hnsw_index::hnsw_index(int dimensions, search_metric metric, hnsw_parameters const& parameters)
+	: dimensions_(dimensions)
+	, metric_(metric)
+	, parameters_(parameters)
+	, level_generator_(parameters.seed)
+	, state_(std::make_unique<search_state>()) {
+		if (parameters_.m < 2)
+			throw std::invalid_argument("hnsw_index needs m of at least 2");
+	}
+
+	hnsw_index::hnsw_index(hnsw_index&&) noexcept = default;
+	hnsw_index& hnsw_index::operator=(hnsw_index&&) noexcept = default;
+	hnsw_index::~hnsw_index() = default;
+
+	auto hnsw_index::stored(std::uint32_t id) const noexcept -> double const* {
+		return arena_.data() + std::size_t{id} * static_cast<std::size_t>(dimensions_);
+	}
+
+	auto hnsw_index::distance(double const* x, double const* y) const noexcept -> double {
+		auto const n = static_cast<std::size_t>(dimensions_);
+		return metric_ == search_metric::l2 ? kernels::squared_distance(x, y, n)
+		                                    : -kernels::dot(x, y, n);
+	}
+
+	auto hnsw_index::links(std::uint32_t id, int layer) noexcept -> std::uint32_t* {
+		if (layer == 0)
+			return base_links_.data() + std::size_t{id} * (1 + max_links(0));
+		return upper_links_[id].data() + static_cast<std::size_t>(layer - 1) * (1 + max_links(layer));
+	}
+
+	auto hnsw_index::links(std::uint32_t id, int layer) const noexcept -> std::uint32_t const* {
+		return const_cast<hnsw_index*>(this)->links(id, layer);
+	}
+
+	auto hnsw_index::max_links(int layer) const noexcept -> std::size_t {
+		return layer == 0 ? 2 * parameters_.m : parameters_.m;
+	}
+
+	auto hnsw_index::graph_consistent() const noexcept -> bool {
+		auto const count = levels_.size();
+		if (count == 0)
+			return max_level_ == -1;
+		if (entry_point_ >= count or levels_[entry_point_] != max_level_)
+			return false;
+
+		for (auto id = std::uint32_t{0}; id < count; ++id) {
+			auto const level = levels_[id];
+			if (level < 0 or level > max_level_
+			    or upper_links_[id].size() != static_cast<std::size_t>(level) * (1 + max_links(1)))
+				return false;
+
+			for (auto layer = 0; layer <= level; ++layer) {
+				auto const* const stored = links(id, layer);
+				if (stored[0] > max_links(layer))
+					return false;
+				// Every neighbour on a layer must itself reach that layer
+				auto const valid = [&](std::uint32_t neighbour) {
+					return neighbour < count and levels_[neighbour] >= layer;
+				};
+				if (not std::all_of(stored + 1, stored + 1 + stored[0], valid))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	auto hnsw_index::random_level() -> int {
+		auto const scale = 1.0 / std::log(static_cast<double>(parameters_.m));
+		auto const uniform = std::uniform_real_distribution<double>(0.0, 1.0)(level_generator_);
+		return static_cast<int>(-std::log(1.0 - uniform) * scale);
+	}
+
+	template<bool Locked>
+	void hnsw_index::copy_links(std::uint32_t id, int layer, std::vector<std::uint32_t>& out) const {
+		auto const copy = [&] {
+			auto const* const list = links(id, layer);
+			out.assign(list + 1, list + 1 + list[0]);
+		};
+		if constexpr (Locked) {
+			auto const lock = std::lock_guard(state_->lock_for(id));
+			copy();
+		}
+		else {
+			copy();
+		}
+	}
+
+	template<bool Locked>
+	auto hnsw_index::greedy_closest(double const* query, neighbour entry, int from_layer, int to_layer)
+	   const -> neighbour {
+		auto adjacent = std::vector<std::uint32_t>();
+		for (auto layer = from_layer; layer >= to_layer; --layer) {
+			for (auto moved = true; moved;) {
+				moved = false;
+				copy_links<Locked>(static_cast<std::uint32_t>(entry.id), layer, adjacent);
+				for (auto const id : adjacent) {
+					auto const candidate = neighbour{id, distance(query, stored(id))};
+					if (closer(candidate, entry)) {
+						entry = candidate;
+						moved = true;
+					}
+				}
+			}
+		}
+		return entry;
+	}
+
+	template<bool Locked>
+	auto hnsw_index::search_layer(double const* query,
+	                              std::vector<neighbour> const& entry_points,
+	                              std::size_t ef,
+	                              int layer) const -> std::vector<neighbour> {
+		auto visited = state_->acquire(size());
+		auto candidates =
+		   std::priority_queue<neighbour, std::vector<neighbour>, closest_first>();
+		auto results = std::priority_queue<neighbour, std::vector<neighbour>, further_first>();
+		for (auto const& entry : entry_points) {
+			visited->visit(static_cast<std::uint32_t>(entry.id));
+			candidates.push(entry);
+			results.push(entry);
+			if (results.size() > ef)
+				results.pop();
+		}
+
+		auto adjacent = std::vector<std::uint32_t>();
+		while (not candidates.empty()) {
+			auto const current = candidates.top();
+			if (results.size() >= ef and closer(results.top(), current))
+				break;
+			candidates.pop();
+
+			copy_links<Locked>(static_cast<std::uint32_t>(current.id), layer, adjacent);
+			for (auto const id : adjacent) {
+				if (not visited->visit(id))
+					continue;
+				auto const candidate = neighbour{id, distance(query, stored(id))};
+				if (results.size() < ef or closer(candidate, results.top())) {
+					candidates.push(candidate);
+					results.push(candidate);
+					if (results.size() > ef)
+						results.pop();
+				}
+			}
+		}
+		state_->release(std::move(visited));
+
+		auto found = std::vector<neighbour>(results.size());
+		for (auto i = found.size(); i > 0; --i) {
+			found[i - 1] = results.top();
+			results.pop();
+		}
+		return found;
+	}
+
+	// The heuristic from the paper: a candidate is only linked if it is closer to the new vector
+	// than to every neighbour already chosen, which keeps links pointing in different directions
+	auto hnsw_index::select_neighbours(std::vector<neighbour> candidates, std::size_t limit) const
+	   -> std::vector<neighbour> {
+		std::ranges::sort(candidates, closer);
+		auto selected = std::vector<neighbour>();
+		for (auto const& candidate : candidates) {
+			if (selected.size() == limit)
+				break;
+			auto const* const x = stored(static_cast<std::uint32_t>(candidate.id));
+			auto const diverse = std::ranges::none_of(selected, [&](neighbour const& chosen) {
+				return distance(x, stored(static_cast<std::uint32_t>(chosen.id))) < candidate.distance;
+			});
+			if (diverse)
+				selected.push_back(candidate);
+		}
+		return selected;
+	}
+
+	void hnsw_index::connect(std::uint32_t id, std::vector<neighbour> const& neighbours, int layer) {
+		{
+			auto const lock = std::lock_guard(state_->lock_for(id));
+			auto* const list = links(id, layer);
+			list[0] = static_cast<std::uint32_t>(neighbours.size());
+			for (auto i = std::size_t{0}; i < neighbours.size(); ++i)
+				list[i + 1] = static_cast<std::uint32_t>(neighbours[i].id);
+		}
+
+		auto const* const x = stored(id);
+		for (auto const& n : neighbours) {
+			auto const other = static_cast<std::uint32_t>(n.id);
+			auto const lock = std::lock_guard(state_->lock_for(other));
+			auto* const list = links(other, layer);
+			if (list[0] < max_links(layer)) {
+				list[1 + list[0]] = id;
+				++list[0];
+				continue;
+			}
+
+			// Full, so keep the best of the old links and the new one
+			auto const* const y = stored(other);
+			auto candidates = std::vector<neighbour>{{id, distance(x, y)}};
+			for (auto i = std::uint32_t{1}; i <= list[0]; ++i)
+				candidates.push_back({list[i], distance(stored(list[i]), y)});
+			auto const kept = select_neighbours(std::move(candidates), max_links(layer));
+			list[0] = static_cast<std::uint32_t>(kept.size());
+			for (auto i = std::size_t{0}; i < kept.size(); ++i)
+				list[i + 1] = static_cast<std::uint32_t>(kept[i].id);
+		}
+	}
+
+	void hnsw_index::insert(std::uint32_t id) {
+		auto const level = levels_[id];
+		auto entry_lock = std::unique_lock(state_->entry_lock);
+		if (max_level_ < 0) {
+			entry_point_ = id;
+			max_level_ = level;
+			return;
+		}
+		auto const top = max_level_;
+		auto const entry = entry_point_;
+		if (level <= top)
+			entry_lock.unlock();
+
+		auto const* const x = stored(id);
+		auto closest = neighbour{entry, distance(x, stored(entry))};
+		closest = greedy_closest<true>(x, closest, top, level + 1);
+
+		auto entry_points = std::vector<neighbour>{closest};
+		for (auto layer = std::min(level, top); layer >= 0; --layer) {
+			auto candidates = search_layer<true>(x, entry_points, parameters_.ef_construction, layer);
+			connect(id, select_neighbours(candidates, parameters_.m), layer);
+			entry_points = std::move(candidates);
+		}
+
+		if (level > top) {
+			entry_point_ = id;
+			max_level_ = level;
+		}
+	}
+
+	void hnsw_index::reserve(std::size_t capacity) {
+		arena_.reserve(capacity * static_cast<std::size_t>(dimensions_));
+		levels_.reserve(capacity);
+		base_links_.reserve(capacity * (1 + max_links(0)));
+		upper_links_.reserve(capacity);
+	}
+
+	auto hnsw_index::add(euclidean_vector const& v) -> std::size_t {
+		return add_all(std::span<euclidean_vector const>(&v, 1));
+	}
+
+	auto hnsw_index::add_all(std::span<euclidean_vector const> vectors, thread_pool& pool)
+	   -> std::size_t {
+		for (auto const& v : vectors)
+			check_same_dimensions(dimensions_, v.dimensions());
+
+		// Everything the new vectors need is laid out up front, so nothing is reallocated while
+		// the graph is being linked in parallel
+		auto const first = size();
+		auto const d = static_cast<std::size_t>(dimensions_);
+		arena_.resize((first + vectors.size()) * d);
+		pool.parallel_for(vectors.size(), [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; ++i)
+				std::copy_n(vectors[i].data(), d, arena_.data() + (first + i) * d);
+		});
+
+		base_links_.resize((first + vectors.size()) * (1 + max_links(0)), 0);
+		for (auto i = std::size_t{0}; i < vectors.size(); ++i) {
+			auto const level = random_level();
+			levels_.push_back(level);
+			upper_links_.emplace_back(static_cast<std::size_t>(level) * (1 + max_links(1)), 0);
+		}
+
+		pool.parallel_for(vectors.size(), 1, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; ++i)
+				insert(static_cast<std::uint32_t>(first + i));
+		});
+		return first;
+	}
+
+	auto hnsw_index::search(euclidean_vector const& query, std::size_t k) const
+	   -> std::vector<neighbour> {
+		return search(query, k, parameters_.ef_search);
+	}
+
+	auto hnsw_index::search(euclidean_vector const& query, std::size_t k, std::size_t ef) const
+	   -> std::vector<neighbour> {
+		check_same_dimensions(dimensions_, query.dimensions());
+		if (max_level_ < 0 or k == 0)
+			return {};
+
+		auto const* const x = query.data();
+		auto closest = neighbour{entry_point_, distance(x, stored(entry_point_))};
+		closest = greedy_closest<false>(x, closest, max_level_, 1);
+		auto found = search_layer<false>(x, {closest}, std::max(ef, k), 0);
+
+		found.resize(std::min(found.size(), k));
+		if (metric_ == search_metric::l2)
+			for (auto& n : found)
+				n.distance = std::sqrt(n.distance);
+		return found;
+	}
+
+	void hnsw_index::save(std::string const& path) const {
+		auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+		if (not out)
+			throw std::runtime_error("Could not open " + path + " for writing");
+
+		write_value(out, file_magic);
+		write_value(out, file_version);
+		write_value(out, dimensions_);
+		write_value(out, metric_);
+		write_value(out, parameters_);
+		write_value(out, entry_point_);
+		write_value(out, max_level_);
+		write_values(out, levels_);
+		write_values(out, base_links_);
+		for (auto const& links : upper_links_)
+			write_values(out, links);
+		write_values(out, arena_);
+
+		auto generator = std::ostringstream();
+		generator << level_generator_;
+		auto const state = generator.str();
+		write_values(out, std::vector<char>(state.begin(), state.end()));
+
+		if (not out)
+			throw std::runtime_error("Could not write hnsw_index to " + path);
+	}
+
+	auto hnsw_index::load(std::string const& path) -> hnsw_index {
+		auto in = std::ifstream(path, std::ios::binary);
+		if (not in)
+			throw std::runtime_error("Could not open " + path + " for reading");
+		if (read_value<std::uint32_t>(in) != file_magic
+		    or read_value<std::uint32_t>(in) != file_version)
+			throw std::runtime_error(path + " does not hold a saved hnsw_index");
+
+		auto const dimensions = read_value<int>(in);
+		auto const metric = read_value<search_metric>(in);
+		auto const parameters = read_value<hnsw_parameters>(in);
+		auto index = hnsw_index(dimensions, metric, parameters);
+		index.entry_point_ = read_value<std::uint32_t>(in);
+		index.max_level_ = read_value<int>(in);
+		index.levels_ = read_values<int>(in);
+		index.base_links_ = read_values<std::uint32_t>(in);
+		for (auto i = std::size_t{0}; in and i < index.levels_.size(); ++i)
+			index.upper_links_.push_back(read_values<std::uint32_t>(in));
+		index.arena_ = read_values<double>(in);
+
+		auto const state = read_values<char>(in);
+		auto generator = std::istringstream(std::string(state.begin(), state.end()));
+		generator >> index.level_generator_;
+
+		auto const count = index.levels_.size();
+		auto const consistent =
+		   in and generator and index.base_links_.size() == count * (1 + index.max_links(0))
+		   and index.arena_.size() == count * static_cast<std::size_t>(dimensions)
+		   and index.upper_links_.size() == count and index.graph_consistent();
+		if (not consistent)
+			throw std::runtime_error("Could not read hnsw_index from " + path);
+		return index;
+	}
+} // namespace comp6771
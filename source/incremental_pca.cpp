@@ -0,0 +1,330 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/incremental_pca.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// Samples folded into the basis per update. The eigenproblem solved for each update is at
+		// most (components + update_block + 1) square, and costs the cube of that.
+		constexpr auto update_block = std::size_t{64};
+		// Vectors projected per gemm in transform_all
+		constexpr auto gemm_block = std::size_t{1024};
+		// Eigenvalues of the stacked Gram matrix smaller than this fraction of the largest are
+		// rounding error rather than directions in the data
+		constexpr auto rank_tolerance = 1e-14;
+		constexpr auto max_sweeps = 64;
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		struct eigensystem {
+			// Largest first
+			std::vector<double> values;
+			// Row-major, with column i the unit eigenvector for values[i]
+			std::vector<double> vectors;
+		};
+
+		// Cyclic Jacobi for a symmetric n x n row-major matrix. Slower than a tridiagonal QR, but
+		// simple, and accurate to rounding for the small matrices the updates produce.
+		auto symmetric_eigen(std::vector<double> a, std::size_t n) -> eigensystem {
+			auto v = std::vector<double>(n * n, 0.0);
+			for (auto i = std::size_t{0}; i < n; ++i)
+				v[i * n + i] = 1.0;
+
+			auto const epsilon = std::numeric_limits<double>::epsilon();
+			for (auto sweep = 0; sweep < max_sweeps; ++sweep) {
+				auto off_diagonal = 0.0;
+				auto diagonal = 0.0;
+				for (auto p = std::size_t{0}; p < n; ++p) {
+					diagonal += a[p * n + p] * a[p * n + p];
+					for (auto q = p + 1; q < n; ++q)
+						off_diagonal += a[p * n + q] * a[p * n + q];
+				}
+				if (off_diagonal <= epsilon * epsilon * diagonal)
+					break;
+
+				for (auto p = std::size_t{0}; p + 1 < n; ++p)
+					for (auto q = p + 1; q < n; ++q) {
+						auto const apq = a[p * n + q];
+						if (apq == 0.0)
+							continue;
+
+						// The rotation that zeroes a(p, q), through the smaller of the two angles
+						auto const theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+						auto const t =
+						   std::copysign(1.0, theta) / (std::abs(theta) + std::hypot(theta, 1.0));
+						auto const c = 1.0 / std::hypot(t, 1.0);
+						auto const s = t * c;
+						for (auto k = std::size_t{0}; k < n; ++k) {
+							auto const x = a[k * n + p];
+							auto const y = a[k * n + q];
+							a[k * n + p] = c * x - s * y;
+							a[k * n + q] = s * x + c * y;
+						}
+						for (auto k = std::size_t{0}; k < n; ++k) {
+							auto const x = a[p * n + k];
+							auto const y = a[q * n + k];
+							a[p * n + k] = c * x - s * y;
+							a[q * n + k] = s * x + c * y;
+						}
+						for (auto k = std::size_t{0}; k < n; ++k) {
+							auto const x = v[k * n + p];
+							auto const y = v[k * n + q];
+							v[k * n + p] = c * x - s * y;
+							v[k * n + q] = s * x + c * y;
+						}
+						a[p * n + q] = 0.0;
+						a[q * n + p] = 0.0;
+					}
+			}
+
+			auto order = std::vector<std::size_t>(n);
+			std::iota(order.begin(), order.end(), std::size_t{0});
+			std::ranges::stable_sort(order, [&](std::size_t i, std::size_t j) {
+				return a[i * n + i] > a[j * n + j];
+			});
+
+			auto result = eigensystem{std::vector<double>(n), std::vector<double>(n * n)};
+			for (auto i = std::size_t{0}; i < n; ++i) {
+				result.values[i] = a[order[i] * n + order[i]];
+				for (auto k = std::size_t{0}; k < n; ++k)
+					result.vectors[k * n + i] = v[k * n + order[i]];
+			}
+			return result;
+		}
+
+		auto column(eigensystem const& eigen, std::size_t n, std::size_t i) -> std::vector<double> {
+			auto result = std::vector<double>(n);
+			for (auto k = std::size_t{0}; k < n; ++k)
+				result[k] = eigen.vectors[k * n + i];
+			return result;
+		}
+
+		// How many of the leading eigenvalues are directions in the data, up to `limit`
+		auto rank(std::vector<double> const& values, std::size_t limit) -> std::size_t {
+			if (values.empty() or values.front() <= 0.0)
+				return 0;
+			auto const threshold = rank_tolerance * values.front();
+			auto const found =
+			   std::ranges::find_if(values, [&](double x) { return x <= threshold; });
+			return std::min(limit, static_cast<std::size_t>(found - values.begin()));
+		}
+	} // namespace
+
+	incremental_pca::incremental_pca(int dimensions, std::size_t components)
+	: max_components_(components)
+	, mean_(std::max(dimensions, 0)) {
+		if (dimensions < 1)
+			throw std::invalid_argument("incremental_pca needs at least one dimension");
+		if (components < 1 or components > static_cast<std::size_t>(dimensions)) {
+			throw std::invalid_argument("Number of components(" + std::to_string(components)
+			                            + ") must be between 1 and the dimensions("
+			                            + std::to_string(dimensions) + ")");
+		}
+	}
+
+	auto incremental_pca::explained_variance() const -> std::vector<double> {
+		auto result = std::vector<double>(singular_values_.size(), 0.0);
+		if (samples_seen_ < 2)
+			return result;
+		auto const degrees_of_freedom = static_cast<double>(samples_seen_ - 1);
+		std::ranges::transform(singular_values_, result.begin(), [&](double s) {
+			return s * s / degrees_of_freedom;
+		});
+		return result;
+	}
+
+	auto incremental_pca::explained_variance_ratio() const -> std::vector<double> {
+		auto result = std::vector<double>(singular_values_.size(), 0.0);
+		if (squared_deviation_ <= 0.0)
+			return result;
+		std::ranges::transform(singular_values_, result.begin(), [&](double s) {
+			return s * s / squared_deviation_;
+		});
+		return result;
+	}
+
+	void incremental_pca::partial_fit(euclidean_vector const& sample) {
+		partial_fit(std::span<euclidean_vector const>(&sample, 1));
+	}
+
+	void incremental_pca::partial_fit(std::span<euclidean_vector const> samples,
+	                                  thread_pool& pool) {
+		for (auto const& v : samples)
+			check_same_dimensions(dimensions(), v.dimensions());
+		for (auto first = std::size_t{0}; first < samples.size(); first += update_block)
+			update(samples.subspan(first, std::min(update_block, samples.size() - first)), pool);
+	}
+
+	// With n samples already seen, mean m and basis V S, and a block X of b samples with mean m_b,
+	// the stack is
+	//     S V
+	//     X - m_b
+	//     sqrt(n b / (n + b)) (m - m_b)
+	// and stack^T stack is the scatter matrix of all n + b samples about their mean, less whatever
+	// earlier updates discarded. Its top right singular vectors are the new components.
+	void incremental_pca::update(std::span<euclidean_vector const> block, thread_pool& pool) {
+		auto const d = static_cast<std::size_t>(dimensions());
+		auto const n = samples_seen_;
+		auto const b = block.size();
+		auto const total = n + b;
+
+		auto block_mean = euclidean_vector(dimensions());
+		auto const weights = std::vector<double>(b, 1.0 / static_cast<double>(b));
+		lincomb(weights, block, block_mean);
+
+		auto const kept = components_.size();
+		auto stack = std::vector<euclidean_vector>(kept + b);
+		auto block_deviation = std::vector<double>(b);
+		pool.parallel_for(kept + b, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i) {
+				if (i < kept) {
+					stack[i] = components_[i];
+					stack[i] *= singular_values_[i];
+					continue;
+				}
+				stack[i] = block[i - kept];
+				stack[i] -= block_mean;
+				block_deviation[i - kept] = dot(stack[i], stack[i]);
+			}
+		});
+
+		auto shift = block_mean;
+		shift -= mean_;
+		auto const shift_weight = static_cast<double>(n) * static_cast<double>(b)
+		                          / static_cast<double>(total);
+		if (n > 0) {
+			stack.push_back(shift);
+			stack.back() *= std::sqrt(shift_weight);
+		}
+
+		squared_deviation_ += std::reduce(block_deviation.begin(), block_deviation.end())
+		                      + shift_weight * dot(shift, shift);
+		axpy(static_cast<double>(b) / static_cast<double>(total), shift, mean_);
+		samples_seen_ = total;
+
+		// The smaller of the two Gram matrices of the stack has the same nonzero eigenvalues
+		auto const m = stack.size();
+		auto components = std::vector<euclidean_vector>();
+		auto singular_values = std::vector<double>();
+		if (m <= d) {
+			auto const gram =
+			   gemm(dense_matrix::from_rows(stack), dense_matrix::from_columns(stack));
+			auto const eigen =
+			   symmetric_eigen(std::vector<double>(gram.data(), gram.data() + m * m), m);
+			components.resize(rank(eigen.values, max_components_));
+			singular_values.resize(components.size());
+			pool.parallel_for(components.size(), 1, [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					// The right singular vector is stack^T u / s; dividing by its computed length
+					// rather than s keeps it unit length to rounding
+					components[i] = euclidean_vector(dimensions());
+					lincomb(column(eigen, m, i), stack, components[i]);
+					singular_values[i] = euclidean_norm(components[i]);
+					components[i] /= singular_values[i];
+				}
+			});
+		}
+		else {
+			auto const scatter =
+			   gemm(dense_matrix::from_columns(stack), dense_matrix::from_rows(stack));
+			auto const eigen =
+			   symmetric_eigen(std::vector<double>(scatter.data(), scatter.data() + d * d), d);
+			components.resize(rank(eigen.values, max_components_));
+			singular_values.resize(components.size());
+			for (auto i = std::size_t{0}; i < components.size(); ++i) {
+				auto const values = column(eigen, d, i);
+				components[i] = euclidean_vector(values.begin(), values.end());
+				singular_values[i] = std::sqrt(eigen.values[i]);
+			}
+		}
+		set_components(std::move(components), std::move(singular_values));
+	}
+
+	void incremental_pca::set_components(std::vector<euclidean_vector> components,
+	                                     std::vector<double> singular_values) {
+		for (auto& component : components) {
+			auto const* const first = component.data();
+			auto const* const last = first + component.dimensions();
+			auto const largest = std::max_element(first, last, [](double x, double y) {
+				return std::abs(x) < std::abs(y);
+			});
+			if (*largest < 0.0)
+				component *= -1.0;
+		}
+
+		components_ = std::move(components);
+		singular_values_ = std::move(singular_values);
+		basis_ = dense_matrix::from_rows(components_);
+		basis_by_column_ = dense_matrix::from_columns(components_, matrix_layout::column_major);
+		projected_mean_.assign(components_.size(), 0.0);
+		if (not components_.empty()) {
+			auto const projected = gemv(basis_, mean_);
+			std::copy_n(projected.data(), components_.size(), projected_mean_.data());
+		}
+	}
+
+	auto incremental_pca::transform(euclidean_vector const& v) const -> euclidean_vector {
+		check_same_dimensions(dimensions(), v.dimensions());
+		if (components_.empty())
+			return euclidean_vector(0);
+
+		auto result = gemv(basis_, v);
+		auto* const out = result.mutable_data();
+		for (auto i = std::size_t{0}; i < components_.size(); ++i)
+			out[i] -= projected_mean_[i];
+		return result;
+	}
+
+	auto incremental_pca::transform_all(std::span<euclidean_vector const> vectors,
+	                                    thread_pool& pool) const -> std::vector<euclidean_vector> {
+		for (auto const& v : vectors)
+			check_same_dimensions(dimensions(), v.dimensions());
+
+		auto const k = components_.size();
+		auto out =
+		   std::vector<euclidean_vector>(vectors.size(), euclidean_vector(static_cast<int>(k)));
+		if (k == 0)
+			return out;
+
+		for (auto first = std::size_t{0}; first < vectors.size(); first += gemm_block) {
+			auto const block = vectors.subspan(first, std::min(gemm_block, vectors.size() - first));
+			auto const projected = gemm(dense_matrix::from_rows(block), basis_by_column_);
+			pool.parallel_for(block.size(), [&](std::size_t begin, std::size_t end) {
+				for (auto i = begin; i < end; ++i) {
+					auto const row = projected.row(static_cast<int>(i));
+					auto* const y = out[first + i].mutable_data();
+					for (auto j = std::size_t{0}; j < k; ++j)
+						y[j] = row[static_cast<int>(j)] - projected_mean_[j];
+				}
+			});
+		}
+		return out;
+	}
+
+	auto incremental_pca::inverse_transform(euclidean_vector const& coordinates) const
+	   -> euclidean_vector {
+		check_same_dimensions(static_cast<int>(components_.size()), coordinates.dimensions());
+		auto result = euclidean_vector(dimensions());
+		if (not components_.empty()) {
+			lincomb(std::span<double const>(coordinates.data(), components_.size()),
+			        components_,
+			        result);
+		}
+		result += mean_;
+		return result;
+	}
+} // namespace comp6771
@@ -0,0 +1,205 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/ivf_index.hpp>
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+			return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+		}
+
+		// Keeps the k closest of `candidates`, sorted
+		void keep_closest(std::vector<neighbour>& candidates, std::size_t k) {
+			auto const keep = std::min(k, candidates.size());
+			auto const middle = candidates.begin() + static_cast<std::ptrdiff_t>(keep);
+			std::partial_sort(candidates.begin(), middle, candidates.end(), closer);
+			candidates.resize(keep);
+		}
+	} // namespace
+
+	auto ivf_index::train(std::span<euclidean_vector const> training,
+	                      search_metric metric,
+	                      ivf_parameters const& parameters,
+	                      thread_pool& pool) -> ivf_index {
+		if (training.empty())
+			throw std::invalid_argument("ivf_index needs at least one training vector");
+
+		auto index = ivf_index();
+		index.dimensions_ = training.front().dimensions();
+		index.metric_ = metric;
+		index.parameters_ = parameters;
+		auto coarse = kmeans(training, parameters.lists, parameters.kmeans, pool);
+		index.centroids_ = std::move(coarse.centroids);
+		index.lists_.resize(index.centroids_.size());
+
+		if (parameters.code_size > 0) {
+			auto residuals = std::vector<euclidean_vector>(training.size());
+			pool.parallel_for(training.size(), [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					residuals[i] = training[i] - index.centroids_[coarse.assignments[i]];
+			});
+			index.residual_quantizer_ = product_quantizer::train(residuals,
+			                                                     parameters.code_size,
+			                                                     256,
+			                                                     parameters.kmeans,
+			                                                     pool);
+		}
+		return index;
+	}
+
+	auto ivf_index::add(euclidean_vector const& v) -> std::size_t {
+		return add_all(std::span<euclidean_vector const>(&v, 1));
+	}
+
+	auto ivf_index::add_all(std::span<euclidean_vector const> vectors, thread_pool& pool)
+	   -> std::size_t {
+		for (auto const& v : vectors)
+			check_same_dimensions(dimensions_, v.dimensions());
+
+		auto const code_size = parameters_.code_size;
+		auto assignments = std::vector<std::size_t>(vectors.size());
+		auto codes = std::vector<std::uint8_t>(residual_quantizer_ ? vectors.size() * code_size : 0);
+		pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i) {
+				assignments[i] = nearest_centroid(centroids_, vectors[i]);
+				if (residual_quantizer_) {
+					residual_quantizer_->encode(vectors[i] - centroids_[assignments[i]],
+					                            std::span(codes).subspan(i * code_size, code_size));
+				}
+			}
+		});
+
+		auto members = std::vector<std::vector<std::size_t>>(lists_.size());
+		for (auto i = std::size_t{0}; i < vectors.size(); ++i)
+			members[assignments[i]].push_back(i);
+
+		// Each list only receives its own vectors, so the lists are appended to side by side
+		auto const first_id = size_;
+		auto const d = static_cast<std::size_t>(dimensions_);
+		pool.parallel_for(lists_.size(), 1, [&](std::size_t first, std::size_t last) {
+			for (auto list = first; list < last; ++list) {
+				auto& posting = lists_[list];
+				for (auto const i : members[list]) {
+					posting.ids.push_back(first_id + i);
+					if (residual_quantizer_) {
+						auto const code = codes.begin() + static_cast<std::ptrdiff_t>(i * code_size);
+						posting.codes.insert(posting.codes.end(),
+						                     code,
+						                     code + static_cast<std::ptrdiff_t>(code_size));
+					}
+					else {
+						posting.vectors.insert(posting.vectors.end(),
+						                       vectors[i].data(),
+						                       vectors[i].data() + d);
+					}
+				}
+			}
+		});
+		size_ += vectors.size();
+		return first_id;
+	}
+
+	auto ivf_index::probe_order(euclidean_vector const& query, std::size_t nprobe) const
+	   -> std::vector<std::size_t> {
+		auto scored = std::vector<neighbour>();
+		scored.reserve(centroids_.size());
+		for (auto list = std::size_t{0}; list < centroids_.size(); ++list) {
+			scored.push_back({list,
+			                  metric_ == search_metric::l2 ? squared_distance(query, centroids_[list])
+			                                               : -dot(query, centroids_[list])});
+		}
+		keep_closest(scored, nprobe);
+
+		auto order = std::vector<std::size_t>();
+		for (auto const& s : scored)
+			order.push_back(s.id);
+		return order;
+	}
+
+	// Ranked by squared distance for l2, so the square root is only taken for the k results
+	auto ivf_index::scan(std::size_t list, euclidean_vector const& query, std::size_t k) const
+	   -> std::vector<neighbour> {
+		auto const& posting = lists_[list];
+		auto const count = posting.ids.size();
+		auto candidates = std::vector<neighbour>();
+		candidates.reserve(count);
+
+		if (residual_quantizer_) {
+			auto const& quantizer = *residual_quantizer_;
+			auto const code_size = quantizer.code_size();
+			auto const& centroid = centroids_[list];
+			// |q - x|^2 = |(q - c) - r|^2, and -q.x = -q.c - q.r. The residual is built from the raw
+			// magnitudes, since the probes share `query` and copying a vector touches its caches.
+			auto const table = [&] {
+				if (metric_ != search_metric::l2)
+					return quantizer.distance_table(query, metric_);
+				auto const d = static_cast<std::size_t>(dimensions_);
+				auto residual = std::vector<double>(query.data(), query.data() + d);
+				kernels::axpy(-1.0, centroid.data(), residual.data(), d);
+				return quantizer.distance_table(euclidean_vector::from(std::move(residual)), metric_);
+			}();
+			auto const base = metric_ == search_metric::l2 ? 0.0 : -dot(query, centroid);
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				auto const code = std::span(posting.codes).subspan(i * code_size, code_size);
+				candidates.push_back({posting.ids[i], base + quantizer.adc_distance(table, code)});
+			}
+		}
+		else {
+			auto const d = static_cast<std::size_t>(dimensions_);
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				auto const* const row = posting.vectors.data() + i * d;
+				candidates.push_back({posting.ids[i],
+				                      metric_ == search_metric::l2
+				                         ? kernels::squared_distance(query.data(), row, d)
+				                         : -kernels::dot(query.data(), row, d)});
+			}
+		}
+		keep_closest(candidates, k);
+		return candidates;
+	}
+
+	auto ivf_index::search(euclidean_vector const& query, std::size_t k, thread_pool& pool) const
+	   -> std::vector<neighbour> {
+		return search(query, k, parameters_.nprobe, pool);
+	}
+
+	auto ivf_index::search(euclidean_vector const& query,
+	                       std::size_t k,
+	                       std::size_t nprobe,
+	                       thread_pool& pool) const -> std::vector<neighbour> {
+		check_same_dimensions(dimensions_, query.dimensions());
+		auto const probes = probe_order(query, nprobe);
+
+		// Each probed list keeps its own top k, and the lists are merged in probe order
+		auto partial = std::vector<std::vector<neighbour>>(probes.size());
+		pool.parallel_for(probes.size(), 1, [&](std::size_t first, std::size_t last) {
+			for (auto p = first; p < last; ++p)
+				partial[p] = scan(probes[p], query, k);
+		});
+
+		auto result = std::vector<neighbour>();
+		for (auto const& candidates : partial)
+			result.insert(result.end(), candidates.begin(), candidates.end());
+		keep_closest(result, k);
+		if (metric_ == search_metric::l2)
+			for (auto& n : result)
+				n.distance = std::sqrt(std::max(n.distance, 0.0));
+		return result;
+	}
+} // namespace comp6771
@@ -0,0 +1,138 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/kd_tree.hpp>
+
+#include "kernels.hpp"
+#include "spatial_tree.hpp"
+
+namespace comp6771 {
+	kd_tree::kd_tree(std::span<euclidean_vector const> vectors,
+	                 std::size_t leaf_size,
+	                 thread_pool& pool) {
+		auto layout = spatial::build_layout(vectors, leaf_size, pool);
+		dimensions_ = layout.dimensions;
+		depth_ = layout.depth;
+		arena_ = std::move(layout.arena);
+		ids_ = std::move(layout.ids);
+
+		splits_.reserve(layout.split_dimensions.size());
+		for (auto node = std::size_t{0}; node < layout.split_dimensions.size(); ++node)
+			splits_.push_back({layout.split_values[node], layout.split_dimensions[node]});
+	}
+
+	auto kd_tree::row(std::size_t i) const noexcept -> double const* {
+		return arena_.data() + i * static_cast<std::size_t>(dimensions_);
+	}
+
+	auto kd_tree::knn(euclidean_vector const& query, std::size_t k) const -> std::vector<neighbour> {
+		spatial::check_query(*this, query);
+		auto best = spatial::nearest_set(k);
+		if (ids_.empty() or k == 0)
+			return best.take();
+
+		auto const* const q = query.data();
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto stack = spatial::frame_stack();
+		auto top = std::size_t{0};
+		stack[top++] = {0, 0, size(), 0, 0.0};
+		while (top > 0) {
+			auto const f = stack[--top];
+			if (f.bound > best.bound())
+				continue;
+
+			if (f.level == depth_) {
+				for (auto i = f.first; i < f.last; ++i)
+					best.offer(ids_[i], kernels::squared_distance(q, row(i), d));
+				continue;
+			}
+
+			// Searching the near side first tightens the bound before the far side is considered
+			auto const mid = spatial::middle(f.first, f.last);
+			auto const [value, dimension] = splits_[f.node];
+			auto const offset = q[dimension] - value;
+			auto const left = spatial::frame{2 * f.node + 1, f.first, mid, f.level + 1, f.bound};
+			auto const right = spatial::frame{2 * f.node + 2, mid, f.last, f.level + 1, f.bound};
+			auto near = offset < 0 ? left : right;
+			auto far = offset < 0 ? right : left;
+			far.bound = std::max(f.bound, offset * offset);
+			stack[top++] = far;
+			stack[top++] = near;
+		}
+		return best.take();
+	}
+
+	// Calls visit(id, squared distance) for every vector within the radius, until visit returns
+	// false. Returns whether the search ran to completion.
+	template<typename Visit>
+	auto kd_tree::visit_within(double const* query, double squared_radius, Visit& visit) const
+	   -> bool {
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto stack = spatial::frame_stack();
+		auto top = std::size_t{0};
+		stack[top++] = {0, 0, size(), 0, 0.0};
+		while (top > 0) {
+			auto const f = stack[--top];
+			if (f.level == depth_) {
+				for (auto i = f.first; i < f.last; ++i) {
+					auto const squared = kernels::squared_distance(query, row(i), d);
+					if (squared <= squared_radius and not visit(ids_[i], squared))
+						return false;
+				}
+				continue;
+			}
+
+			auto const mid = spatial::middle(f.first, f.last);
+			auto const [value, dimension] = splits_[f.node];
+			auto const offset = query[dimension] - value;
+			// Points on the other side of the split are at least |offset| away
+			auto const reaches_across = offset * offset <= squared_radius;
+			if (offset < 0 or reaches_across)
+				stack[top++] = {2 * f.node + 1, f.first, mid, f.level + 1, 0.0};
+			if (offset >= 0 or reaches_across)
+				stack[top++] = {2 * f.node + 2, mid, f.last, f.level + 1, 0.0};
+		}
+		return true;
+	}
+
+	auto kd_tree::radius_search(euclidean_vector const& query, double radius) const
+	   -> std::vector<neighbour> {
+		spatial::check_query(*this, query);
+		auto found = std::vector<neighbour>();
+		if (ids_.empty() or radius < 0)
+			return found;
+
+		auto collect = [&](std::size_t id, double squared) {
+			found.push_back({id, squared});
+			return true;
+		};
+		visit_within(query.data(), radius * radius, collect);
+		spatial::finish_radius_search(found);
+		return found;
+	}
+
+	auto kd_tree::any_within(euclidean_vector const& query, double radius) const -> bool {
+		spatial::check_query(*this, query);
+		if (ids_.empty() or radius < 0)
+			return false;
+
+		auto stop = [](std::size_t, double) { return false; };
+		return not visit_within(query.data(), radius * radius, stop);
+	}
+
+	auto kd_tree::knn(std::span<euclidean_vector const> queries,
+	                  std::size_t k,
+	                  thread_pool& pool) const -> std::vector<std::vector<neighbour>> {
+		return spatial::search_all(*this, queries, pool, [&](euclidean_vector const& query) {
+			return knn(query, k);
+		});
+	}
+
+	auto kd_tree::radius_search(std::span<euclidean_vector const> queries,
+	                            double radius,
+	                            thread_pool& pool) const -> std::vector<std::vector<neighbour>> {
+		return spatial::search_all(*this, queries, pool, [&](euclidean_vector const& query) {
+			return radius_search(query, radius);
+		});
+	}
+} // namespace comp6771
@@ -0,0 +1,446 @@
+#ifndef COMP6771_KERNELS_HPP
+#define COMP6771_KERNELS_HPP
+
+// Raw-pointer loops shared by the euclidean_vector implementation files. Each kernel works on
+// fixed-width blocks with independent lanes so that optimised builds vectorise them, and finishes
+// the remainder with a scalar tail.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace comp6771::kernels {
+	inline constexpr std::size_t block_width = 8;
+
+	// Exact elementwise equality (so -0.0 == 0.0 and NaN != NaN), exiting after the first block
+	// that contains a mismatch.
+	inline auto equal(double const* x, double const* y, std::size_t n) noexcept -> bool {
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width) {
+			auto mismatch = false;
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				mismatch |= x[i + lane] != y[i + lane];
+			if (mismatch)
+				return false;
+		}
+		for (; i < n; ++i)
+			if (x[i] != y[i])
+				return false;
+		return true;
+	}
+
+	// |x - y| <= max(abs_tol, rel_tol * max(|x|, |y|)) for every element. Equal infinities match;
+	// NaN never does.
+	inline auto approx_equal(double const* x,
+	                         double const* y,
+	                         std::size_t n,
+	                         double abs_tol,
+	                         double rel_tol) noexcept -> bool {
+		auto const close = [=](double a, double b) {
+			// An infinite operand would make the relative tolerance infinite too
+			if (std::isinf(a) or std::isinf(b))
+				return a == b;
+			auto const tolerance = std::fmax(abs_tol, rel_tol * std::fmax(std::fabs(a), std::fabs(b)));
+			return a == b or std::fabs(a - b) <= tolerance;
+		};
+
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width) {
+			auto mismatch = false;
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				mismatch |= not close(x[i + lane], y[i + lane]);
+			if (mismatch)
+				return false;
+		}
+		for (; i < n; ++i)
+			if (not close(x[i], y[i]))
+				return false;
+		return true;
+	}
+
+	// Maps a double onto a signed integer line where adjacent representable values are adjacent
+	// integers, and -0.0 and +0.0 share a position.
+	inline auto ordered_bits(double x) noexcept -> std::int64_t {
+		auto const bits = std::bit_cast<std::int64_t>(x);
+		return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+	}
+
+	inline auto ulp_distance(double x, double y) noexcept -> std::uint64_t {
+		if (std::isnan(x) or std::isnan(y))
+			return std::numeric_limits<std::uint64_t>::max();
+		auto const a = ordered_bits(x);
+		auto const b = ordered_bits(y);
+		return a > b ? static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b)
+		             : static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a);
+	}
+
+	inline auto max_ulp_distance(double const* x, double const* y, std::size_t n) noexcept
+	   -> std::uint64_t {
+		auto result = std::uint64_t{0};
+		for (auto i = std::size_t{0}; i < n; ++i)
+			result = std::max(result, ulp_distance(x[i], y[i]));
+		return result;
+	}
+
+	inline auto
+	ulp_equal(double const* x, double const* y, std::size_t n, std::uint64_t max_ulps) noexcept
+	   -> bool {
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width) {
+			auto mismatch = false;
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				mismatch |= ulp_distance(x[i + lane], y[i + lane]) > max_ulps;
+			if (mismatch)
+				return false;
+		}
+		for (; i < n; ++i)
+			if (ulp_distance(x[i], y[i]) > max_ulps)
+				return false;
+		return true;
+	}
+
+	// Lane accumulators are summed pairwise so the result does not depend on how the compiler
+	// schedules the lanes.
+	inline auto horizontal_sum(double const (&acc)[block_width]) noexcept -> double {
+		return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+	}
+
+	inline auto horizontal_max(double const (&acc)[block_width]) noexcept -> double {
+		return std::max(std::max(std::max(acc[0], acc[1]), std::max(acc[2], acc[3])),
+		                std::max(std::max(acc[4], acc[5]), std::max(acc[6], acc[7])));
+	}
+
+	// Fused multiply-add when the target has one in hardware; std::fma is a slow library call
+	// otherwise.
+	inline auto multiply_add(double a, double b, double c) noexcept -> double {
+#ifdef FP_FAST_FMA
+		return std::fma(a, b, c);
+#else
+		return a * b + c;
+#endif
+	}
+
+	inline void scale(double* x, std::size_t n, double factor) noexcept {
+		for (auto i = std::size_t{0}; i < n; ++i)
+			x[i] *= factor;
+	}
+
+	inline auto dot(double const* x, double const* y, std::size_t n) noexcept -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				acc[lane] += x[i + lane] * y[i + lane];
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane)
+			acc[lane] += x[i] * y[i];
+		return horizontal_sum(acc);
+	}
+
+	inline auto squared_norm(double const* x, std::size_t n) noexcept -> double {
+		return dot(x, x, n);
+	}
+
+	// Blue's algorithm, as used by LAPACK's dnrm2: elements are binned into small, medium and big
+	// accumulators, with the outer two scaled by powers of two so that no square overflows or
+	// underflows. Infinities give infinity and NaN gives NaN.
+	inline auto scaled_norm(double const* x, std::size_t n) noexcept -> double {
+		auto const tsml = std::ldexp(1.0, -511);
+		auto const tbig = std::ldexp(1.0, 486);
+		auto const ssml = std::ldexp(1.0, 537);
+		auto const sbig = std::ldexp(1.0, -538);
+
+		auto asml = 0.0;
+		auto amed = 0.0;
+		auto abig = 0.0;
+		auto notbig = true;
+		for (auto i = std::size_t{0}; i < n; ++i) {
+			auto const ax = std::fabs(x[i]);
+			if (ax > tbig) {
+				abig += (ax * sbig) * (ax * sbig);
+				notbig = false;
+			}
+			else if (ax < tsml) {
+				if (notbig)
+					asml += (ax * ssml) * (ax * ssml);
+			}
+			else {
+				amed += ax * ax;
+			}
+		}
+
+		if (abig > 0) {
+			if (amed > 0 or std::isnan(amed))
+				abig += (amed * sbig) * sbig;
+			return std::sqrt(abig) / sbig;
+		}
+		if (asml > 0) {
+			if (not(amed > 0 or std::isnan(amed)))
+				return std::sqrt(asml) / ssml;
+			auto const med = std::sqrt(amed);
+			auto const sml = std::sqrt(asml) / ssml;
+			auto const ymin = std::min(med, sml);
+			auto const ymax = std::max(med, sml);
+			return std::sqrt(ymax * ymax * (1 + (ymin / ymax) * (ymin / ymax)));
+		}
+		return std::sqrt(amed);
+	}
+
+	// Takes a squared norm from the fast kernels and only redoes the work with scaled_norm() when
+	// the sum may have overflowed, or is small enough that squares of some elements underflowed.
+	inline auto norm_from_squared(double squared_norm, double const* x, std::size_t n) noexcept
+	   -> double {
+		auto const smallest_safe = std::ldexp(1.0, -968);
+		auto const largest_safe = std::numeric_limits<double>::max();
+		if (squared_norm >= smallest_safe and squared_norm <= largest_safe) [[likely]]
+			return std::sqrt(squared_norm);
+		return scaled_norm(x, n);
+	}
+
+	// Writes y[i] = op(i) for every element and returns the squared norm of the new y. Lanes match
+	// squared_norm(), so the result can be cached as the norm without a second pass.
+	template<typename Op>
+	inline auto update_with_squared_norm(double* y, std::size_t n, Op op) noexcept -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane) {
+				auto const value = op(i + lane);
+				y[i + lane] = value;
+				acc[lane] += value * value;
+			}
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane) {
+			auto const value = op(i);
+			y[i] = value;
+			acc[lane] += value * value;
+		}
+		return horizontal_sum(acc);
+	}
+
+	inline auto axpy(double alpha, double const* x, double* y, std::size_t n) noexcept -> double {
+		return update_with_squared_norm(y, n, [=](std::size_t i) {
+			return multiply_add(alpha, x[i], y[i]);
+		});
+	}
+
+	inline auto axpby(double alpha, double const* x, double beta, double* y, std::size_t n) noexcept
+	   -> double {
+		return update_with_squared_norm(y, n, [=](std::size_t i) {
+			return multiply_add(alpha, x[i], beta * y[i]);
+		});
+	}
+
+	// y = sum of coefficients[j] * input(j), and returns the squared norm of y. Works through y in
+	// chunks small enough to stay in L1 while every input is streamed over it, so each input is
+	// read once and y is written once. y must not alias any input.
+	template<typename Input>
+	inline auto lincomb(double const* coefficients,
+	                    Input input,
+	                    std::size_t count,
+	                    double* y,
+	                    std::size_t n) noexcept -> double {
+		constexpr auto chunk = std::size_t{512};
+		static_assert(chunk % block_width == 0);
+
+		double acc[block_width] = {};
+		for (auto start = std::size_t{0}; start < n; start += chunk) {
+			auto const end = std::min(n, start + chunk);
+			if (count == 0) {
+				std::fill(y + start, y + end, 0.0);
+			}
+			else {
+				auto const* const first = input(0);
+				for (auto i = start; i < end; ++i)
+					y[i] = coefficients[0] * first[i];
+				for (auto j = std::size_t{1}; j < count; ++j) {
+					auto const* const x = input(j);
+					for (auto i = start; i < end; ++i)
+						y[i] = multiply_add(coefficients[j], x[i], y[i]);
+				}
+			}
+
+			auto i = start;
+			for (; i + block_width <= end; i += block_width)
+				for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+					acc[lane] += y[i + lane] * y[i + lane];
+			for (auto lane = std::size_t{0}; i < end; ++i, ++lane)
+				acc[lane] += y[i] * y[i];
+		}
+		return horizontal_sum(acc);
+	}
+
+	struct dot_with_norms {
+		double xy;
+		double xx;
+		double yy;
+
+		friend auto operator+(dot_with_norms a, dot_with_norms b) noexcept -> dot_with_norms {
+			return {a.xy + b.xy, a.xx + b.xx, a.yy + b.yy};
+		}
+	};
+
+	// One pass computing x.y along with both squared norms. Lane assignment matches dot() and
+	// squared_norm(), so each component is bit-identical to computing it separately.
+	inline auto dot_and_squared_norms(double const* x, double const* y, std::size_t n) noexcept
+	   -> dot_with_norms {
+		double xy[block_width] = {};
+		double xx[block_width] = {};
+		double yy[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane) {
+				xy[lane] += x[i + lane] * y[i + lane];
+				xx[lane] += x[i + lane] * x[i + lane];
+				yy[lane] += y[i + lane] * y[i + lane];
+			}
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane) {
+			xy[lane] += x[i] * y[i];
+			xx[lane] += x[i] * x[i];
+			yy[lane] += y[i] * y[i];
+		}
+		return {horizontal_sum(xy), horizontal_sum(xx), horizontal_sum(yy)};
+	}
+
+	inline auto squared_distance(double const* x, double const* y, std::size_t n) noexcept
+	   -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane) {
+				auto const d = x[i + lane] - y[i + lane];
+				acc[lane] += d * d;
+			}
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane) {
+			auto const d = x[i] - y[i];
+			acc[lane] += d * d;
+		}
+		return horizontal_sum(acc);
+	}
+
+	inline auto manhattan_distance(double const* x, double const* y, std::size_t n) noexcept
+	   -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				acc[lane] += std::fabs(x[i + lane] - y[i + lane]);
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane)
+			acc[lane] += std::fabs(x[i] - y[i]);
+		return horizontal_sum(acc);
+	}
+
+	// NaN elements are ignored, as with std::max
+	inline auto chebyshev_distance(double const* x, double const* y, std::size_t n) noexcept
+	   -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				acc[lane] = std::max(acc[lane], std::fabs(x[i + lane] - y[i + lane]));
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane)
+			acc[lane] = std::max(acc[lane], std::fabs(x[i] - y[i]));
+		return horizontal_max(acc);
+	}
+
+	// Integer kernels for int8 magnitudes. Products are summed into 32-bit accumulators over runs
+	// short enough that they cannot overflow, and the runs into 64 bits. Widening multiply-adds of
+	// this shape are what compilers turn into pmaddwd or, with AVX-VNNI, vpdpbusd.
+	inline constexpr std::size_t int8_run = std::size_t{1} << 15;
+
+	inline auto dot(std::int8_t const* x, std::int8_t const* y, std::size_t n) noexcept
+	   -> std::int64_t {
+		auto total = std::int64_t{0};
+		for (auto first = std::size_t{0}; first < n; first += int8_run) {
+			auto const last = std::min(n, first + int8_run);
+			auto acc = std::int32_t{0};
+			for (auto i = first; i < last; ++i)
+				acc += std::int32_t{x[i]} * std::int32_t{y[i]};
+			total += acc;
+		}
+		return total;
+	}
+
+	inline auto sum(std::int8_t const* x, std::size_t n) noexcept -> std::int64_t {
+		auto total = std::int64_t{0};
+		for (auto first = std::size_t{0}; first < n; first += int8_run) {
+			auto const last = std::min(n, first + int8_run);
+			auto acc = std::int32_t{0};
+			for (auto i = first; i < last; ++i)
+				acc += std::int32_t{x[i]};
+			total += acc;
+		}
+		return total;
+	}
+
+	// Each squared difference is at most 255^2, so a run of 2^15 still fits in 32 bits unsigned
+	inline auto squared_distance(std::int8_t const* x, std::int8_t const* y, std::size_t n) noexcept
+	   -> std::int64_t {
+		auto total = std::int64_t{0};
+		for (auto first = std::size_t{0}; first < n; first += int8_run) {
+			auto const last = std::min(n, first + int8_run);
+			auto acc = std::uint32_t{0};
+			for (auto i = first; i < last; ++i) {
+				auto const d = std::int32_t{x[i]} - std::int32_t{y[i]};
+				acc += static_cast<std::uint32_t>(d * d);
+			}
+			total += acc;
+		}
+		return total;
+	}
+
+	// Dot product of doubles with int8 magnitudes, in the same lane layout as dot()
+	inline auto dot(double const* x, std::int8_t const* y, std::size_t n) noexcept -> double {
+		double acc[block_width] = {};
+		auto i = std::size_t{0};
+		for (; i + block_width <= n; i += block_width)
+			for (auto lane = std::size_t{0}; lane < block_width; ++lane)
+				acc[lane] += x[i + lane] * static_cast<double>(y[i + lane]);
+		for (auto lane = std::size_t{0}; i < n; ++i, ++lane)
+			acc[lane] += x[i] * static_cast<double>(y[i]);
+		return horizontal_sum(acc);
+	}
+
+	// 64-bit hash over the element bit patterns, using four independent xxHash64-style lanes. Signed
+	// zeros and NaNs are canonicalised first so that the hash agrees with equal().
+	inline auto hash(double const* x, std::size_t n) noexcept -> std::uint64_t {
+		constexpr auto prime1 = std::uint64_t{0x9E3779B185EBCA87};
+		constexpr auto prime2 = std::uint64_t{0xC2B2AE3D27D4EB4F};
+		constexpr auto prime3 = std::uint64_t{0x165667B19E3779F9};
+		constexpr auto prime4 = std::uint64_t{0x85EBCA77C2B2AE63};
+		constexpr auto lanes = std::size_t{4};
+
+		auto const word = [](double value) {
+			// -0.0 + 0.0 == +0.0 under round-to-nearest
+			value = std::isnan(value) ? std::numeric_limits<double>::quiet_NaN() : value + 0.0;
+			return std::bit_cast<std::uint64_t>(value);
+		};
+		auto const round = [](std::uint64_t acc, std::uint64_t input) {
+			return std::rotl(acc + input * prime2, 31) * prime1;
+		};
+
+		std::uint64_t acc[lanes] = {prime1 + prime2, prime2, 0, 0 - prime1};
+		auto i = std::size_t{0};
+		for (; i + lanes <= n; i += lanes)
+			for (auto lane = std::size_t{0}; lane < lanes; ++lane)
+				acc[lane] = round(acc[lane], word(x[i + lane]));
+
+		auto result = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12)
+		              + std::rotl(acc[3], 18);
+		for (auto lane = std::size_t{0}; lane < lanes; ++lane)
+			result = (result ^ round(0, acc[lane])) * prime1 + prime4;
+		result += static_cast<std::uint64_t>(n) * sizeof(double);
+		for (; i < n; ++i)
+			result = std::rotl(result ^ round(0, word(x[i])), 27) * prime1 + prime4;
+
+		result ^= result >> 33;
+		result *= prime2;
+		result ^= result >> 29;
+		result *= prime3;
+		result ^= result >> 32;
+		return result;
+	}
+} // namespace comp6771::kernels
+
+#endif // COMP6771_KERNELS_HPP
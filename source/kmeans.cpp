@@ -0,0 +1,350 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/kmeans.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// Centroid sums are accumulated per chunk of at least this many vectors, with at most
+		// max_chunks chunks, so the merge order depends only on the data size
+		constexpr auto chunk_size = std::size_t{1024};
+		constexpr auto max_chunks = std::size_t{64};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		void check_cluster_count(std::size_t k, std::size_t n) {
+			if (k == 0 or k > n) {
+				const std::string message = "Number of clusters(" + std::to_string(k)
+				                            + ") must be between 1 and the number of vectors("
+				                            + std::to_string(n) + ")";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		void check_same_dimensions(std::span<euclidean_vector const> vectors, int dimensions) {
+			for (auto const& v : vectors)
+				check_same_dimensions(dimensions, v.dimensions());
+		}
+
+		// Fills the norm caches of `vectors` (each touched by one thread only) and returns a copy
+		// that the assignment loops can read without touching the vectors
+		auto norms_of(std::span<euclidean_vector const> vectors, thread_pool& pool)
+		   -> std::vector<double> {
+			auto norms = std::vector<double>(vectors.size());
+			pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					norms[i] = euclidean_norm(vectors[i]);
+			});
+			return norms;
+		}
+
+		struct nearest {
+			std::size_t index = 0;
+			double distance = std::numeric_limits<double>::infinity();
+			// Lower bound on the distance to every other centroid
+			double second = std::numeric_limits<double>::infinity();
+		};
+
+		// Scans every centroid, skipping those that | ||x|| - ||c|| | (a lower bound on ||x - c||)
+		// shows cannot be nearest or second nearest
+		auto scan(euclidean_vector const& x,
+		          double x_norm,
+		          std::span<euclidean_vector const> centroids,
+		          std::vector<double> const& centroid_norms) noexcept -> nearest {
+			auto result = nearest();
+			for (auto j = std::size_t{0}; j < centroids.size(); ++j) {
+				if (std::abs(x_norm - centroid_norms[j]) >= result.second)
+					continue;
+
+				auto const d = std::sqrt(squared_distance(x, centroids[j]));
+				if (d < result.distance) {
+					result.second = result.distance;
+					result.distance = d;
+					result.index = j;
+				}
+				else if (d < result.second) {
+					result.second = d;
+				}
+			}
+			return result;
+		}
+
+		auto centroid_norms_of(std::span<euclidean_vector const> centroids) -> std::vector<double> {
+			auto norms = std::vector<double>();
+			norms.reserve(centroids.size());
+			for (auto const& c : centroids)
+				norms.push_back(euclidean_norm(c));
+			return norms;
+		}
+
+		// Means of the vectors assigned to each cluster, or nothing for an empty cluster
+		auto cluster_means(std::span<euclidean_vector const> data,
+		                   std::vector<std::size_t> const& assignments,
+		                   std::size_t k,
+		                   thread_pool& pool) -> std::vector<std::vector<double>> {
+			auto const n = data.size();
+			auto const d = static_cast<std::size_t>(data.front().dimensions());
+			auto const chunks = std::clamp(n / chunk_size, std::size_t{1}, max_chunks);
+
+			auto sums = std::vector<std::vector<double>>(chunks);
+			auto counts = std::vector<std::vector<std::size_t>>(chunks);
+			pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+				for (auto chunk = first; chunk < last; ++chunk) {
+					auto& sum = sums[chunk];
+					auto& count = counts[chunk];
+					sum.assign(k * d, 0.0);
+					count.assign(k, 0);
+					for (auto i = chunk * n / chunks; i < (chunk + 1) * n / chunks; ++i) {
+						auto const cluster = assignments[i];
+						auto const* const x = data[i].data();
+						auto* const out = sum.data() + cluster * d;
+						for (auto t = std::size_t{0}; t < d; ++t)
+							out[t] += x[t];
+						++count[cluster];
+					}
+				}
+			});
+
+			for (auto chunk = std::size_t{1}; chunk < chunks; ++chunk) {
+				for (auto t = std::size_t{0}; t < k * d; ++t)
+					sums[0][t] += sums[chunk][t];
+				for (auto j = std::size_t{0}; j < k; ++j)
+					counts[0][j] += counts[chunk][j];
+			}
+
+			auto means = std::vector<std::vector<double>>(k);
+			for (auto j = std::size_t{0}; j < k; ++j) {
+				if (counts[0][j] == 0)
+					continue;
+				auto const* const sum = sums[0].data() + j * d;
+				auto const count = static_cast<double>(counts[0][j]);
+				means[j].assign(sum, sum + d);
+				for (auto& value : means[j])
+					value /= count;
+			}
+			return means;
+		}
+	} // namespace
+
+	auto kmeans_plus_plus(std::span<euclidean_vector const> data,
+	                      std::size_t k,
+	                      std::uint64_t seed,
+	                      thread_pool& pool) -> std::vector<euclidean_vector> {
+		check_cluster_count(k, data.size());
+		check_same_dimensions(data, data.front().dimensions());
+
+		auto random = std::mt19937_64(seed);
+		auto const n = data.size();
+		auto centroids = std::vector<euclidean_vector>();
+		centroids.reserve(k);
+		centroids.push_back(data[std::uniform_int_distribution<std::size_t>(0, n - 1)(random)]);
+
+		// Squared distance from each vector to its nearest centroid so far
+		auto closest = std::vector<double>(n, std::numeric_limits<double>::infinity());
+		while (true) {
+			auto const& latest = centroids.back();
+			pool.parallel_for(n, [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					closest[i] = std::min(closest[i], squared_distance(data[i], latest));
+			});
+			if (centroids.size() == k)
+				return centroids;
+
+			auto total = 0.0;
+			for (auto const d2 : closest)
+				total += d2;
+
+			auto pick = n;
+			if (total > 0) {
+				// Rounding can leave target just past the final running sum, so fall back on the
+				// last vector that could have been picked
+				auto const target = std::uniform_real_distribution<double>(0.0, total)(random);
+				auto running = 0.0;
+				for (auto i = std::size_t{0}; i < n and (pick == n or running <= target); ++i) {
+					if (closest[i] == 0)
+						continue;
+					running += closest[i];
+					pick = i;
+				}
+			}
+			else {
+				// Every vector already coincides with a centroid
+				pick = std::uniform_int_distribution<std::size_t>(0, n - 1)(random);
+			}
+			centroids.push_back(data[pick]);
+		}
+	}
+
+	auto kmeans(std::span<euclidean_vector const> data,
+	            std::size_t k,
+	            kmeans_options const& options,
+	            thread_pool& pool) -> kmeans_result {
+		auto result = kmeans_result();
+		result.centroids = kmeans_plus_plus(data, k, options.seed, pool);
+
+		auto const n = data.size();
+		auto const norms = norms_of(data, pool);
+		auto& centroids = result.centroids;
+		auto& assignments = result.assignments;
+		assignments.resize(n);
+
+		// Hamerly's bounds: upper[i] >= distance to the assigned centroid, and lower[i] <= distance
+		// to every other centroid
+		auto upper = std::vector<double>(n);
+		auto lower = std::vector<double>(n);
+		auto centroid_norms = centroid_norms_of(centroids);
+		pool.parallel_for(n, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i) {
+				auto const found = scan(data[i], norms[i], centroids, centroid_norms);
+				assignments[i] = found.index;
+				upper[i] = found.distance;
+				lower[i] = found.second;
+			}
+		});
+
+		auto movement = std::vector<double>(k);
+		auto half_gap = std::vector<double>(k);
+		while (result.iterations < options.max_iterations) {
+			++result.iterations;
+
+			auto means = cluster_means(data, assignments, k, pool);
+			auto largest = std::size_t{0};
+			for (auto j = std::size_t{0}; j < k; ++j) {
+				movement[j] = 0.0;
+				if (means[j].empty())
+					continue;
+				auto moved = euclidean_vector::from(std::move(means[j]));
+				movement[j] = distance(moved, centroids[j]);
+				centroids[j] = std::move(moved);
+				if (movement[j] > movement[largest])
+					largest = j;
+			}
+
+			auto second_largest = 0.0;
+			for (auto j = std::size_t{0}; j < k; ++j)
+				if (j != largest)
+					second_largest = std::max(second_largest, movement[j]);
+			pool.parallel_for(n, [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					upper[i] += movement[assignments[i]];
+					lower[i] -= assignments[i] == largest ? second_largest : movement[largest];
+				}
+			});
+
+			if (movement[largest] <= options.tolerance) {
+				result.converged = true;
+				break;
+			}
+
+			// Half the distance to the nearest other centroid: a vector closer than this to its own
+			// centroid cannot be closer to any other
+			centroid_norms = centroid_norms_of(centroids);
+			pool.parallel_for(k, [&](std::size_t first, std::size_t last) {
+				for (auto j = first; j < last; ++j) {
+					half_gap[j] = std::numeric_limits<double>::infinity();
+					for (auto other = std::size_t{0}; other < k; ++other) {
+						if (other != j) {
+							auto const gap = std::sqrt(squared_distance(centroids[j], centroids[other]));
+							half_gap[j] = std::min(half_gap[j], gap / 2);
+						}
+					}
+				}
+			});
+
+			auto changed = std::atomic<std::size_t>(0);
+			pool.parallel_for(n, [&](std::size_t first, std::size_t last) {
+				auto local_changes = std::size_t{0};
+				for (auto i = first; i < last; ++i) {
+					auto const bound = std::max(half_gap[assignments[i]], lower[i]);
+					if (upper[i] <= bound)
+						continue;
+
+					upper[i] = std::sqrt(squared_distance(data[i], centroids[assignments[i]]));
+					if (upper[i] <= bound)
+						continue;
+
+					auto const found = scan(data[i], norms[i], centroids, centroid_norms);
+					local_changes += found.index != assignments[i];
+					assignments[i] = found.index;
+					upper[i] = found.distance;
+					lower[i] = found.second;
+				}
+				changed.fetch_add(local_changes, std::memory_order_relaxed);
+			});
+
+			if (changed.load() == 0) {
+				result.converged = true;
+				break;
+			}
+		}
+
+		auto errors = std::vector<double>(n);
+		pool.parallel_for(n, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				errors[i] = squared_distance(data[i], centroids[assignments[i]]);
+		});
+		for (auto const error : errors)
+			result.inertia += error;
+		return result;
+	}
+
+	auto nearest_centroid(std::span<euclidean_vector const> centroids, euclidean_vector const& x)
+	   -> std::size_t {
+		if (centroids.empty())
+			throw std::invalid_argument("There are no centroids to compare against");
+		check_same_dimensions(centroids, x.dimensions());
+
+		auto best = std::size_t{0};
+		auto best_distance = squared_distance(x, centroids[0]);
+		for (auto j = std::size_t{1}; j < centroids.size(); ++j) {
+			auto const d2 = squared_distance(x, centroids[j]);
+			if (d2 < best_distance) {
+				best = j;
+				best_distance = d2;
+			}
+		}
+		return best;
+	}
+
+	minibatch_kmeans::minibatch_kmeans(std::size_t k, std::uint64_t seed)
+	: k_(k)
+	, seed_(seed) {}
+
+	void minibatch_kmeans::partial_fit(std::span<euclidean_vector const> batch, thread_pool& pool) {
+		if (centroids_.empty()) {
+			centroids_ = kmeans_plus_plus(batch, k_, seed_, pool);
+			counts_.assign(k_, 0);
+		}
+		check_same_dimensions(batch, centroids_.front().dimensions());
+
+		auto const norms = norms_of(batch, pool);
+		auto const centroid_norms = centroid_norms_of(centroids_);
+		auto nearest = std::vector<std::size_t>(batch.size());
+		pool.parallel_for(batch.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				nearest[i] = scan(batch[i], norms[i], centroids_, centroid_norms).index;
+		});
+
+		// Updates are applied in batch order, so the result does not depend on the pool
+		for (auto i = std::size_t{0}; i < batch.size(); ++i) {
+			auto const j = nearest[i];
+			++counts_[j];
+			auto const rate = 1.0 / static_cast<double>(counts_[j]);
+			axpby(rate, batch[i], 1.0 - rate, centroids_[j]);
+		}
+	}
+} // namespace comp6771
@@ -0,0 +1,281 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/krylov.hpp>
+#include <comp6771/orthonormalize.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		// Copy assignment builds a new vector, so copies between workspace vectors go through the
+		// existing storage instead
+		void assign(euclidean_vector& y, euclidean_vector const& x) {
+			std::copy_n(x.data(), x.dimensions(), y.mutable_data());
+		}
+
+		void apply(linear_operator const& a, euclidean_vector const& x, euclidean_vector& y) {
+			a(x, y);
+			check_same_dimensions(x.dimensions(), y.dimensions());
+		}
+
+		// r = b - A x, returning ||r||
+		auto residual(linear_operator const& a,
+		              euclidean_vector const& b,
+		              euclidean_vector const& x,
+		              euclidean_vector& r) -> double {
+			apply(a, x, r);
+			axpby(1.0, b, -1.0, r);
+			return euclidean_norm(r);
+		}
+
+		// Checks the arguments, and handles b = 0. Returns the residual norm to stop at.
+		auto start(euclidean_vector const& b, euclidean_vector& x, solver_options const& options)
+		   -> double {
+			check_same_dimensions(b.dimensions(), x.dimensions());
+			if (not(options.tolerance >= 0.0))
+				throw std::invalid_argument("Solver tolerance must not be negative");
+
+			auto const b_norm = euclidean_norm(b);
+			if (b_norm == 0.0)
+				std::fill_n(x.mutable_data(), x.dimensions(), 0.0);
+			return options.tolerance * b_norm;
+		}
+	} // namespace
+
+	auto krylov_workspace::vectors(std::size_t count, int dimensions)
+	   -> std::span<euclidean_vector> {
+		if (vectors_.size() < count
+		    or (not vectors_.empty() and vectors_.front().dimensions() != dimensions)) {
+			vectors_.assign(count, euclidean_vector(dimensions));
+		}
+		return std::span(vectors_).first(count);
+	}
+
+	auto krylov_workspace::scalars(std::size_t count) -> std::span<double> {
+		if (scalars_.size() < count)
+			scalars_.resize(count);
+		auto const result = std::span(scalars_).first(count);
+		std::ranges::fill(result, 0.0);
+		return result;
+	}
+
+	auto conjugate_gradient(linear_operator const& a,
+	                        euclidean_vector const& b,
+	                        euclidean_vector& x,
+	                        solver_options const& options) -> solver_result {
+		auto workspace = krylov_workspace();
+		return conjugate_gradient(a, b, x, options, workspace);
+	}
+
+	auto conjugate_gradient(linear_operator const& a,
+	                        euclidean_vector const& b,
+	                        euclidean_vector& x,
+	                        solver_options const& options,
+	                        krylov_workspace& workspace) -> solver_result {
+		auto const target = start(b, x, options);
+		auto const vectors = workspace.vectors(3, b.dimensions());
+		auto& r = vectors[0];
+		auto& p = vectors[1];
+		auto& q = vectors[2];
+
+		auto result = solver_result{0, residual(a, b, x, r), false};
+		auto squared_residual = result.residual_norm * result.residual_norm;
+		assign(p, r);
+		while (result.residual_norm > target and result.iterations < options.max_iterations) {
+			apply(a, p, q);
+			++result.iterations;
+			auto const curvature = dot(p, q);
+			if (not(curvature > 0.0))
+				return result;
+
+			auto const alpha = squared_residual / curvature;
+			axpy(alpha, p, x);
+			// axpy caches the squared norm of its result, so the residual norm is free
+			axpy(-alpha, q, r);
+			result.residual_norm = euclidean_norm(r);
+			auto const next_squared_residual = result.residual_norm * result.residual_norm;
+
+			axpby(1.0, r, next_squared_residual / squared_residual, p);
+			squared_residual = next_squared_residual;
+		}
+		result.converged = result.residual_norm <= target;
+		return result;
+	}
+
+	auto bicgstab(linear_operator const& a,
+	              euclidean_vector const& b,
+	              euclidean_vector& x,
+	              solver_options const& options) -> solver_result {
+		auto workspace = krylov_workspace();
+		return bicgstab(a, b, x, options, workspace);
+	}
+
+	auto bicgstab(linear_operator const& a,
+	              euclidean_vector const& b,
+	              euclidean_vector& x,
+	              solver_options const& options,
+	              krylov_workspace& workspace) -> solver_result {
+		auto const target = start(b, x, options);
+		auto const vectors = workspace.vectors(5, b.dimensions());
+		auto& r = vectors[0];
+		auto& shadow = vectors[1];
+		auto& p = vectors[2];
+		auto& v = vectors[3];
+		auto& t = vectors[4];
+
+		auto result = solver_result{0, residual(a, b, x, r), false};
+		assign(shadow, r);
+		auto rho = 1.0;
+		auto alpha = 1.0;
+		auto omega = 1.0;
+		auto first = true;
+		while (result.residual_norm > target and result.iterations < options.max_iterations) {
+			auto const next_rho = dot(shadow, r);
+			if (next_rho == 0.0)
+				return result;
+
+			// p = r + beta (p - omega v)
+			if (first) {
+				assign(p, r);
+				first = false;
+			}
+			else {
+				axpy(-omega, v, p);
+				axpby(1.0, r, (next_rho / rho) * (alpha / omega), p);
+			}
+			rho = next_rho;
+
+			apply(a, p, v);
+			++result.iterations;
+			auto const shadow_v = dot(shadow, v);
+			if (shadow_v == 0.0)
+				return result;
+			alpha = rho / shadow_v;
+
+			// r becomes s = r - alpha v, which may already be small enough
+			axpy(-alpha, v, r);
+			axpy(alpha, p, x);
+			result.residual_norm = euclidean_norm(r);
+			if (result.residual_norm <= target or result.iterations == options.max_iterations)
+				break;
+
+			apply(a, r, t);
+			++result.iterations;
+			auto const t_squared_norm = dot(t, t);
+			if (t_squared_norm == 0.0)
+				return result;
+			omega = dot(t, r) / t_squared_norm;
+
+			axpy(omega, r, x);
+			axpy(-omega, t, r);
+			result.residual_norm = euclidean_norm(r);
+			if (omega == 0.0)
+				return result;
+		}
+		result.converged = result.residual_norm <= target;
+		return result;
+	}
+
+	auto gmres(linear_operator const& a,
+	           euclidean_vector const& b,
+	           euclidean_vector& x,
+	           solver_options const& options) -> solver_result {
+		auto workspace = krylov_workspace();
+		return gmres(a, b, x, options, workspace);
+	}
+
+	auto gmres(linear_operator const& a,
+	           euclidean_vector const& b,
+	           euclidean_vector& x,
+	           solver_options const& options,
+	           krylov_workspace& workspace) -> solver_result {
+		if (options.restart == 0)
+			throw std::invalid_argument("GMRES needs a restart length of at least 1");
+		auto const target = start(b, x, options);
+		auto const m = options.restart;
+
+		// The Krylov basis, then one vector for the correction to x
+		auto const vectors = workspace.vectors(m + 2, b.dimensions());
+		auto const basis = vectors.first(m + 1);
+		auto& correction = vectors[m + 1];
+		// Column j of the Hessenberg matrix holds its first j + 2 entries, stored m + 1 apart
+		auto const scalars = workspace.scalars((m + 1) * m + 4 * m + 1);
+		auto const hessenberg = scalars.first((m + 1) * m);
+		auto const cosines = scalars.subspan((m + 1) * m, m);
+		auto const sines = scalars.subspan((m + 1) * m + m, m);
+		auto const y = scalars.subspan((m + 1) * m + 2 * m, m);
+		auto const g = scalars.subspan((m + 1) * m + 3 * m, m + 1);
+
+		auto result = solver_result{0, residual(a, b, x, basis[0]), false};
+		while (result.residual_norm > target and result.iterations < options.max_iterations) {
+			basis[0] /= result.residual_norm;
+			std::ranges::fill(g, 0.0);
+			g[0] = result.residual_norm;
+
+			auto steps = std::size_t{0};
+			auto happy_breakdown = false;
+			while (steps < m and result.iterations < options.max_iterations) {
+				auto const j = steps;
+				auto const column = hessenberg.subspan(j * (m + 1), j + 2);
+				apply(a, basis[j], basis[j + 1]);
+				++result.iterations;
+				++steps;
+
+				column[j + 1] =
+				   orthogonalize(basis.first(j + 1), basis[j + 1], column.first(j + 1));
+				happy_breakdown = column[j + 1] == 0.0;
+				if (not happy_breakdown)
+					basis[j + 1] /= column[j + 1];
+
+				for (auto i = std::size_t{0}; i < j; ++i) {
+					auto const upper = cosines[i] * column[i] + sines[i] * column[i + 1];
+					column[i + 1] = -sines[i] * column[i] + cosines[i] * column[i + 1];
+					column[i] = upper;
+				}
+				auto const length = std::hypot(column[j], column[j + 1]);
+				cosines[j] = length == 0.0 ? 1.0 : column[j] / length;
+				sines[j] = length == 0.0 ? 0.0 : column[j + 1] / length;
+				column[j] = length;
+				column[j + 1] = 0.0;
+				g[j + 1] = -sines[j] * g[j];
+				g[j] *= cosines[j];
+
+				result.residual_norm = std::abs(g[j + 1]);
+				if (result.residual_norm <= target or happy_breakdown)
+					break;
+			}
+
+			// Back substitution for the triangular least-squares problem
+			for (auto i = steps; i > 0; --i) {
+				auto const row = i - 1;
+				auto sum = g[row];
+				for (auto col = i; col < steps; ++col)
+					sum -= hessenberg[col * (m + 1) + row] * y[col];
+				auto const diagonal = hessenberg[row * (m + 1) + row];
+				if (diagonal == 0.0)
+					return result;
+				y[row] = sum / diagonal;
+			}
+			lincomb(y.first(steps), basis.first(steps), correction);
+			x += correction;
+
+			if (result.residual_norm <= target or result.iterations >= options.max_iterations)
+				break;
+			result.residual_norm = residual(a, b, x, basis[0]);
+		}
+		result.converged = result.residual_norm <= target;
+		return result;
+	}
+} // namespace comp6771
@@ -0,0 +1,340 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/lsh_index.hpp>
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace comp6771 {
+	namespace {
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+			return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+		}
+
+		auto mix(std::uint64_t x) noexcept -> std::uint64_t {
+			x += 0x9E3779B97F4A7C15;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+			return x ^ (x >> 31);
+		}
+
+		// One way to move the query across a bucket boundary along a single projection, scored by
+		// the squared distance to that boundary
+		struct perturbation {
+			std::size_t coordinate;
+			std::int64_t delta;
+			double score;
+		};
+
+		// A set of perturbations, as indices into the list sorted by score
+		struct perturbation_set {
+			std::vector<std::size_t> members;
+			double score;
+
+			friend auto operator>(perturbation_set const& a, perturbation_set const& b) noexcept
+			   -> bool {
+				return a.score > b.score;
+			}
+		};
+
+		// Up to `count` sets of perturbations in increasing order of total score, by the shift and
+		// expand construction of Lv et al. Sets that move one coordinate twice are skipped.
+		auto best_perturbation_sets(std::vector<perturbation> const& sorted, std::size_t count)
+		   -> std::vector<std::vector<std::size_t>> {
+			auto result = std::vector<std::vector<std::size_t>>();
+			if (sorted.empty() or count == 0)
+				return result;
+
+			auto heap = std::priority_queue<perturbation_set,
+			                                std::vector<perturbation_set>,
+			                                std::greater<>>();
+			heap.push({{0}, sorted[0].score});
+			// Invalid sets are rare, but this stops a pathological input from spinning
+			for (auto popped = std::size_t{0}; not heap.empty() and result.size() < count
+			                                   and popped < 16 * count + 64;
+			     ++popped) {
+				auto set = heap.top();
+				heap.pop();
+
+				auto const last = set.members.back();
+				if (last + 1 < sorted.size()) {
+					auto shifted = set;
+					shifted.members.back() = last + 1;
+					shifted.score += sorted[last + 1].score - sorted[last].score;
+					heap.push(std::move(shifted));
+
+					auto expanded = set;
+					expanded.members.push_back(last + 1);
+					expanded.score += sorted[last + 1].score;
+					heap.push(std::move(expanded));
+				}
+
+				auto const valid = std::ranges::all_of(set.members, [&](std::size_t i) {
+					return std::ranges::count_if(set.members, [&](std::size_t j) {
+						       return sorted[j].coordinate == sorted[i].coordinate;
+					       })
+					       == 1;
+				});
+				if (valid)
+					result.push_back(std::move(set.members));
+			}
+			return result;
+		}
+	} // namespace
+
+	lsh_index::lsh_index(int dimensions, lsh_family family, lsh_parameters const& parameters)
+	: dimensions_(dimensions)
+	, family_(family)
+	, parameters_(parameters) {
+		if (parameters_.tables == 0)
+			throw std::invalid_argument("lsh_index needs at least one table");
+		if (parameters_.hash_bits == 0 or parameters_.hash_bits > 64)
+			throw std::invalid_argument("Hash bits must be between 1 and 64");
+		if (not(parameters_.bucket_width > 0))
+			throw std::invalid_argument("Bucket width must be positive");
+
+		auto const rows = static_cast<int>(parameters_.tables * parameters_.hash_bits);
+		auto random = std::mt19937_64(parameters_.seed);
+		auto gaussian = std::normal_distribution<double>(0.0, 1.0);
+		projections_ = dense_matrix(rows, dimensions_);
+		for (auto r = 0; r < rows; ++r)
+			for (auto c = 0; c < dimensions_; ++c)
+				projections_(r, c) = gaussian(random);
+
+		auto uniform = std::uniform_real_distribution<double>(0.0, parameters_.bucket_width);
+		shifts_.resize(static_cast<std::size_t>(rows));
+		for (auto& shift : shifts_)
+			shift = uniform(random);
+		tables_.resize(parameters_.tables);
+	}
+
+	auto lsh_index::table_key(double const* projected, std::size_t table) const noexcept
+	   -> std::uint64_t {
+		auto const bits = parameters_.hash_bits;
+		auto key = std::uint64_t{0};
+		for (auto i = table * bits; i < (table + 1) * bits; ++i) {
+			if (family_ == lsh_family::random_hyperplane) {
+				key = (key << 1) | static_cast<std::uint64_t>(projected[i] >= 0);
+			}
+			else {
+				auto const slot = std::floor((projected[i] + shifts_[i]) / parameters_.bucket_width);
+				key = mix(key ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(slot)));
+			}
+		}
+		return key;
+	}
+
+	auto lsh_index::probe_keys(double const* projected, std::size_t table, std::size_t probes) const
+	   -> std::vector<std::uint64_t> {
+		auto keys = std::vector<std::uint64_t>{table_key(projected, table)};
+		if (probes == 0)
+			return keys;
+
+		auto const bits = parameters_.hash_bits;
+		auto const first = table * bits;
+		auto const width = parameters_.bucket_width;
+		auto slots = std::vector<std::int64_t>(bits);
+		auto moves = std::vector<perturbation>();
+		for (auto i = std::size_t{0}; i < bits; ++i) {
+			auto const p = projected[first + i];
+			if (family_ == lsh_family::random_hyperplane) {
+				slots[i] = p >= 0;
+				moves.push_back({i, p >= 0 ? -1 : 1, p * p});
+			}
+			else {
+				auto const position = (p + shifts_[first + i]) / width;
+				slots[i] = static_cast<std::int64_t>(std::floor(position));
+				auto const below = position - std::floor(position);
+				moves.push_back({i, -1, below * below});
+				moves.push_back({i, 1, (1 - below) * (1 - below)});
+			}
+		}
+		std::ranges::sort(moves, {}, &perturbation::score);
+
+		for (auto const& set : best_perturbation_sets(moves, probes)) {
+			auto moved = slots;
+			for (auto const m : set)
+				moved[moves[m].coordinate] += moves[m].delta;
+
+			auto key = std::uint64_t{0};
+			for (auto const slot : moved)
+				key = family_ == lsh_family::random_hyperplane
+				         ? (key << 1) | static_cast<std::uint64_t>(slot)
+				         : mix(key ^ static_cast<std::uint64_t>(slot));
+			keys.push_back(key);
+		}
+		return keys;
+	}
+
+	auto lsh_index::allocate() -> std::size_t {
+		if (not free_.empty()) {
+			auto const id = free_.back();
+			free_.pop_back();
+			return id;
+		}
+
+		auto const id = alive_.size();
+		alive_.push_back(0);
+		arena_.resize(arena_.size() + static_cast<std::size_t>(dimensions_));
+		norms_.push_back(0.0);
+		keys_.resize(keys_.size() + parameters_.tables);
+		return id;
+	}
+
+	// Every vector, stored or queried, is projected by the same gemv, which sums each row the same
+	// way however its rows are split, so a vector hashes to the same keys however it reached the
+	// index
+	void lsh_index::project(euclidean_vector const& v, euclidean_vector& projected) const {
+		gemv(1.0, projections_, v, 0.0, projected);
+	}
+
+	void lsh_index::store(std::size_t id, euclidean_vector const& v, double const* projected) {
+		auto const d = static_cast<std::size_t>(dimensions_);
+		std::copy_n(v.data(), d, arena_.data() + id * d);
+		norms_[id] = euclidean_norm(v);
+		for (auto t = std::size_t{0}; t < parameters_.tables; ++t)
+			keys_[id * parameters_.tables + t] = table_key(projected, t);
+		alive_[id] = 1;
+	}
+
+	void lsh_index::link(std::size_t id) {
+		for (auto t = std::size_t{0}; t < parameters_.tables; ++t)
+			tables_[t][keys_[id * parameters_.tables + t]].push_back(static_cast<std::uint32_t>(id));
+	}
+
+	auto lsh_index::insert(euclidean_vector const& v) -> std::size_t {
+		check_same_dimensions(dimensions_, v.dimensions());
+		auto projected = euclidean_vector(projections_.rows());
+		project(v, projected);
+		auto const id = allocate();
+		store(id, v, projected.data());
+		link(id);
+		return id;
+	}
+
+	auto lsh_index::insert_all(std::span<euclidean_vector const> vectors, thread_pool& pool)
+	   -> std::vector<std::size_t> {
+		for (auto const& v : vectors)
+			check_same_dimensions(dimensions_, v.dimensions());
+		if (vectors.empty())
+			return {};
+
+		auto ids = std::vector<std::size_t>(vectors.size());
+		for (auto& id : ids)
+			id = allocate();
+
+		pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+			auto projected = euclidean_vector(projections_.rows());
+			for (auto i = first; i < last; ++i) {
+				project(vectors[i], projected);
+				store(ids[i], vectors[i], projected.data());
+			}
+		});
+		// Each table is independent, so they are filled side by side
+		pool.parallel_for(parameters_.tables, 1, [&](std::size_t first, std::size_t last) {
+			for (auto t = first; t < last; ++t)
+				for (auto const id : ids)
+					tables_[t][keys_[id * parameters_.tables + t]].push_back(
+					   static_cast<std::uint32_t>(id));
+		});
+		return ids;
+	}
+
+	void lsh_index::remove(std::size_t id) {
+		if (not contains(id))
+			throw std::out_of_range("Id " + std::to_string(id) + " is not in this lsh_index");
+
+		for (auto t = std::size_t{0}; t < parameters_.tables; ++t) {
+			auto const found = tables_[t].find(keys_[id * parameters_.tables + t]);
+			auto& members = found->second;
+			auto const position = std::ranges::find(members, static_cast<std::uint32_t>(id));
+			*position = members.back();
+			members.pop_back();
+			if (members.empty())
+				tables_[t].erase(found);
+		}
+		alive_[id] = 0;
+		free_.push_back(id);
+	}
+
+	auto lsh_index::candidates(euclidean_vector const& query, std::size_t probes) const
+	   -> std::vector<std::size_t> {
+		check_same_dimensions(dimensions_, query.dimensions());
+		auto projected = euclidean_vector(projections_.rows());
+		project(query, projected);
+
+		auto found = std::vector<std::size_t>();
+		for (auto t = std::size_t{0}; t < parameters_.tables; ++t) {
+			for (auto const key : probe_keys(projected.data(), t, probes)) {
+				auto const members = tables_[t].find(key);
+				if (members != tables_[t].end())
+					found.insert(found.end(), members->second.begin(), members->second.end());
+			}
+		}
+		std::ranges::sort(found);
+		found.erase(std::unique(found.begin(), found.end()), found.end());
+		return found;
+	}
+
+	auto lsh_index::distance_to(euclidean_vector const& query, double query_norm, std::size_t id) const
+	   noexcept -> double {
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto const* const stored = arena_.data() + id * d;
+		if (family_ == lsh_family::p_stable)
+			return std::sqrt(kernels::squared_distance(query.data(), stored, d));
+
+		// A zero vector has no direction, so it is treated as orthogonal to everything
+		auto const norms = query_norm * norms_[id];
+		return norms == 0 ? 1.0 : 1.0 - kernels::dot(query.data(), stored, d) / norms;
+	}
+
+	auto lsh_index::query(euclidean_vector const& query, std::size_t k, std::size_t probes) const
+	   -> std::vector<neighbour> {
+		auto const ids = candidates(query, probes);
+		auto const query_norm = euclidean_norm(query);
+		auto found = std::vector<neighbour>();
+		found.reserve(ids.size());
+		for (auto const id : ids)
+			found.push_back({id, distance_to(query, query_norm, id)});
+
+		auto const keep = std::min(k, found.size());
+		std::partial_sort(found.begin(),
+		                  found.begin() + static_cast<std::ptrdiff_t>(keep),
+		                  found.end(),
+		                  closer);
+		found.resize(keep);
+		return found;
+	}
+
+	auto lsh_index::query(std::span<euclidean_vector const> queries,
+	                      std::size_t k,
+	                      std::size_t probes,
+	                      thread_pool& pool) const -> std::vector<std::vector<neighbour>> {
+		for (auto const& q : queries)
+			check_same_dimensions(dimensions_, q.dimensions());
+
+		auto results = std::vector<std::vector<neighbour>>(queries.size());
+		pool.parallel_for(queries.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				results[i] = query(queries[i], k, probes);
+		});
+		return results;
+	}
+} // namespace comp6771
@@ -0,0 +1,123 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/nearest_neighbours.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// The corpus is scanned in chunks of this many vectors, each keeping its own top k
+		constexpr auto scan_chunk = std::size_t{4096};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+			return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+		}
+
+		// Squared for l2, so that the square root is only taken for the k results
+		auto ranking_distance(euclidean_vector const& x, euclidean_vector const& y, search_metric metric)
+		   -> double {
+			return metric == search_metric::l2 ? squared_distance(x, y) : -dot(x, y);
+		}
+
+		// Keeps the k closest of `candidates`, sorted
+		void keep_closest(std::vector<neighbour>& candidates, std::size_t k) {
+			auto const keep = std::min(k, candidates.size());
+			auto const middle = candidates.begin() + static_cast<std::ptrdiff_t>(keep);
+			std::partial_sort(candidates.begin(), middle, candidates.end(), closer);
+			candidates.resize(keep);
+		}
+
+		auto scan(std::span<euclidean_vector const> corpus,
+		          euclidean_vector const& query,
+		          std::size_t k,
+		          search_metric metric,
+		          std::size_t first,
+		          std::size_t last) -> std::vector<neighbour> {
+			auto candidates = std::vector<neighbour>();
+			candidates.reserve(last - first);
+			for (auto i = first; i < last; ++i)
+				candidates.push_back({i, ranking_distance(corpus[i], query, metric)});
+			keep_closest(candidates, k);
+			return candidates;
+		}
+
+		void finish(std::vector<neighbour>& result, search_metric metric) {
+			if (metric == search_metric::l2)
+				for (auto& n : result)
+					n.distance = std::sqrt(n.distance);
+		}
+	} // namespace
+
+	auto brute_force_knn(std::span<euclidean_vector const> corpus,
+	                     euclidean_vector const& query,
+	                     std::size_t k,
+	                     search_metric metric,
+	                     thread_pool& pool) -> std::vector<neighbour> {
+		for (auto const& v : corpus)
+			check_same_dimensions(v.dimensions(), query.dimensions());
+
+		auto const chunks = (corpus.size() + scan_chunk - 1) / scan_chunk;
+		auto partial = std::vector<std::vector<neighbour>>(chunks);
+		pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+			for (auto chunk = first; chunk < last; ++chunk)
+				partial[chunk] = scan(corpus,
+				                      query,
+				                      k,
+				                      metric,
+				                      chunk * scan_chunk,
+				                      std::min(corpus.size(), (chunk + 1) * scan_chunk));
+		});
+
+		auto result = std::vector<neighbour>();
+		for (auto const& candidates : partial)
+			result.insert(result.end(), candidates.begin(), candidates.end());
+		keep_closest(result, k);
+		finish(result, metric);
+		return result;
+	}
+
+	auto brute_force_knn(std::span<euclidean_vector const> corpus,
+	                     std::span<euclidean_vector const> queries,
+	                     std::size_t k,
+	                     search_metric metric,
+	                     thread_pool& pool) -> std::vector<std::vector<neighbour>> {
+		if (not queries.empty())
+			for (auto const& v : corpus)
+				check_same_dimensions(v.dimensions(), queries.front().dimensions());
+		if (not corpus.empty())
+			for (auto const& query : queries)
+				check_same_dimensions(corpus.front().dimensions(), query.dimensions());
+
+		auto results = std::vector<std::vector<neighbour>>(queries.size());
+		pool.parallel_for(queries.size(), [&](std::size_t first, std::size_t last) {
+			for (auto q = first; q < last; ++q) {
+				results[q] = scan(corpus, queries[q], k, metric, 0, corpus.size());
+				finish(results[q], metric);
+			}
+		});
+		return results;
+	}
+
+	auto recall(std::span<neighbour const> approximate, std::span<neighbour const> exact) -> double {
+		if (exact.empty())
+			return 1.0;
+
+		auto found = std::size_t{0};
+		for (auto const& wanted : exact)
+			found += static_cast<std::size_t>(
+			   std::ranges::any_of(approximate, [&](neighbour const& n) { return n.id == wanted.id; }));
+		return static_cast<double>(found) / static_cast<double>(exact.size());
+	}
+} // namespace comp6771
@@ -0,0 +1,332 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/orthonormalize.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "kernels.hpp"
+
+namespace comp6771 {
+	namespace {
+		// A vector is dependent when less than this fraction of its length survives orthogonalising
+		constexpr auto dependence_tolerance = 1e-10;
+		// Householder reflections per panel. The panel stays in cache while it is applied to each
+		// trailing column.
+		constexpr auto panel_width = std::size_t{32};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		void check_same_dimensions(std::span<euclidean_vector const> vectors) {
+			for (auto const& v : vectors)
+				check_same_dimensions(vectors.front().dimensions(), v.dimensions());
+		}
+
+		void zero(euclidean_vector& v) {
+			std::fill_n(v.mutable_data(), v.dimensions(), 0.0);
+		}
+
+		auto lengths(std::span<euclidean_vector const> vectors, thread_pool& pool)
+		   -> std::vector<double> {
+			auto result = std::vector<double>(vectors.size());
+			pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					result[i] = euclidean_norm(vectors[i]);
+			});
+			return result;
+		}
+
+		auto gram_schmidt(std::span<euclidean_vector> vectors, thread_pool& pool) -> dense_matrix {
+			auto const k = vectors.size();
+			auto r = dense_matrix(static_cast<int>(k), static_cast<int>(k));
+			auto const original = lengths(vectors, pool);
+
+			for (auto j = std::size_t{0}; j < k; ++j) {
+				auto const row = static_cast<int>(j);
+				auto& v = vectors[j];
+				// The first pass happened as each earlier vector was normalised
+				for (auto l = std::size_t{0}; l < j; ++l) {
+					if (r(static_cast<int>(l), static_cast<int>(l)) == 0.0)
+						continue;
+					auto const c = dot(vectors[l], v);
+					axpy(-c, vectors[l], v);
+					r(static_cast<int>(l), row) += c;
+				}
+
+				auto const length = euclidean_norm(v);
+				if (length <= dependence_tolerance * original[j]) {
+					zero(v);
+					continue;
+				}
+				v /= length;
+				r(row, row) = length;
+
+				auto const later = vectors.subspan(j + 1);
+				pool.parallel_for(later.size(), [&](std::size_t first, std::size_t last) {
+					for (auto i = first; i < last; ++i) {
+						auto const c = dot(v, later[i]);
+						axpy(-c, v, later[i]);
+						r(row, static_cast<int>(j + 1 + i)) = c;
+					}
+				});
+			}
+			return r;
+		}
+
+		// The columns of a column-major d x k matrix. The reflector for column j is stored below
+		// the diagonal, with its leading 1 implied, as in LAPACK.
+		class householder_factor {
+		public:
+			explicit householder_factor(std::span<euclidean_vector const> vectors)
+			: a_(dense_matrix::from_columns(vectors, matrix_layout::column_major))
+			, d_(static_cast<std::size_t>(a_.rows()))
+			, k_(vectors.size())
+			, p_(std::min(d_, k_))
+			, taus_(p_) {}
+
+			void factor(thread_pool& pool) {
+				for (auto j0 = std::size_t{0}; j0 < p_; j0 += panel_width) {
+					auto const width = std::min(panel_width, p_ - j0);
+					for (auto j = j0; j < j0 + width; ++j) {
+						taus_[j] = make_reflector(j);
+						for (auto c = j + 1; c < j0 + width; ++c)
+							reflect(j, taus_[j], column(c));
+					}
+					panels_.push_back(block_factor(j0, width));
+
+					auto const trailing = j0 + width;
+					pool.parallel_for(k_ - trailing, [&](std::size_t first, std::size_t last) {
+						auto work = std::vector<double>(width);
+						for (auto c = first; c < last; ++c)
+							apply_panel(j0, width, true, column(trailing + c), work);
+					});
+				}
+			}
+
+			auto r() const -> dense_matrix {
+				auto result = dense_matrix(static_cast<int>(k_), static_cast<int>(k_));
+				for (auto c = std::size_t{0}; c < k_; ++c)
+					for (auto row = std::size_t{0}; row <= std::min(c, p_ - 1); ++row)
+						result(static_cast<int>(row), static_cast<int>(c)) =
+						   a_(static_cast<int>(row), static_cast<int>(c));
+				return result;
+			}
+
+			// The first p columns of the product of the reflectors, applied a panel at a time from
+			// the last. Panel j0 only changes rows from j0 on, which are still zero in the columns
+			// before j0.
+			void form_q(thread_pool& pool, dense_matrix& q) {
+				q = dense_matrix(static_cast<int>(d_),
+				                 static_cast<int>(k_),
+				                 matrix_layout::column_major);
+				for (auto c = std::size_t{0}; c < p_; ++c)
+					q(static_cast<int>(c), static_cast<int>(c)) = 1.0;
+
+				for (auto panel = panels_.size(); panel > 0; --panel) {
+					auto const j0 = (panel - 1) * panel_width;
+					auto const width = std::min(panel_width, p_ - j0);
+					pool.parallel_for(p_ - j0, [&](std::size_t first, std::size_t last) {
+						auto work = std::vector<double>(width);
+						for (auto c = first; c < last; ++c)
+							apply_panel(j0, width, false, q.data() + (j0 + c) * d_, work);
+					});
+				}
+			}
+
+		private:
+			dense_matrix a_;
+			std::size_t d_;
+			std::size_t k_;
+			std::size_t p_;
+			std::vector<double> taus_;
+			// The upper triangular T of each panel, row-major, such that the panel's reflectors
+			// multiply out to I - Y T Y^T
+			std::vector<std::vector<double>> panels_;
+
+			auto column(std::size_t c) noexcept -> double* {
+				return a_.data() + c * d_;
+			}
+
+			// Y_j^T x, where Y_j is the reflector of column j
+			auto reflector_dot(std::size_t j, double const* x) noexcept -> double {
+				auto const tail = d_ - j - 1;
+				return x[j] + kernels::dot(column(j) + j + 1, x + j + 1, tail);
+			}
+
+			// x -= alpha Y_j
+			void subtract_reflector(std::size_t j, double alpha, double* x) noexcept {
+				x[j] -= alpha;
+				kernels::axpy(-alpha, column(j) + j + 1, x + j + 1, d_ - j - 1);
+			}
+
+			void reflect(std::size_t j, double tau, double* x) noexcept {
+				subtract_reflector(j, tau * reflector_dot(j, x), x);
+			}
+
+			// Replaces column j from the diagonal down with beta e_1 and the reflector below it,
+			// and returns tau. H = I - tau v v^T maps the column onto beta e_1.
+			auto make_reflector(std::size_t j) noexcept -> double {
+				auto* const x = column(j) + j;
+				auto const tail = d_ - j - 1;
+				auto const alpha = x[0];
+				auto const tail_squared_norm = kernels::squared_norm(x + 1, tail);
+				if (tail_squared_norm == 0.0)
+					return 0.0;
+
+				auto const length = std::sqrt(alpha * alpha + tail_squared_norm);
+				auto const beta = alpha >= 0.0 ? -length : length;
+				kernels::scale(x + 1, tail, 1.0 / (alpha - beta));
+				x[0] = beta;
+				return (beta - alpha) / beta;
+			}
+
+			// LAPACK's dlarft, forward and columnwise
+			auto block_factor(std::size_t j0, std::size_t width) -> std::vector<double> {
+				auto t = std::vector<double>(width * width, 0.0);
+				auto z = std::vector<double>(width);
+				for (auto i = std::size_t{0}; i < width; ++i) {
+					auto const j = j0 + i;
+					// Y_l^T Y_i, where Y_i is zero above row j and 1 on it
+					for (auto l = std::size_t{0}; l < i; ++l) {
+						auto const* const y = column(j0 + l);
+						z[l] = y[j] + kernels::dot(y + j + 1, column(j) + j + 1, d_ - j - 1);
+					}
+					for (auto l = std::size_t{0}; l < i; ++l) {
+						auto sum = 0.0;
+						for (auto m = l; m < i; ++m)
+							sum += t[l * width + m] * z[m];
+						t[l * width + i] = -taus_[j] * sum;
+					}
+					t[i * width + i] = taus_[j];
+				}
+				return t;
+			}
+
+			// x = (I - Y T Y^T) x, or with T^T when `transposed`
+			void apply_panel(std::size_t j0,
+			                 std::size_t width,
+			                 bool transposed,
+			                 double* x,
+			                 std::vector<double>& work) noexcept {
+				auto const& t = panels_[j0 / panel_width];
+				for (auto i = std::size_t{0}; i < width; ++i)
+					work[i] = reflector_dot(j0 + i, x);
+
+				if (transposed) {
+					for (auto i = width; i > 0; --i) {
+						auto sum = 0.0;
+						for (auto l = std::size_t{0}; l < i; ++l)
+							sum += t[l * width + (i - 1)] * work[l];
+						work[i - 1] = sum;
+					}
+				}
+				else {
+					for (auto i = std::size_t{0}; i < width; ++i) {
+						auto sum = 0.0;
+						for (auto l = i; l < width; ++l)
+							sum += t[i * width + l] * work[l];
+						work[i] = sum;
+					}
+				}
+
+				for (auto i = std::size_t{0}; i < width; ++i)
+					subtract_reflector(j0 + i, work[i], x);
+			}
+		};
+
+		auto householder(std::span<euclidean_vector> vectors, thread_pool& pool) -> dense_matrix {
+			auto factor = householder_factor(vectors);
+			factor.factor(pool);
+			auto r = factor.r();
+			auto q = dense_matrix();
+			factor.form_q(pool, q);
+
+			auto const d = vectors.front().dimensions();
+			auto const k = static_cast<int>(vectors.size());
+			for (auto j = 0; j < std::min(d, k); ++j) {
+				if (r(j, j) >= 0.0)
+					continue;
+				for (auto c = j; c < k; ++c)
+					r(j, c) = -r(j, c);
+				for (auto row = 0; row < d; ++row)
+					q(row, j) = -q(row, j);
+			}
+
+			pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+				for (auto c = first; c < last; ++c) {
+					auto const* const column = q.data() + c * static_cast<std::size_t>(d);
+					std::copy_n(column, d, vectors[c].mutable_data());
+				}
+			});
+			return r;
+		}
+	} // namespace
+
+	auto orthogonalize(std::span<euclidean_vector const> basis,
+	                   euclidean_vector& v,
+	                   std::span<double> coefficients) -> double {
+		if (coefficients.size() != basis.size()) {
+			const std::string message = "Number of coefficients(" + std::to_string(coefficients.size())
+			                            + ") and vectors(" + std::to_string(basis.size())
+			                            + ") do not match";
+			throw std::invalid_argument(message);
+		}
+		for (auto const& b : basis)
+			check_same_dimensions(b.dimensions(), v.dimensions());
+
+		std::ranges::fill(coefficients, 0.0);
+		for (auto pass = 0; pass < 2; ++pass)
+			for (auto i = std::size_t{0}; i < basis.size(); ++i) {
+				auto const c = dot(basis[i], v);
+				axpy(-c, basis[i], v);
+				coefficients[i] += c;
+			}
+		return euclidean_norm(v);
+	}
+
+	auto qr(std::span<euclidean_vector> vectors,
+	        orthonormalization_method method,
+	        thread_pool& pool) -> dense_matrix {
+		if (vectors.empty())
+			return dense_matrix(0, 0);
+		check_same_dimensions(vectors);
+		// Zero-dimensional vectors are all zero, so R is too
+		if (vectors.front().dimensions() == 0) {
+			auto const k = static_cast<int>(vectors.size());
+			return dense_matrix(k, k);
+		}
+
+		return method == orthonormalization_method::householder ? householder(vectors, pool)
+		                                                        : gram_schmidt(vectors, pool);
+	}
+
+	auto orthonormalize(std::span<euclidean_vector> vectors,
+	                    orthonormalization_method method,
+	                    thread_pool& pool) -> std::size_t {
+		if (vectors.empty())
+			return 0;
+		check_same_dimensions(vectors);
+
+		auto const original = lengths(vectors, pool);
+		auto const r = qr(vectors, method, pool);
+		auto rank = std::size_t{0};
+		for (auto j = std::size_t{0}; j < vectors.size(); ++j) {
+			auto const diagonal = r(static_cast<int>(j), static_cast<int>(j));
+			if (diagonal > dependence_tolerance * original[j])
+				++rank;
+			else
+				zero(vectors[j]);
+		}
+		return rank;
+	}
+} // namespace comp6771
@@ -0,0 +1,171 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/pairwise.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace comp6771 {
+	namespace {
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		// Norms of every vector, filling their caches. x and y get separate calls, so a vector in
+		// both is never touched by two threads at once.
+		auto norms_of(std::span<euclidean_vector const> vectors, thread_pool& pool)
+		   -> std::vector<double> {
+			auto norms = std::vector<double>(vectors.size());
+			pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i)
+					norms[i] = euclidean_norm(vectors[i]);
+			});
+			return norms;
+		}
+
+		// Turns a tile of inner products into the requested metric, in place
+		void apply_metric(pairwise_metric metric,
+		                  double* values,
+		                  std::size_t rows,
+		                  std::size_t cols,
+		                  double const* x_norms,
+		                  double const* y_norms) noexcept {
+			if (metric == pairwise_metric::inner_product)
+				return;
+
+			for (auto i = std::size_t{0}; i < rows; ++i) {
+				auto* const row = values + i * cols;
+				auto const xx = x_norms[i] * x_norms[i];
+				for (auto j = std::size_t{0}; j < cols; ++j) {
+					switch (metric) {
+					case pairwise_metric::squared_l2:
+						row[j] = std::max(0.0, xx + y_norms[j] * y_norms[j] - 2 * row[j]);
+						break;
+					case pairwise_metric::l2:
+						row[j] = std::sqrt(std::max(0.0, xx + y_norms[j] * y_norms[j] - 2 * row[j]));
+						break;
+					case pairwise_metric::cosine: row[j] /= x_norms[i] * y_norms[j]; break;
+					case pairwise_metric::inner_product: break;
+					}
+				}
+			}
+		}
+
+		// Each thread takes a band of tile_size rows of x, packs it once, and multiplies it against
+		// every tile of y (packed once up front) with the blocked GEMM. With `upper_only` (x and y
+		// the same), tiles wholly below the diagonal are skipped.
+		void for_each_tile(std::span<euclidean_vector const> x,
+		                   std::span<euclidean_vector const> y,
+		                   pairwise_metric metric,
+		                   std::function<void(pairwise_tile const&)> const& on_tile,
+		                   std::size_t tile_size,
+		                   thread_pool& pool,
+		                   bool upper_only) {
+			if (x.empty() or y.empty())
+				return;
+
+			auto const dimensions = x.front().dimensions();
+			for (auto const& v : x)
+				check_same_dimensions(dimensions, v.dimensions());
+			for (auto const& v : y)
+				check_same_dimensions(dimensions, v.dimensions());
+
+			auto const x_norms = norms_of(x, pool);
+			auto const y_norms = norms_of(y, pool);
+			if (metric == pairwise_metric::cosine
+			    and (std::ranges::count(x_norms, 0.0) != 0 or std::ranges::count(y_norms, 0.0) != 0)) {
+				const std::string message = "euclidean_vector with zero euclidean normal does not have a "
+				                            "cosine similarity";
+				throw std::invalid_argument(message);
+			}
+
+			tile_size = std::max(tile_size, std::size_t{1});
+			auto const row_tiles = (x.size() + tile_size - 1) / tile_size;
+			auto const col_tiles = (y.size() + tile_size - 1) / tile_size;
+
+			// Column-major, so each tile is a straight copy of the vectors' storage
+			auto y_tiles = std::vector<dense_matrix>(col_tiles);
+			pool.parallel_for(col_tiles, 1, [&](std::size_t first, std::size_t last) {
+				for (auto tile = first; tile < last; ++tile) {
+					auto const offset = tile * tile_size;
+					y_tiles[tile] =
+					   dense_matrix::from_columns(y.subspan(offset, std::min(tile_size, y.size() - offset)),
+					                              matrix_layout::column_major);
+				}
+			});
+
+			pool.parallel_for(row_tiles, 1, [&](std::size_t first, std::size_t last) {
+				for (auto band = first; band < last; ++band) {
+					auto const row_offset = band * tile_size;
+					auto const rows = std::min(tile_size, x.size() - row_offset);
+					auto const a = dense_matrix::from_rows(x.subspan(row_offset, rows));
+
+					for (auto tile = upper_only ? band : 0; tile < col_tiles; ++tile) {
+						auto const col_offset = tile * tile_size;
+						auto const cols = static_cast<std::size_t>(y_tiles[tile].cols());
+						auto c = gemm(a, y_tiles[tile]);
+						apply_metric(metric,
+						             c.data(),
+						             rows,
+						             cols,
+						             x_norms.data() + row_offset,
+						             y_norms.data() + col_offset);
+						on_tile(pairwise_tile{row_offset, col_offset, rows, cols, c.data()});
+					}
+				}
+			});
+		}
+	} // namespace
+
+	void for_each_pairwise_tile(std::span<euclidean_vector const> x,
+	                            std::span<euclidean_vector const> y,
+	                            pairwise_metric metric,
+	                            std::function<void(pairwise_tile const&)> const& on_tile,
+	                            std::size_t tile_size,
+	                            thread_pool& pool) {
+		for_each_tile(x, y, metric, on_tile, tile_size, pool, false);
+	}
+
+	auto pairwise_matrix(std::span<euclidean_vector const> x,
+	                     std::span<euclidean_vector const> y,
+	                     pairwise_metric metric,
+	                     thread_pool& pool) -> dense_matrix {
+		auto result = dense_matrix(static_cast<int>(x.size()), static_cast<int>(y.size()));
+		auto* const out = result.data();
+		auto const on_tile = [out, stride = y.size()](pairwise_tile const& tile) {
+			for (auto i = std::size_t{0}; i < tile.rows; ++i)
+				std::copy_n(tile.values + i * tile.cols,
+				            tile.cols,
+				            out + (tile.row_offset + i) * stride + tile.col_offset);
+		};
+		for_each_tile(x, y, metric, on_tile, 256, pool, false);
+		return result;
+	}
+
+	auto gram_matrix(std::span<euclidean_vector const> x, thread_pool& pool) -> dense_matrix {
+		auto result = dense_matrix(static_cast<int>(x.size()), static_cast<int>(x.size()));
+		auto* const out = result.data();
+		auto const n = x.size();
+		// The micro-kernel sums x[i].x[j] and x[j].x[i] in the same order, so diagonal tiles are
+		// already symmetric and the rest can be mirrored
+		auto const on_tile = [out, n](pairwise_tile const& tile) {
+			for (auto i = std::size_t{0}; i < tile.rows; ++i)
+				for (auto j = std::size_t{0}; j < tile.cols; ++j) {
+					auto const row = tile.row_offset + i;
+					auto const col = tile.col_offset + j;
+					out[row * n + col] = tile(i, j);
+					out[col * n + row] = tile(i, j);
+				}
+		};
+		for_each_tile(x, x, pairwise_metric::inner_product, on_tile, 256, pool, true);
+		return result;
+	}
+} // namespace comp6771
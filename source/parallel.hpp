@@ -0,0 +1,57 @@
+#ifndef COMP6771_PARALLEL_HPP
+#define COMP6771_PARALLEL_HPP
+
+// Helpers shared by the implementation files that split large kernels across the default thread
+// pool.
+
+#include <comp6771/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace comp6771::parallel {
+	// Calls fn(first, last) over disjoint, contiguous subranges that together cover [0, n), with each
+	// subrange at least `grain` long, on the default thread pool. Runs fn(0, n) on the calling
+	// thread when there is not enough work to split. fn must not throw.
+	template<typename Fn>
+	void for_each_block(std::size_t n, std::size_t grain, Fn fn) {
+		default_thread_pool().parallel_for(n, std::max(grain, std::size_t{1}), fn);
+	}
+
+	// Elements per reduction block. Long reductions are cut into blocks of this many elements and
+	// the block results are combined in block order, whether the blocks ran on one thread or on
+	// several, so a reduction never depends on the thread count.
+	inline constexpr std::size_t reduction_block = std::size_t{1} << 15;
+
+	// Combines fn(first, last) over each reduction block of [0, n), left to right. The blocks are
+	// spread across threads when `parallel` is set. fn must not throw.
+	template<typename T, typename Fn, typename Combine = std::plus<>>
+	auto blocked_reduce(std::size_t n, bool parallel, Fn fn, Combine combine = {}) -> T {
+		auto const blocks = std::max(std::size_t{1}, (n + reduction_block - 1) / reduction_block);
+		auto const reduce_block = [&](std::size_t block) -> T {
+			auto const first = block * reduction_block;
+			return fn(first, std::min(n, first + reduction_block));
+		};
+
+		if (not parallel or blocks == 1) {
+			auto result = reduce_block(0);
+			for (auto block = std::size_t{1}; block < blocks; ++block)
+				result = combine(result, reduce_block(block));
+			return result;
+		}
+
+		auto partials = std::vector<T>(blocks);
+		for_each_block(blocks, 1, [&](std::size_t first, std::size_t last) {
+			for (auto block = first; block < last; ++block)
+				partials[block] = reduce_block(block);
+		});
+		auto result = partials[0];
+		for (auto block = std::size_t{1}; block < blocks; ++block)
+			result = combine(result, partials[block]);
+		return result;
+	}
+} // namespace comp6771::parallel
+
+#endif // COMP6771_PARALLEL_HPP
@@ -0,0 +1,247 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/product_quantizer.hpp>
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// Codes are scanned in chunks of this many, each keeping its own top k
+		constexpr auto scan_chunk = std::size_t{4096};
+		constexpr auto max_centroids = std::size_t{256};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+			return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+		}
+
+		// Keeps the k closest of `candidates`, sorted
+		void keep_closest(std::vector<neighbour>& candidates, std::size_t k) {
+			auto const keep = std::min(k, candidates.size());
+			auto const middle = candidates.begin() + static_cast<std::ptrdiff_t>(keep);
+			std::partial_sort(candidates.begin(), middle, candidates.end(), closer);
+			candidates.resize(keep);
+		}
+	} // namespace
+
+	auto product_quantizer::train(std::span<euclidean_vector const> training,
+	                              std::size_t code_size,
+	                              std::size_t centroids,
+	                              kmeans_options const& options,
+	                              thread_pool& pool) -> product_quantizer {
+		if (training.empty())
+			throw std::invalid_argument("product_quantizer needs at least one training vector");
+		auto const dimensions = training.front().dimensions();
+		for (auto const& v : training)
+			check_same_dimensions(dimensions, v.dimensions());
+		if (code_size == 0 or code_size > static_cast<std::size_t>(dimensions))
+			throw std::invalid_argument("Code size must be between 1 and the number of dimensions");
+		if (centroids == 0 or centroids > max_centroids)
+			throw std::invalid_argument("Number of centroids must be between 1 and 256");
+
+		auto result = product_quantizer();
+		result.dimensions_ = dimensions;
+		result.centroids_ = std::min(centroids, training.size());
+		auto const d = static_cast<std::size_t>(dimensions);
+		for (auto j = std::size_t{0}; j <= code_size; ++j)
+			result.offsets_.push_back(j * d / code_size);
+		result.codebooks_.resize(result.centroids_ * d);
+
+		// Each subspace is clustered on its own, with kmeans spreading the work across the pool
+		auto sub_vectors = std::vector<euclidean_vector>(training.size());
+		for (auto j = std::size_t{0}; j < code_size; ++j) {
+			auto const first = result.offsets_[j];
+			auto const width = result.offsets_[j + 1] - first;
+			pool.parallel_for(training.size(), [&](std::size_t begin, std::size_t end) {
+				for (auto i = begin; i < end; ++i) {
+					auto const* const x = training[i].data() + first;
+					sub_vectors[i] = euclidean_vector(x, x + width);
+				}
+			});
+
+			auto sub_options = options;
+			sub_options.seed = options.seed + j;
+			auto const clusters = kmeans(sub_vectors, result.centroids_, sub_options, pool);
+			auto* const codebook = result.codebooks_.data() + result.centroids_ * first;
+			for (auto c = std::size_t{0}; c < result.centroids_; ++c)
+				std::copy_n(clusters.centroids[c].data(), width, codebook + c * width);
+		}
+		return result;
+	}
+
+	auto product_quantizer::codebook(std::size_t subspace) const noexcept -> double const* {
+		return codebooks_.data() + centroids_ * offsets_[subspace];
+	}
+
+	void product_quantizer::encode(euclidean_vector const& v, std::span<std::uint8_t> code) const {
+		check_same_dimensions(dimensions_, v.dimensions());
+		if (code.size() != code_size()) {
+			throw std::invalid_argument("A code needs " + std::to_string(code_size()) + " bytes, not "
+			                            + std::to_string(code.size()));
+		}
+
+		for (auto j = std::size_t{0}; j < code_size(); ++j) {
+			auto const width = offsets_[j + 1] - offsets_[j];
+			auto const* const x = v.data() + offsets_[j];
+			auto const* const centres = codebook(j);
+			auto nearest = std::size_t{0};
+			auto nearest_distance = std::numeric_limits<double>::infinity();
+			for (auto c = std::size_t{0}; c < centroids_; ++c) {
+				auto const distance = kernels::squared_distance(x, centres + c * width, width);
+				if (distance < nearest_distance) {
+					nearest = c;
+					nearest_distance = distance;
+				}
+			}
+			code[j] = static_cast<std::uint8_t>(nearest);
+		}
+	}
+
+	auto product_quantizer::encode(euclidean_vector const& v) const -> std::vector<std::uint8_t> {
+		auto code = std::vector<std::uint8_t>(code_size());
+		encode(v, code);
+		return code;
+	}
+
+	auto product_quantizer::encode_all(std::span<euclidean_vector const> vectors,
+	                                   thread_pool& pool) const -> std::vector<std::uint8_t> {
+		for (auto const& v : vectors)
+			check_same_dimensions(dimensions_, v.dimensions());
+
+		auto codes = std::vector<std::uint8_t>(vectors.size() * code_size());
+		pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				encode(vectors[i], std::span(codes).subspan(i * code_size(), code_size()));
+		});
+		return codes;
+	}
+
+	auto product_quantizer::decode(std::span<std::uint8_t const> code) const -> euclidean_vector {
+		if (code.size() != code_size()) {
+			throw std::invalid_argument("A code needs " + std::to_string(code_size()) + " bytes, not "
+			                            + std::to_string(code.size()));
+		}
+
+		auto values = std::vector<double>(static_cast<std::size_t>(dimensions_));
+		for (auto j = std::size_t{0}; j < code_size(); ++j) {
+			auto const width = offsets_[j + 1] - offsets_[j];
+			if (code[j] >= centroids_)
+				throw std::out_of_range("Code names centroid " + std::to_string(unsigned{code[j]}) + " of "
+				                        + std::to_string(centroids_));
+			std::copy_n(codebook(j) + code[j] * width, width, values.data() + offsets_[j]);
+		}
+		return euclidean_vector::from(std::move(values));
+	}
+
+	auto product_quantizer::distance_table(euclidean_vector const& query, search_metric metric) const
+	   -> std::vector<double> {
+		check_same_dimensions(dimensions_, query.dimensions());
+		auto table = std::vector<double>(code_size() * centroids_);
+		for (auto j = std::size_t{0}; j < code_size(); ++j) {
+			auto const width = offsets_[j + 1] - offsets_[j];
+			auto const* const x = query.data() + offsets_[j];
+			auto const* const centres = codebook(j);
+			auto* const row = table.data() + j * centroids_;
+			for (auto c = std::size_t{0}; c < centroids_; ++c) {
+				row[c] = metric == search_metric::l2
+				            ? kernels::squared_distance(x, centres + c * width, width)
+				            : -kernels::dot(x, centres + c * width, width);
+			}
+		}
+		return table;
+	}
+
+	// Four independent sums, so that the table lookups are not serialised on one accumulator
+	auto product_quantizer::adc_distance(std::span<double const> table,
+	                                     std::span<std::uint8_t const> code) const noexcept
+	   -> double {
+		auto const m = code_size();
+		double acc[4] = {0.0, 0.0, 0.0, 0.0};
+		auto j = std::size_t{0};
+		for (; j + 4 <= m; j += 4) {
+			acc[0] += table[j * centroids_ + code[j]];
+			acc[1] += table[(j + 1) * centroids_ + code[j + 1]];
+			acc[2] += table[(j + 2) * centroids_ + code[j + 2]];
+			acc[3] += table[(j + 3) * centroids_ + code[j + 3]];
+		}
+		for (; j < m; ++j)
+			acc[0] += table[j * centroids_ + code[j]];
+		return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+	}
+
+	pq_index::pq_index(product_quantizer quantizer, search_metric metric)
+	: quantizer_(std::move(quantizer))
+	, metric_(metric) {}
+
+	auto pq_index::add_all(std::span<euclidean_vector const> vectors, thread_pool& pool)
+	   -> std::size_t {
+		auto const first = size();
+		auto const codes = quantizer_.encode_all(vectors, pool);
+		codes_.insert(codes_.end(), codes.begin(), codes.end());
+		return first;
+	}
+
+	auto pq_index::search(euclidean_vector const& query, std::size_t k, thread_pool& pool) const
+	   -> std::vector<neighbour> {
+		auto const table = quantizer_.distance_table(query, metric_);
+		auto const n = size();
+		auto const chunks = (n + scan_chunk - 1) / scan_chunk;
+		auto partial = std::vector<std::vector<neighbour>>(chunks);
+		pool.parallel_for(chunks, 1, [&](std::size_t first, std::size_t last) {
+			for (auto chunk = first; chunk < last; ++chunk) {
+				auto& candidates = partial[chunk];
+				auto const end = std::min(n, (chunk + 1) * scan_chunk);
+				candidates.reserve(end - chunk * scan_chunk);
+				for (auto id = chunk * scan_chunk; id < end; ++id)
+					candidates.push_back({id, quantizer_.adc_distance(table, code(id))});
+				keep_closest(candidates, k);
+			}
+		});
+
+		auto result = std::vector<neighbour>();
+		for (auto const& candidates : partial)
+			result.insert(result.end(), candidates.begin(), candidates.end());
+		keep_closest(result, k);
+		if (metric_ == search_metric::l2)
+			for (auto& found : result)
+				found.distance = std::sqrt(std::max(found.distance, 0.0));
+		return result;
+	}
+
+	auto pq_index::search(euclidean_vector const& query,
+	                      std::size_t k,
+	                      std::size_t rerank,
+	                      vector_file const& originals,
+	                      thread_pool& pool) const -> std::vector<neighbour> {
+		check_same_dimensions(originals.dimensions(), query.dimensions());
+		if (originals.size() < size()) {
+			throw std::invalid_argument("vector_file holds " + std::to_string(originals.size())
+			                            + " vectors but the index holds " + std::to_string(size()));
+		}
+
+		auto candidates = search(query, std::max(k, rerank), pool);
+		// Reading in id order keeps the file accesses moving forwards
+		std::ranges::sort(candidates, {}, &neighbour::id);
+		for (auto& candidate : candidates) {
+			auto const original = originals.read(candidate.id);
+			candidate.distance = metric_ == search_metric::l2 ? distance(original, query)
+			                                                  : -dot(original, query);
+		}
+		keep_closest(candidates, k);
+		return candidates;
+	}
+} // namespace comp6771
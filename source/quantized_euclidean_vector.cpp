@@ -0,0 +1,113 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/quantized_euclidean_vector.hpp>
+
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		constexpr auto max_value = 127.0;
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+	} // namespace
+
+	quantized_euclidean_vector::quantized_euclidean_vector(euclidean_vector const& v)
+	: values_(static_cast<std::size_t>(v.dimensions())) {
+		auto const* const x = v.data();
+		auto const n = values_.size();
+		if (not std::all_of(x, x + n, [](double m) { return std::isfinite(m); }))
+			throw std::invalid_argument("Cannot quantize a euclidean_vector with non-finite magnitudes");
+		if (n == 0)
+			return;
+
+		auto const [low, high] = std::minmax_element(x, x + n);
+		// Halved before subtracting, since the range of two finite magnitudes can overflow
+		offset_ = *low / 2 + *high / 2;
+		scale_ = (*high / 2 - *low / 2) / max_value;
+		auto const inverse = scale_ > 0 ? 1 / scale_ : 0.0;
+		for (auto i = std::size_t{0}; i < n; ++i) {
+			auto const q = std::clamp(std::round((x[i] - offset_) * inverse), -max_value, max_value);
+			values_[i] = static_cast<std::int8_t>(q);
+		}
+
+		sum_ = kernels::sum(values_.data(), n);
+		sum_of_squares_ = kernels::dot(values_.data(), values_.data(), n);
+		norm_ = euclidean_norm(v);
+	}
+
+	auto quantized_euclidean_vector::dequantize() const -> euclidean_vector {
+		auto magnitudes = std::vector<double>(values_.size());
+		for (auto i = std::size_t{0}; i < values_.size(); ++i)
+			magnitudes[i] = offset_ + scale_ * values_[i];
+		return euclidean_vector::from(std::move(magnitudes));
+	}
+
+	// Of the dequantized vector: sum (o + s q)^2 = n o^2 + 2 o s sum(q) + s^2 sum(q^2)
+	auto quantized_euclidean_vector::squared_norm() const noexcept -> double {
+		auto const n = static_cast<double>(values_.size());
+		return n * offset_ * offset_ + 2 * offset_ * scale_ * static_cast<double>(sum_)
+		       + scale_ * scale_ * static_cast<double>(sum_of_squares_);
+	}
+
+	// sum (ox + sx qx)(oy + sy qy) = n ox oy + ox sy sum(qy) + oy sx sum(qx) + sx sy sum(qx qy)
+	auto dot(quantized_euclidean_vector const& x, quantized_euclidean_vector const& y) -> double {
+		check_same_dimensions(x.dimensions(), y.dimensions());
+		auto const n = static_cast<double>(x.values_.size());
+		auto const products = kernels::dot(x.values_.data(), y.values_.data(), x.values_.size());
+		return n * x.offset_ * y.offset_ + x.offset_ * y.scale_ * static_cast<double>(y.sum_)
+		       + y.offset_ * x.scale_ * static_cast<double>(x.sum_)
+		       + x.scale_ * y.scale_ * static_cast<double>(products);
+	}
+
+	// sum (o + s q) y = o sum(y) + s sum(q y)
+	auto dot(quantized_euclidean_vector const& x, euclidean_vector const& y) -> double {
+		check_same_dimensions(x.dimensions(), y.dimensions());
+		auto const n = x.values_.size();
+		auto y_sum = 0.0;
+		for (auto i = std::size_t{0}; i < n; ++i)
+			y_sum += y.data()[i];
+		return x.offset_ * y_sum + x.scale_ * kernels::dot(y.data(), x.values_.data(), n);
+	}
+
+	auto squared_distance(quantized_euclidean_vector const& x, quantized_euclidean_vector const& y)
+	   -> double {
+		check_same_dimensions(x.dimensions(), y.dimensions());
+		if (x.scale_ == y.scale_ and x.offset_ == y.offset_) {
+			auto const differences =
+			   kernels::squared_distance(x.values_.data(), y.values_.data(), x.values_.size());
+			return x.scale_ * x.scale_ * static_cast<double>(differences);
+		}
+		return std::max(0.0, x.squared_norm() + y.squared_norm() - 2 * dot(x, y));
+	}
+
+	auto distance(quantized_euclidean_vector const& x, quantized_euclidean_vector const& y)
+	   -> double {
+		return std::sqrt(squared_distance(x, y));
+	}
+
+	auto euclidean_norm(quantized_euclidean_vector const& v) noexcept -> double {
+		return v.norm_;
+	}
+
+	auto quantize_all(std::span<euclidean_vector const> vectors, thread_pool& pool)
+	   -> std::vector<quantized_euclidean_vector> {
+		auto result = std::vector<quantized_euclidean_vector>(vectors.size());
+		pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				result[i] = quantized_euclidean_vector(vectors[i]);
+		});
+		return result;
+	}
+} // namespace comp6771
@@ -0,0 +1,167 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/random_projection.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace comp6771 {
+	namespace {
+		// Vectors projected per gemm in apply_all
+		constexpr auto gemm_block = std::size_t{1024};
+
+		void check_same_dimensions(int lhs, int rhs) {
+			if (lhs != rhs) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+				                            + std::to_string(rhs) + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		// Unnormalised, in place. n must be a power of two.
+		void walsh_hadamard(double* x, std::size_t n) noexcept {
+			for (auto half = std::size_t{1}; half < n; half *= 2)
+				for (auto first = std::size_t{0}; first < n; first += 2 * half)
+					for (auto i = first; i < first + half; ++i) {
+						auto const a = x[i];
+						auto const b = x[i + half];
+						x[i] = a + b;
+						x[i + half] = a - b;
+					}
+		}
+	} // namespace
+
+	random_projection::random_projection(int input_dimensions,
+	                                     int output_dimensions,
+	                                     random_projection_kind kind,
+	                                     std::uint64_t seed)
+	: input_dimensions_(input_dimensions)
+	, output_dimensions_(output_dimensions)
+	, kind_(kind) {
+		if (input_dimensions_ < 1 or output_dimensions_ < 1)
+			throw std::invalid_argument("random_projection needs at least one input and output "
+			                            "dimension");
+
+		auto random = std::mt19937_64(seed);
+		auto const k = static_cast<double>(output_dimensions_);
+		if (kind_ == random_projection_kind::fast_hadamard) {
+			auto const padded = std::bit_ceil(static_cast<std::size_t>(input_dimensions_));
+			if (static_cast<std::size_t>(output_dimensions_) > padded) {
+				throw std::invalid_argument("fast_hadamard can keep at most "
+				                            + std::to_string(padded) + " dimensions");
+			}
+
+			auto coin = std::bernoulli_distribution(0.5);
+			signs_.resize(padded);
+			for (auto& sign : signs_)
+				sign = coin(random) ? 1.0 : -1.0;
+
+			kept_.resize(padded);
+			std::iota(kept_.begin(), kept_.end(), std::size_t{0});
+			std::shuffle(kept_.begin(), kept_.end(), random);
+			kept_.resize(static_cast<std::size_t>(output_dimensions_));
+			std::ranges::sort(kept_);
+			return;
+		}
+
+		matrix_ = dense_matrix(output_dimensions_, input_dimensions_);
+		matrix_by_column_ =
+		   dense_matrix(input_dimensions_, output_dimensions_, matrix_layout::column_major);
+		auto gaussian = std::normal_distribution<double>(0.0, 1.0 / std::sqrt(k));
+		auto die = std::uniform_int_distribution<int>(1, 6);
+		auto const sparse_scale = std::sqrt(3.0 / k);
+		for (auto r = 0; r < output_dimensions_; ++r)
+			for (auto c = 0; c < input_dimensions_; ++c) {
+				auto value = 0.0;
+				if (kind_ == random_projection_kind::gaussian) {
+					value = gaussian(random);
+				}
+				else {
+					auto const roll = die(random);
+					value = roll == 1 ? sparse_scale : roll == 6 ? -sparse_scale : 0.0;
+				}
+				matrix_(r, c) = value;
+				matrix_by_column_(c, r) = value;
+			}
+	}
+
+	// y = sqrt(1 / k) S H D x, where D flips signs, H is the unnormalised Hadamard matrix and S
+	// keeps k coordinates. H / sqrt(n) is orthonormal, and keeping k of n coordinates scaled by
+	// sqrt(n / k) preserves the squared length in expectation.
+	void random_projection::hadamard(double const* x, std::vector<double>& work, double* y) const {
+		auto const n = signs_.size();
+		auto const d = static_cast<std::size_t>(input_dimensions_);
+		work.assign(n, 0.0);
+		for (auto i = std::size_t{0}; i < d; ++i)
+			work[i] = signs_[i] * x[i];
+		walsh_hadamard(work.data(), n);
+
+		auto const scale = 1.0 / std::sqrt(static_cast<double>(output_dimensions_));
+		for (auto i = std::size_t{0}; i < kept_.size(); ++i)
+			y[i] = scale * work[kept_[i]];
+	}
+
+	auto random_projection::apply(euclidean_vector const& v) const -> euclidean_vector {
+		check_same_dimensions(input_dimensions_, v.dimensions());
+		if (kind_ != random_projection_kind::fast_hadamard)
+			return gemv(matrix_, v);
+
+		auto work = std::vector<double>();
+		auto result = euclidean_vector(output_dimensions_);
+		hadamard(v.data(), work, result.mutable_data());
+		return result;
+	}
+
+	void random_projection::apply_all(std::span<euclidean_vector const> vectors,
+	                                  std::span<euclidean_vector> out,
+	                                  thread_pool& pool) const {
+		for (auto const& v : vectors)
+			check_same_dimensions(input_dimensions_, v.dimensions());
+		if (vectors.size() != out.size()) {
+			const std::string message = "Number of vectors(" + std::to_string(vectors.size())
+			                            + ") and outputs(" + std::to_string(out.size())
+			                            + ") do not match";
+			throw std::invalid_argument(message);
+		}
+
+		auto const k = static_cast<std::size_t>(output_dimensions_);
+		pool.parallel_for(out.size(), [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				if (out[i].dimensions() != output_dimensions_)
+					out[i] = euclidean_vector(output_dimensions_);
+		});
+
+		if (kind_ == random_projection_kind::fast_hadamard) {
+			pool.parallel_for(vectors.size(), [&](std::size_t first, std::size_t last) {
+				auto work = std::vector<double>();
+				for (auto i = first; i < last; ++i)
+					hadamard(vectors[i].data(), work, out[i].mutable_data());
+			});
+			return;
+		}
+
+		for (auto first = std::size_t{0}; first < vectors.size(); first += gemm_block) {
+			auto const block = vectors.subspan(first, std::min(gemm_block, vectors.size() - first));
+			auto const projected = gemm(dense_matrix::from_rows(block), matrix_by_column_);
+			pool.parallel_for(block.size(), [&](std::size_t begin, std::size_t end) {
+				for (auto i = begin; i < end; ++i) {
+					auto const row = projected.row(static_cast<int>(i));
+					std::copy_n(row.data(), k, out[first + i].mutable_data());
+				}
+			});
+		}
+	}
+
+	auto random_projection::apply_all(std::span<euclidean_vector const> vectors,
+	                                  thread_pool& pool) const -> std::vector<euclidean_vector> {
+		auto out = std::vector<euclidean_vector>(vectors.size());
+		apply_all(vectors, out, pool);
+		return out;
+	}
+} // namespace comp6771
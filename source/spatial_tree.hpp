@@ -0,0 +1,241 @@
+#ifndef COMP6771_SPATIAL_TREE_HPP
+#define COMP6771_SPATIAL_TREE_HPP
+
+// Layout and search helpers shared by kd_tree and ball_tree.
+//
+// Both trees are perfect binary trees stored in heap order: node i has children 2i + 1 and 2i + 2,
+// and every leaf is at the same depth. The vectors are reordered into one arena so that each node
+// covers a contiguous range of rows, which is split at its middle to give the children's ranges.
+// Nothing but the per-node data is stored; ranges are recomputed on the way down.
+
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace comp6771::spatial {
+	inline auto middle(std::size_t first, std::size_t last) noexcept -> std::size_t {
+		return first + (last - first) / 2;
+	}
+
+	// Smallest depth at which no leaf holds more than `leaf_size` vectors
+	inline auto leaf_depth(std::size_t size, std::size_t leaf_size) noexcept -> int {
+		auto depth = 0;
+		for (auto largest = size; largest > leaf_size; largest -= largest / 2)
+			++depth;
+		return depth;
+	}
+
+	inline auto node_count(int depth) noexcept -> std::size_t {
+		return (std::size_t{2} << depth) - 1;
+	}
+
+	inline void check_same_dimensions(int lhs, int rhs) {
+		if (lhs != rhs) {
+			const std::string message = "Dimensions of LHS(" + std::to_string(lhs) + ") and RHS("
+			                            + std::to_string(rhs) + ") do not match";
+			throw std::invalid_argument(message);
+		}
+	}
+
+	// A query's dimensions only matter once the tree holds something to compare against
+	template<typename Tree>
+	void check_query(Tree const& tree, euclidean_vector const& query) {
+		if (tree.size() != 0)
+			check_same_dimensions(tree.dimensions(), query.dimensions());
+	}
+
+	// Checks every query, then answers them with `search` shared out across `pool`
+	template<typename Tree, typename Search>
+	auto search_all(Tree const& tree,
+	                std::span<euclidean_vector const> queries,
+	                thread_pool& pool,
+	                Search const& search) -> std::vector<std::vector<neighbour>> {
+		for (auto const& query : queries)
+			check_query(tree, query);
+
+		auto results = std::vector<std::vector<neighbour>>(queries.size());
+		pool.parallel_for(queries.size(), [&](std::size_t first, std::size_t last) {
+			for (auto q = first; q < last; ++q)
+				results[q] = search(queries[q]);
+		});
+		return results;
+	}
+
+	// A node still to be searched, and a lower bound on the squared distance to anything in it
+	struct frame {
+		std::size_t node;
+		std::size_t first;
+		std::size_t last;
+		int level;
+		double bound;
+	};
+
+	// Enough for any tree, since each level adds at most one pending sibling
+	using frame_stack = std::array<frame, 2 * 64>;
+
+	struct layout {
+		int dimensions = 0;
+		int depth = 0;
+		// The vectors in tree order, one row each
+		std::vector<double> arena;
+		// Position of each arena row in the input
+		std::vector<std::size_t> ids;
+		// The dimension each internal node was split on, and the coordinate of the median along it.
+		// The left child's coordinates are all <= the median, and the right child's are >= it.
+		std::vector<int> split_dimensions;
+		std::vector<double> split_values;
+	};
+
+	// Orders `vectors` so that every internal node's range is split at its middle along the
+	// dimension of greatest spread, with the smaller coordinates on the left. The tree is
+	// partitioned one level at a time, with the nodes of each level shared out across `pool`.
+	inline auto build_layout(std::span<euclidean_vector const> vectors,
+	                         std::size_t leaf_size,
+	                         thread_pool& pool) -> layout {
+		if (leaf_size == 0)
+			throw std::invalid_argument("Leaf size must be at least 1");
+
+		auto result = layout();
+		if (vectors.empty())
+			return result;
+		result.dimensions = vectors.front().dimensions();
+		for (auto const& v : vectors)
+			check_same_dimensions(result.dimensions, v.dimensions());
+
+		auto const n = vectors.size();
+		auto const d = static_cast<std::size_t>(result.dimensions);
+		result.depth = leaf_depth(n, leaf_size);
+		result.split_dimensions.resize(node_count(result.depth) / 2);
+		result.split_values.resize(result.split_dimensions.size());
+
+		auto order = std::vector<std::size_t>(n);
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		auto const coordinate = [&](std::size_t id, int dimension) {
+			return vectors[id][dimension];
+		};
+
+		// The nodes on one level partition [0, n), so a level is described by its boundaries
+		auto bounds = std::vector<std::size_t>{0, n};
+		for (auto level = 0; level < result.depth; ++level) {
+			auto const nodes = bounds.size() - 1;
+			auto const first_node = nodes - 1;
+			pool.parallel_for(nodes, 1, [&](std::size_t begin, std::size_t end) {
+				for (auto j = begin; j < end; ++j) {
+					auto const first = order.begin() + static_cast<std::ptrdiff_t>(bounds[j]);
+					auto const last = order.begin() + static_cast<std::ptrdiff_t>(bounds[j + 1]);
+
+					auto widest = 0;
+					auto widest_spread = -1.0;
+					for (auto dimension = 0; dimension < result.dimensions; ++dimension) {
+						auto const [low, high] = std::minmax_element(
+						   first, last, [&](std::size_t a, std::size_t b) {
+							   return coordinate(a, dimension) < coordinate(b, dimension);
+						   });
+						auto const spread = first == last ? 0.0
+						                                  : coordinate(*high, dimension)
+						                                       - coordinate(*low, dimension);
+						if (spread > widest_spread) {
+							widest = dimension;
+							widest_spread = spread;
+						}
+					}
+
+					auto const split = order.begin()
+					                   + static_cast<std::ptrdiff_t>(middle(bounds[j], bounds[j + 1]));
+					std::nth_element(first, split, last, [&](std::size_t a, std::size_t b) {
+						auto const x = coordinate(a, widest);
+						auto const y = coordinate(b, widest);
+						return x < y or (x == y and a < b);
+					});
+					result.split_dimensions[first_node + j] = widest;
+					result.split_values[first_node + j] = coordinate(*split, widest);
+				}
+			});
+
+			auto next = std::vector<std::size_t>();
+			next.reserve(2 * nodes + 1);
+			for (auto j = std::size_t{0}; j < nodes; ++j) {
+				next.push_back(bounds[j]);
+				next.push_back(middle(bounds[j], bounds[j + 1]));
+			}
+			next.push_back(n);
+			bounds = std::move(next);
+		}
+
+		result.arena.resize(n * d);
+		pool.parallel_for(n, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; ++row)
+				std::copy_n(vectors[order[row]].data(), d, result.arena.data() + row * d);
+		});
+		result.ids = std::move(order);
+		return result;
+	}
+
+	inline auto closer(neighbour const& a, neighbour const& b) noexcept -> bool {
+		return a.distance < b.distance or (a.distance == b.distance and a.id < b.id);
+	}
+
+	// The k closest vectors offered so far, by squared distance with ties broken by id
+	class nearest_set {
+	public:
+		explicit nearest_set(std::size_t k)
+		: k_(k) {}
+
+		// Squared distance a vector must beat to be kept; infinite until k have been offered
+		auto bound() const noexcept -> double {
+			return heap_.size() < k_ ? std::numeric_limits<double>::infinity() : heap_.top().distance;
+		}
+
+		void offer(std::size_t id, double squared_distance) {
+			auto const candidate = neighbour{id, squared_distance};
+			if (heap_.size() < k_)
+				heap_.push(candidate);
+			else if (k_ > 0 and closer(candidate, heap_.top())) {
+				heap_.pop();
+				heap_.push(candidate);
+			}
+		}
+
+		// Closest first, as Euclidean distances
+		auto take() -> std::vector<neighbour> {
+			auto result = std::vector<neighbour>(heap_.size());
+			for (auto i = result.size(); i > 0; --i) {
+				result[i - 1] = heap_.top();
+				result[i - 1].distance = std::sqrt(result[i - 1].distance);
+				heap_.pop();
+			}
+			return result;
+		}
+
+	private:
+		struct further_first {
+			auto operator()(neighbour const& a, neighbour const& b) const noexcept -> bool {
+				return closer(a, b);
+			}
+		};
+
+		std::size_t k_;
+		std::priority_queue<neighbour, std::vector<neighbour>, further_first> heap_;
+	};
+
+	// Converts the squared distances in `found` and sorts them closest first
+	inline void finish_radius_search(std::vector<neighbour>& found) {
+		for (auto& n : found)
+			n.distance = std::sqrt(n.distance);
+		std::ranges::sort(found, closer);
+	}
+} // namespace comp6771::spatial
+
+#endif // COMP6771_SPATIAL_TREE_HPP
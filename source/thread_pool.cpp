@@ -0,0 +1,237 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace comp6771 {
+	namespace {
+		using erased_function = void (*)(void const*, std::size_t, std::size_t);
+
+		// One parallel_for call. It lives on the caller's stack, which does not return until
+		// `remaining` reaches zero.
+		struct job {
+			job(erased_function f, void const* c, std::size_t g, std::size_t n) noexcept
+			: fn(f)
+			, context(c)
+			, grain(g)
+			, remaining(n) {}
+
+			erased_function fn;
+			void const* context;
+			std::size_t grain;
+			// Elements whose subranges have not finished running
+			std::atomic<std::size_t> remaining;
+			std::atomic<bool> failed = false;
+			std::mutex error_mutex;
+			std::exception_ptr error;
+		};
+
+		struct task {
+			job* owner = nullptr;
+			std::size_t first = 0;
+			std::size_t last = 0;
+		};
+
+		struct work_queue {
+			std::mutex mutex;
+			std::deque<task> tasks;
+		};
+
+		// The pool, and the queue within it, that the current thread works for
+		thread_local void const* current_pool = nullptr;
+		thread_local std::size_t current_queue = 0;
+
+		auto hardware_threads() noexcept -> std::size_t {
+			return std::max(std::size_t{1}, static_cast<std::size_t>(std::thread::hardware_concurrency()));
+		}
+
+		void pin_to_cpu(std::jthread& thread, std::size_t cpu) noexcept {
+#if defined(__linux__)
+			auto cpus = cpu_set_t();
+			CPU_ZERO(&cpus);
+			CPU_SET(cpu, &cpus);
+			pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+			static_cast<void>(thread);
+			static_cast<void>(cpu);
+#endif
+		}
+	} // namespace
+
+	struct thread_pool::state {
+		explicit state(std::size_t threads)
+		: queues(threads) {}
+
+		// queues[0] is shared by threads outside the pool; worker i owns queues[i]
+		std::vector<work_queue> queues;
+		std::vector<std::jthread> workers;
+		// Signed, as a thief may take a task before its push has been counted
+		std::atomic<std::ptrdiff_t> queued = 0;
+		std::atomic<std::ptrdiff_t> sleeping = 0;
+		std::atomic<bool> stopping = false;
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+
+		void push(std::size_t queue, task t) {
+			{
+				auto const lock = std::lock_guard(queues[queue].mutex);
+				queues[queue].tasks.push_back(t);
+			}
+			queued.fetch_add(1);
+			// Sleepers bump `sleeping` before they check `queued`, so one side always sees the other
+			if (sleeping.load() > 0) {
+				auto const lock = std::lock_guard(sleep_mutex);
+				wake.notify_one();
+			}
+		}
+
+		// Newest work from our own queue first, while it is still in cache; otherwise the oldest
+		// (and so largest) subrange from someone else's
+		auto try_take(std::size_t self, task& out) -> bool {
+			if (queued.load() <= 0)
+				return false;
+
+			for (auto offset = std::size_t{0}; offset < queues.size(); ++offset) {
+				auto& queue = queues[(self + offset) % queues.size()];
+				auto const lock = std::lock_guard(queue.mutex);
+				if (queue.tasks.empty())
+					continue;
+
+				if (offset == 0) {
+					out = queue.tasks.back();
+					queue.tasks.pop_back();
+				}
+				else {
+					out = queue.tasks.front();
+					queue.tasks.pop_front();
+				}
+				queued.fetch_sub(1);
+				return true;
+			}
+			return false;
+		}
+
+		// Halves the subrange until it is down to the job's grain, leaving the upper halves for
+		// other threads to steal, then runs what is left
+		void execute(std::size_t self, task t) {
+			auto& owner = *t.owner;
+			while (t.last - t.first >= 2 * owner.grain) {
+				auto const middle = t.first + (t.last - t.first) / 2;
+				push(self, {t.owner, middle, t.last});
+				t.last = middle;
+			}
+
+			if (not owner.failed.load(std::memory_order_relaxed)) {
+				try {
+					owner.fn(owner.context, t.first, t.last);
+				} catch (...) {
+					auto const lock = std::lock_guard(owner.error_mutex);
+					if (not owner.error)
+						owner.error = std::current_exception();
+					owner.failed.store(true, std::memory_order_relaxed);
+				}
+			}
+
+			// `owner` may be destroyed as soon as the count reaches zero
+			auto const count = t.last - t.first;
+			if (owner.remaining.fetch_sub(count, std::memory_order_acq_rel) == count) {
+				auto const lock = std::lock_guard(sleep_mutex);
+				wake.notify_all();
+			}
+		}
+
+		template<typename Predicate>
+		void sleep_until(Predicate predicate) {
+			auto lock = std::unique_lock(sleep_mutex);
+			sleeping.fetch_add(1);
+			wake.wait(lock, predicate);
+			sleeping.fetch_sub(1);
+		}
+
+		void work(std::size_t self) {
+			current_pool = this;
+			current_queue = self;
+			auto t = task();
+			while (not stopping.load()) {
+				if (try_take(self, t))
+					execute(self, t);
+				else
+					sleep_until([this] { return stopping.load() or queued.load() > 0; });
+			}
+		}
+	};
+
+	thread_pool::thread_pool(std::size_t threads, thread_affinity affinity)
+	: state_(std::make_unique<state>(threads == 0 ? hardware_threads() : threads)) {
+		auto const count = state_->queues.size();
+		state_->workers.reserve(count - 1);
+		for (auto i = std::size_t{1}; i < count; ++i) {
+			auto& worker = state_->workers.emplace_back([s = state_.get(), i] { s->work(i); });
+			if (affinity == thread_affinity::pinned)
+				pin_to_cpu(worker, i % hardware_threads());
+		}
+	}
+
+	thread_pool::~thread_pool() {
+		{
+			auto const lock = std::lock_guard(state_->sleep_mutex);
+			state_->stopping.store(true);
+		}
+		state_->wake.notify_all();
+		state_->workers.clear();
+	}
+
+	auto thread_pool::size() const noexcept -> std::size_t {
+		return state_->queues.size();
+	}
+
+	void thread_pool::run(std::size_t n, std::size_t grain, erased_function fn, void const* context) {
+		if (n == 0)
+			return;
+		if (grain == 0)
+			grain = std::max(std::size_t{1}, n / (8 * size()));
+		if (state_->workers.empty() or n < 2 * grain) {
+			fn(context, 0, n);
+			return;
+		}
+
+		auto& s = *state_;
+		auto const self = current_pool == &s ? current_queue : 0;
+		auto owner = job(fn, context, grain, n);
+		s.execute(self, {&owner, 0, n});
+
+		// Help with whatever is queued (not necessarily our own work) until every subrange is done
+		auto t = task();
+		while (owner.remaining.load(std::memory_order_acquire) > 0) {
+			if (s.try_take(self, t))
+				s.execute(self, t);
+			else
+				s.sleep_until([&] {
+					return owner.remaining.load(std::memory_order_acquire) == 0 or s.queued.load() > 0;
+				});
+		}
+
+		if (owner.error)
+			std::rethrow_exception(owner.error);
+	}
+
+	auto default_thread_pool() -> thread_pool& {
+		static auto pool = thread_pool();
+		return pool;
+	}
+} // namespace comp6771
@@ -0,0 +1,108 @@
+// Copyright (c) Christopher Di Bella.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include <comp6771/vector_file.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace comp6771 {
+	namespace {
+		constexpr auto file_magic = std::uint32_t{0x53434556}; // "VECS"
+		constexpr auto file_version = std::uint32_t{1};
+		// magic, version, dimensions and count
+		constexpr auto header_size = std::streamoff{2 * sizeof(std::uint32_t) + sizeof(std::int32_t)
+		                                            + sizeof(std::uint64_t)};
+
+		template<typename T>
+		void write_value(std::ostream& out, T const& value) {
+			out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+		}
+
+		template<typename T>
+		auto read_value(std::istream& in) -> T {
+			auto value = T();
+			in.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return value;
+		}
+	} // namespace
+
+	struct vector_file::stream {
+		std::mutex lock;
+		std::ifstream in;
+	};
+
+	void vector_file::write(std::string const& path, std::span<euclidean_vector const> vectors) {
+		auto const dimensions = vectors.empty() ? 0 : vectors.front().dimensions();
+		for (auto const& v : vectors) {
+			if (v.dimensions() != dimensions) {
+				const std::string message = "Dimensions of LHS(" + std::to_string(dimensions)
+				                            + ") and RHS(" + std::to_string(v.dimensions())
+				                            + ") do not match";
+				throw std::invalid_argument(message);
+			}
+		}
+
+		auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+		if (not out)
+			throw std::runtime_error("Could not open " + path + " for writing");
+		write_value(out, file_magic);
+		write_value(out, file_version);
+		write_value(out, static_cast<std::int32_t>(dimensions));
+		write_value(out, static_cast<std::uint64_t>(vectors.size()));
+		auto const row_bytes =
+		   static_cast<std::streamsize>(static_cast<std::size_t>(dimensions) * sizeof(double));
+		for (auto const& v : vectors)
+			out.write(reinterpret_cast<char const*>(v.data()), row_bytes);
+		if (not out)
+			throw std::runtime_error("Could not write vectors to " + path);
+	}
+
+	vector_file::vector_file(std::string const& path)
+	: stream_(std::make_unique<stream>()) {
+		auto& in = stream_->in;
+		in.open(path, std::ios::binary);
+		if (not in)
+			throw std::runtime_error("Could not open " + path + " for reading");
+		if (read_value<std::uint32_t>(in) != file_magic
+		    or read_value<std::uint32_t>(in) != file_version)
+			throw std::runtime_error(path + " does not hold saved vectors");
+		dimensions_ = read_value<std::int32_t>(in);
+		size_ = static_cast<std::size_t>(read_value<std::uint64_t>(in));
+
+		in.seekg(0, std::ios::end);
+		auto const data_bytes = size_ * static_cast<std::size_t>(dimensions_) * sizeof(double);
+		auto const expected = header_size + static_cast<std::streamoff>(data_bytes);
+		if (not in or dimensions_ < 0 or in.tellg() != expected)
+			throw std::runtime_error(path + " is truncated or corrupt");
+	}
+
+	vector_file::vector_file(vector_file&&) noexcept = default;
+	vector_file& vector_file::operator=(vector_file&&) noexcept = default;
+	vector_file::~vector_file() = default;
+
+	auto vector_file::read(std::size_t id) const -> euclidean_vector {
+		if (id >= size_) {
+			throw std::out_of_range("Vector " + std::to_string(id) + " is past the end of a file of "
+			                        + std::to_string(size_));
+		}
+
+		auto const d = static_cast<std::size_t>(dimensions_);
+		auto values = std::vector<double>(d);
+		{
+			auto const lock = std::lock_guard(stream_->lock);
+			auto& in = stream_->in;
+			in.seekg(header_size + static_cast<std::streamoff>(id * d * sizeof(double)));
+			in.read(reinterpret_cast<char*>(values.data()),
+			        static_cast<std::streamsize>(d * sizeof(double)));
+			if (not in) {
+				in.clear();
+				throw std::runtime_error("Could not read vector " + std::to_string(id));
+			}
+		}
+		return euclidean_vector::from(std::move(values));
+	}
+} // namespace comp6771
@@ -0,0 +1,179 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/ball_tree.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+The tree is exact, so every query is compared with brute_force_knn, or with a linear filter for
+radius searches. Corpus sizes are chosen so that some leaves are full and others are not, and the
+leaf size is varied down to 1 so that the deepest trees (including empty leaves) are covered.
+Duplicated coordinates check that median splits with ties keep points on both sides reachable.
+Tightly clustered data in a higher dimension, where the balls rather than the splitting planes do
+the pruning, is checked separately. Trees built on different pool sizes must give identical answers.
+*/
+namespace {
+	auto make_points(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::uniform_real_distribution<double>(-10.0, 10.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto linear_radius_search(std::vector<comp6771::euclidean_vector> const& corpus,
+	                          comp6771::euclidean_vector const& query,
+	                          double radius) -> std::vector<std::size_t> {
+		auto ids = std::vector<std::size_t>();
+		for (auto i = std::size_t{0}; i < corpus.size(); ++i)
+			if (squared_distance(corpus[i], query) <= radius * radius)
+				ids.push_back(i);
+		return ids;
+	}
+
+	auto ids_of(std::vector<comp6771::neighbour> const& found) -> std::vector<std::size_t> {
+		auto ids = std::vector<std::size_t>();
+		for (auto const& n : found)
+			ids.push_back(n.id);
+		std::ranges::sort(ids);
+		return ids;
+	}
+} // namespace
+
+TEST_CASE("Empty tree") {
+	auto const tree = comp6771::ball_tree({});
+	CHECK(tree.size() == 0);
+	CHECK(tree.dimensions() == 0);
+	CHECK(tree.knn(comp6771::euclidean_vector{1, 2}, 3).empty());
+	CHECK(tree.radius_search(comp6771::euclidean_vector{1, 2}, 10).empty());
+	CHECK(not tree.any_within(comp6771::euclidean_vector{1, 2}, 10));
+}
+
+TEST_CASE("Invalid input throws") {
+	auto const corpus =
+	   std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2},
+	                                           comp6771::euclidean_vector{1, 2, 3}};
+	CHECK_THROWS_WITH(comp6771::ball_tree(corpus), "Dimensions of LHS(2) and RHS(3) do not match");
+	CHECK_THROWS_AS(comp6771::ball_tree(std::span(corpus).first(1), 0), std::invalid_argument);
+
+	auto const tree = comp6771::ball_tree(std::span(corpus).first(1));
+	CHECK_THROWS_WITH(tree.knn(comp6771::euclidean_vector{1}, 1),
+	                  "Dimensions of LHS(2) and RHS(1) do not match");
+	CHECK_THROWS_WITH(tree.any_within(comp6771::euclidean_vector{1}, 1),
+	                  "Dimensions of LHS(2) and RHS(1) do not match");
+}
+
+TEST_CASE("k nearest neighbours match brute force") {
+	auto const dimensions = GENERATE(2, 3, 7);
+	auto const leaf_size = GENERATE(std::size_t{1}, std::size_t{5}, std::size_t{16});
+	auto const corpus = make_points(1237, dimensions, 1);
+	auto const queries = make_points(40, dimensions, 2);
+	auto const tree = comp6771::ball_tree(corpus, leaf_size);
+	REQUIRE(tree.size() == corpus.size());
+	REQUIRE(tree.dimensions() == dimensions);
+
+	for (auto const k : {std::size_t{1}, std::size_t{10}}) {
+		auto const batch = tree.knn(queries, k);
+		for (auto q = std::size_t{0}; q < queries.size(); ++q) {
+			auto const expected = comp6771::brute_force_knn(corpus, queries[q], k);
+			auto const found = tree.knn(queries[q], k);
+			REQUIRE(found.size() == expected.size());
+			for (auto i = std::size_t{0}; i < found.size(); ++i) {
+				CHECK(found[i].id == expected[i].id);
+				CHECK(found[i].distance == Approx(expected[i].distance));
+			}
+			CHECK(batch[q] == found);
+		}
+	}
+
+	// Every stored point is its own nearest neighbour
+	for (auto id = std::size_t{0}; id < corpus.size(); id += 101)
+		CHECK(tree.knn(corpus[id], 1).front() == comp6771::neighbour{id, 0.0});
+	CHECK(tree.knn(queries[0], corpus.size() + 5).size() == corpus.size());
+}
+
+TEST_CASE("Radius search matches a linear filter") {
+	auto const corpus = make_points(2000, 3, 3);
+	auto const queries = make_points(30, 3, 4);
+	auto const tree = comp6771::ball_tree(corpus, 8);
+
+	for (auto const radius : {0.0, 1.5, 4.0, 50.0}) {
+		auto const batch = tree.radius_search(queries, radius);
+		for (auto q = std::size_t{0}; q < queries.size(); ++q) {
+			auto const expected = linear_radius_search(corpus, queries[q], radius);
+			auto const found = tree.radius_search(queries[q], radius);
+			CHECK(ids_of(found) == expected);
+			CHECK(std::ranges::is_sorted(found, {}, &comp6771::neighbour::distance));
+			CHECK(tree.any_within(queries[q], radius) == not expected.empty());
+			CHECK(batch[q] == found);
+		}
+	}
+
+	SECTION("The radius is inclusive") {
+		auto const found = tree.radius_search(corpus[7], 0.0);
+		REQUIRE(found.size() == 1);
+		CHECK(found.front() == comp6771::neighbour{7, 0.0});
+		CHECK(tree.radius_search(corpus[7], -1.0).empty());
+	}
+}
+
+TEST_CASE("Duplicated coordinates") {
+	// Many points share each x, so the splits on x have ties spanning the median
+	auto corpus = std::vector<comp6771::euclidean_vector>();
+	for (auto i = 0; i < 300; ++i)
+		corpus.push_back(comp6771::euclidean_vector{static_cast<double>(i % 3), i * 0.01});
+	auto const tree = comp6771::ball_tree(corpus, 4);
+
+	for (auto const& query : make_points(20, 2, 5)) {
+		auto const found = tree.knn(query, 7);
+		auto const expected = comp6771::brute_force_knn(corpus, query, 7);
+		CHECK(ids_of(found) == ids_of(expected));
+		CHECK(ids_of(tree.radius_search(query, 9.0)) == linear_radius_search(corpus, query, 9.0));
+	}
+}
+
+TEST_CASE("Building does not depend on the thread count") {
+	auto const corpus = make_points(5000, 4, 6);
+	auto const queries = make_points(20, 4, 7);
+	auto single = comp6771::thread_pool(1);
+	auto several = comp6771::thread_pool(4);
+	auto const a = comp6771::ball_tree(corpus, 16, single);
+	auto const b = comp6771::ball_tree(corpus, 16, several);
+	CHECK(a.knn(queries, 5, single) == b.knn(queries, 5, several));
+	CHECK(a.radius_search(queries, 3.0, single) == b.radius_search(queries, 3.0, several));
+}
+
+TEST_CASE("Clustered data in higher dimensions") {
+	// Tight clusters around far apart centres, which is where balls prune better than planes
+	auto const centres = make_points(8, 12, 8);
+	auto random = std::mt19937(9);
+	auto jitter = std::normal_distribution<double>(0.0, 0.05);
+	auto corpus = std::vector<comp6771::euclidean_vector>();
+	for (auto i = 0; i < 1600; ++i) {
+		auto v = centres[static_cast<std::size_t>(i) % centres.size()];
+		for (auto d = 0; d < v.dimensions(); ++d)
+			v[d] += jitter(random);
+		corpus.push_back(v);
+	}
+	auto const tree = comp6771::ball_tree(corpus, 10);
+
+	for (auto const& centre : centres) {
+		auto const found = tree.knn(centre, 15);
+		auto const expected = comp6771::brute_force_knn(corpus, centre, 15);
+		CHECK(ids_of(found) == ids_of(expected));
+		CHECK(ids_of(tree.radius_search(centre, 0.2)) == linear_radius_search(corpus, centre, 0.2));
+		CHECK(tree.any_within(centre, 0.5));
+	}
+}
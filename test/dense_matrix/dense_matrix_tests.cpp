@@ -0,0 +1,213 @@
+#include <catch2/catch.hpp>
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/euclidean_vector_view.hpp>
+
+#include <vector>
+
+/*
+Testing rationale
+
+Construction and element access are tested first, followed by the row and column views, as the
+product tests rely on both to set up and inspect matrices. GEMV and GEMM are then checked against
+a naive triple loop over both layouts, at sizes that leave partial register tiles and partial
+cache blocks so that every edge case of the blocked kernels is exercised.
+*/
+namespace {
+	auto make_matrix(int rows, int cols, comp6771::matrix_layout layout) -> comp6771::dense_matrix {
+		auto matrix = comp6771::dense_matrix(rows, cols, layout);
+		for (auto r = 0; r < rows; ++r)
+			for (auto c = 0; c < cols; ++c)
+				matrix(r, c) = static_cast<double>((r * 7 + c * 3) % 11) - 5.0;
+		return matrix;
+	}
+
+	auto naive_product(comp6771::dense_matrix const& a, comp6771::dense_matrix const& b)
+	   -> std::vector<double> {
+		auto result = std::vector<double>();
+		for (auto r = 0; r < a.rows(); ++r)
+			for (auto c = 0; c < b.cols(); ++c) {
+				auto sum = 0.0;
+				for (auto k = 0; k < a.cols(); ++k)
+					sum += a(r, k) * b(k, c);
+				result.push_back(sum);
+			}
+		return result;
+	}
+
+	auto elements(comp6771::dense_matrix const& m) -> std::vector<double> {
+		auto result = std::vector<double>();
+		for (auto r = 0; r < m.rows(); ++r)
+			for (auto c = 0; c < m.cols(); ++c)
+				result.push_back(m(r, c));
+		return result;
+	}
+} // namespace
+
+TEST_CASE("dense_matrix constructor and element access tests") {
+	SECTION("default constructed dense_matrix is empty") {
+		auto matrix = comp6771::dense_matrix();
+		CHECK(matrix.rows() == 0);
+		CHECK(matrix.cols() == 0);
+	}
+
+	SECTION("dense_matrix filled with a value in either layout") {
+		auto row_major = comp6771::dense_matrix(2, 3, 1.5);
+		auto column_major = comp6771::dense_matrix(2, 3, 1.5, comp6771::matrix_layout::column_major);
+
+		CHECK(row_major.rows() == 2);
+		CHECK(row_major.cols() == 3);
+		CHECK(row_major(1, 2) == 1.5);
+		CHECK(column_major(1, 2) == 1.5);
+		CHECK(row_major.row_stride() == 3);
+		CHECK(column_major.col_stride() == 2);
+	}
+
+	SECTION("dense_matrix built from euclidean_vector rows") {
+		auto const rows = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2, 3},
+		                                                          comp6771::euclidean_vector{4, 5, 6}};
+		auto matrix = comp6771::dense_matrix::from_rows(rows, comp6771::matrix_layout::column_major);
+
+		CHECK(matrix.rows() == 2);
+		CHECK(matrix.cols() == 3);
+		CHECK(matrix(0, 2) == 3);
+		CHECK(matrix(1, 0) == 4);
+	}
+
+	SECTION("dense_matrix built from euclidean_vector columns") {
+		auto const columns = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2, 3},
+		                                                             comp6771::euclidean_vector{4, 5, 6}};
+		auto matrix = comp6771::dense_matrix::from_columns(columns, comp6771::matrix_layout::column_major);
+
+		CHECK(matrix.rows() == 3);
+		CHECK(matrix.cols() == 2);
+		CHECK(matrix(2, 0) == 3);
+		CHECK(matrix(0, 1) == 4);
+		CHECK(matrix.data()[3] == 4);
+		REQUIRE_THROWS_WITH(comp6771::dense_matrix::from_columns(
+		                       std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1},
+		                                                               comp6771::euclidean_vector{1, 2}}),
+		                    "Dimensions of LHS(1) and RHS(2) do not match");
+	}
+
+	SECTION("dense_matrix from rows of differing dimensions throws") {
+		auto const rows = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2},
+		                                                          comp6771::euclidean_vector{4}};
+		REQUIRE_THROWS_WITH(comp6771::dense_matrix::from_rows(rows),
+		                    "Dimensions of LHS(2) and RHS(1) do not match");
+	}
+}
+
+TEST_CASE("dense_matrix row and column view tests") {
+	for (auto layout : {comp6771::matrix_layout::row_major, comp6771::matrix_layout::column_major}) {
+		auto matrix = make_matrix(3, 4, layout);
+
+		auto const row = matrix.row(1);
+		auto const column = matrix.column(2);
+		CHECK(row.dimensions() == 4);
+		CHECK(column.dimensions() == 3);
+		CHECK(row[3] == matrix(1, 3));
+		CHECK(column[2] == matrix(2, 2));
+		CHECK_THROWS_AS(row.at(4), std::out_of_range);
+
+		auto const copy = static_cast<comp6771::euclidean_vector>(column);
+		CHECK(copy == comp6771::euclidean_vector{matrix(0, 2), matrix(1, 2), matrix(2, 2)});
+		CHECK(dot(row, matrix.row(0))
+		      == Approx(matrix(1, 0) * matrix(0, 0) + matrix(1, 1) * matrix(0, 1)
+		                + matrix(1, 2) * matrix(0, 2) + matrix(1, 3) * matrix(0, 3)));
+		CHECK(euclidean_norm(column) == Approx(euclidean_norm(copy)));
+		CHECK(distance(column, copy) == 0);
+	}
+}
+
+TEST_CASE("dense_matrix gemv tests") {
+	for (auto layout : {comp6771::matrix_layout::row_major, comp6771::matrix_layout::column_major}) {
+		auto const a = make_matrix(7, 13, layout);
+		auto x = comp6771::euclidean_vector(13);
+		for (auto i = 0; i < 13; ++i)
+			x[i] = 0.5 * i - 2;
+
+		auto expected = std::vector<double>();
+		for (auto r = 0; r < a.rows(); ++r)
+			expected.push_back(dot(a.row(r), x));
+
+		SECTION("gemv multiplies a matrix by a euclidean_vector") {
+			auto const y = gemv(a, x);
+			CHECK(y.dimensions() == 7);
+			for (auto r = 0; r < 7; ++r)
+				CHECK(y[r] == Approx(expected[static_cast<std::size_t>(r)]));
+		}
+
+		SECTION("gemv scales and accumulates into an existing euclidean_vector") {
+			auto y = comp6771::euclidean_vector(7, 1.0);
+			CHECK(euclidean_norm(y) == Approx(std::sqrt(7.0)));
+			gemv(2.0, a, x, -1.0, y);
+			for (auto r = 0; r < 7; ++r)
+				CHECK(y[r] == Approx(2 * expected[static_cast<std::size_t>(r)] - 1));
+			CHECK(euclidean_norm(y) == Approx(euclidean_norm(comp6771::euclidean_vector(y))));
+		}
+
+		SECTION("gemv accepts a strided view as x") {
+			auto const b = make_matrix(13, 3, layout);
+			auto const y = gemv(a, b.column(1));
+			auto const column = static_cast<comp6771::euclidean_vector>(b.column(1));
+			for (auto r = 0; r < 7; ++r)
+				CHECK(y[r] == Approx(dot(a.row(r), column)));
+		}
+
+		SECTION("gemv with x viewing y") {
+			auto const square = make_matrix(5, 5, layout);
+			auto y = comp6771::euclidean_vector{1, 2, 3, 4, 5};
+			auto const before = y;
+			gemv(1.0, square, y, 0.0, y);
+			for (auto r = 0; r < 5; ++r)
+				CHECK(y[r] == Approx(dot(square.row(r), before)));
+		}
+
+		SECTION("gemv throws for mismatched dimensions") {
+			REQUIRE_THROWS_WITH(gemv(a, comp6771::euclidean_vector(12)),
+			                    "Dimensions of LHS(13) and RHS(12) do not match");
+			auto y = comp6771::euclidean_vector(6);
+			REQUIRE_THROWS_AS(gemv(1.0, a, x, 0.0, y), std::invalid_argument);
+		}
+	}
+}
+
+TEST_CASE("dense_matrix gemm tests") {
+	using comp6771::matrix_layout;
+
+	SECTION("gemm matches a naive product across layouts and partial blocks") {
+		for (auto a_layout : {matrix_layout::row_major, matrix_layout::column_major}) {
+			for (auto b_layout : {matrix_layout::row_major, matrix_layout::column_major}) {
+				auto const a = make_matrix(133, 261, a_layout);
+				auto const b = make_matrix(261, 19, b_layout);
+				auto const c = gemm(a, b);
+
+				CHECK(c.rows() == 133);
+				CHECK(c.cols() == 19);
+				CHECK(c.layout() == a_layout);
+				CHECK(elements(c) == naive_product(a, b));
+			}
+		}
+	}
+
+	SECTION("gemm scales and accumulates into an existing matrix") {
+		auto const a = make_matrix(5, 6, matrix_layout::row_major);
+		auto const b = make_matrix(6, 9, matrix_layout::column_major);
+		auto c = comp6771::dense_matrix(5, 9, 1.0);
+		gemm(2.0, a, b, 3.0, c);
+
+		auto const product = naive_product(a, b);
+		for (auto r = 0; r < 5; ++r)
+			for (auto col = 0; col < 9; ++col)
+				CHECK(c(r, col) == 2 * product[static_cast<std::size_t>(r * 9 + col)] + 3);
+	}
+
+	SECTION("gemm throws for mismatched dimensions") {
+		auto const a = make_matrix(2, 3, matrix_layout::row_major);
+		auto c = comp6771::dense_matrix(2, 2);
+		REQUIRE_THROWS_WITH(gemm(a, a), "Dimensions of LHS(3) and RHS(2) do not match");
+		REQUIRE_THROWS_AS(gemm(1.0, a, make_matrix(3, 3, matrix_layout::row_major), 0.0, c),
+		                  std::invalid_argument);
+	}
+}
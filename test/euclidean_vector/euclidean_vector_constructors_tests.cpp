@@ -1,6 +1,11 @@
 #include <catch2/catch.hpp>
 #include <comp6771/euclidean_vector.hpp>
 
+#include <array>
+#include <deque>
+#include <span>
+#include <sstream>
+
 /*
 Testing rationale
 
@@ -284,4 +289,104 @@ TEST_CASE("euclidean_vector move constructor tests") {
 		CHECK(to.dimensions() == 0);
 		CHECK_THROWS(to.at(0));
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("euclidean_vector std::vector adoption tests") {
+	SECTION("vector adopted with multiple elements keeps the same buffer") {
+		auto std_vec = std::vector<double>{1.1, 2.2, 3.3};
+		auto const* buffer = std_vec.data();
+		auto vec = comp6771::euclidean_vector::from(std::move(std_vec));
+
+		CHECK(vec.dimensions() == 3);
+		CHECK(vec.at(0) == 1.1);
+		CHECK(vec.at(1) == 2.2);
+		CHECK(vec.at(2) == 3.3);
+		CHECK_THROWS(vec.at(3));
+
+		CHECK(&vec[0] == buffer);
+	}
+
+	SECTION("empty vector adopted as 0 dimension euclidean_vector") {
+		auto vec = comp6771::euclidean_vector::from(std::vector<double>());
+
+		CHECK(vec.dimensions() == 0);
+		CHECK_THROWS(vec.at(0));
+	}
+}
+
+TEST_CASE("euclidean_vector generic range constructor tests") {
+	SECTION("range constructed from std::array of doubles") {
+		auto arr = std::array<double, 3>{1.1, 2.2, 3.3};
+		auto vec = comp6771::euclidean_vector(arr);
+
+		CHECK(vec.dimensions() == 3);
+		CHECK(vec.at(0) == 1.1);
+		CHECK(vec.at(1) == 2.2);
+		CHECK(vec.at(2) == 3.3);
+		CHECK_THROWS(vec.at(3));
+	}
+
+	SECTION("range constructed from std::span of floats") {
+		auto floats = std::vector<float>{1.5f, -2.25f};
+		auto vec = comp6771::euclidean_vector(std::span<float const>(floats));
+
+		CHECK(vec.dimensions() == 2);
+		CHECK(vec.at(0) == 1.5);
+		CHECK(vec.at(1) == -2.25);
+		CHECK_THROWS(vec.at(2));
+	}
+
+	SECTION("range constructed from std::deque of ints") {
+		auto ints = std::deque<int>{4, 5, 6};
+		auto vec = comp6771::euclidean_vector(ints);
+
+		CHECK(vec.dimensions() == 3);
+		CHECK(vec.at(0) == 4.0);
+		CHECK(vec.at(2) == 6.0);
+	}
+
+	SECTION("range constructed from an unsized input range") {
+		auto stream = std::istringstream("1.5 2.5 3.5");
+		auto vec = comp6771::euclidean_vector(std::views::istream<double>(stream));
+
+		CHECK(vec.dimensions() == 3);
+		CHECK(vec.at(0) == 1.5);
+		CHECK(vec.at(2) == 3.5);
+	}
+
+	SECTION("range constructed from an empty range") {
+		auto vec = comp6771::euclidean_vector(std::array<float, 0>{});
+
+		CHECK(vec.dimensions() == 0);
+		CHECK_THROWS(vec.at(0));
+	}
+
+	SECTION("lvalue std::vector is copied rather than adopted") {
+		auto std_vec = std::vector<double>{1.1, 2.2};
+		auto vec = comp6771::euclidean_vector(std_vec);
+
+		CHECK(vec.dimensions() == 2);
+		CHECK(std_vec.size() == 2);
+		CHECK(&vec[0] != std_vec.data());
+	}
+}
+
+TEST_CASE("euclidean_vector generic iterator-pair constructor tests") {
+	SECTION("iterator-pair constructed from raw pointers") {
+		double const raw[] = {1.1, 2.2, 3.3};
+		auto vec = comp6771::euclidean_vector(raw + 1, raw + 3);
+
+		CHECK(vec.dimensions() == 2);
+		CHECK(vec.at(0) == 2.2);
+		CHECK(vec.at(1) == 3.3);
+		CHECK_THROWS(vec.at(2));
+	}
+
+	SECTION("iterator-pair constructed from std::list of floats") {
+		auto list = std::list<float>{0.5f, 0.25f};
+		auto vec = comp6771::euclidean_vector(list.begin(), list.end());
+
+		CHECK(vec.dimensions() == 2);
+		CHECK(vec.at(0) == 0.5);
+		CHECK(vec.at(1) == 0.25);
+	}
+}
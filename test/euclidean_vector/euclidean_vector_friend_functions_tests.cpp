@@ -1,8 +1,12 @@
 #include <catch2/catch.hpp>
 #include <comp6771/euclidean_vector.hpp>
+#include <cmath>
 #include <istream>
+#include <limits>
+#include <span>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 /*
 Testing rationale
@@ -219,7 +223,7 @@ TEST_CASE("euclidean_vector - overload tests") {
 	SECTION("- operator compound assignment tests") {
 		auto v3 = comp6771::euclidean_vector{1, 1};
 
-		auto copy = v1 - v2 - a3;
+		auto copy = v1 - v2 - v3;
 
 		CHECK(copy.dimensions() == 2);
 		CHECK(copy.at(0) == 0);
@@ -603,4 +607,337 @@ TEST_CASE("euclidean_vector dot product function tests") {
 		REQUIRE_THROWS_AS(dot(v1, v2), std::invalid_argument);
 		REQUIRE_THROWS_WITH(dot(v1, v2), "Dimensions of LHS(3) and RHS(4) do not match");
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("euclidean_vector equality across vector blocks tests") {
+	auto vec = comp6771::euclidean_vector(19, 1.5);
+
+	SECTION("== operator compares every element of long euclidean_vectors test") {
+		auto other = comp6771::euclidean_vector(19, 1.5);
+		CHECK(vec == other);
+
+		other[3] = 2.5;
+		CHECK(vec != other);
+		other[3] = 1.5;
+		other[18] = 2.5;
+		CHECK(vec != other);
+	}
+
+	SECTION("== operator treats signed zeros as equal and NaN as unequal test") {
+		CHECK(comp6771::euclidean_vector{0.0, -0.0} == comp6771::euclidean_vector{-0.0, 0.0});
+		auto nan = comp6771::euclidean_vector(1, std::nan(""));
+		CHECK(nan != nan);
+	}
+}
+
+TEST_CASE("euclidean_vector approximate equality function tests") {
+	auto vec = comp6771::euclidean_vector{1.0, 100.0, -3.0};
+
+	SECTION("approx_equal accepts differences within the absolute tolerance test") {
+		CHECK(approx_equal(vec, comp6771::euclidean_vector{1.05, 100.0, -3.05}, 0.1, 0.0));
+		CHECK_FALSE(approx_equal(vec, comp6771::euclidean_vector{1.2, 100.0, -3.0}, 0.1, 0.0));
+	}
+
+	SECTION("approx_equal accepts differences within the relative tolerance test") {
+		CHECK(approx_equal(vec, comp6771::euclidean_vector{1.0, 100.5, -3.0}, 0.0, 0.01));
+		CHECK_FALSE(approx_equal(vec, comp6771::euclidean_vector{1.0, 102.0, -3.0}, 0.0, 0.01));
+	}
+
+	SECTION("approx_equal handles differing dimensions, infinities and NaN test") {
+		auto const inf = std::numeric_limits<double>::infinity();
+		CHECK_FALSE(approx_equal(vec, comp6771::euclidean_vector(2, 1.0), 1.0, 1.0));
+		CHECK(approx_equal(comp6771::euclidean_vector{inf}, comp6771::euclidean_vector{inf}, 0, 0));
+		// An infinity only matches itself, however loose the relative tolerance
+		auto const infinity = comp6771::euclidean_vector{inf};
+		CHECK_FALSE(approx_equal(infinity, comp6771::euclidean_vector{1.0}, 0.0, 1e-9));
+		CHECK_FALSE(approx_equal(comp6771::euclidean_vector{1.0}, infinity, 1.0, 1.0));
+		CHECK_FALSE(approx_equal(infinity, comp6771::euclidean_vector{-inf}, 0.0, 1.0));
+		CHECK_FALSE(approx_equal(comp6771::euclidean_vector{std::nan("")},
+		                         comp6771::euclidean_vector{std::nan("")},
+		                         1.0,
+		                         1.0));
+	}
+
+	SECTION("ulp_equal and ulp_distance count representable steps between elements test") {
+		auto next = comp6771::euclidean_vector{std::nextafter(1.0, 2.0), 100.0, -3.0};
+		CHECK(ulp_distance(vec, next) == 1);
+		CHECK(ulp_equal(vec, next, 1));
+		CHECK_FALSE(ulp_equal(vec, next, 0));
+		CHECK(ulp_distance(comp6771::euclidean_vector{0.0}, comp6771::euclidean_vector{-0.0}) == 0);
+		REQUIRE_THROWS_WITH(ulp_distance(vec, comp6771::euclidean_vector(2)),
+		                    "Dimensions of LHS(3) and RHS(2) do not match");
+	}
+}
+
+TEST_CASE("euclidean_vector find_equal function tests") {
+	auto corpus = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2},
+	                                                      comp6771::euclidean_vector{1, 2, 3},
+	                                                      comp6771::euclidean_vector{2, 1},
+	                                                      comp6771::euclidean_vector{1, 2}};
+
+	CHECK(comp6771::find_equal(corpus, comp6771::euclidean_vector{1, 2})
+	      == std::vector<std::size_t>{0, 3});
+	CHECK(comp6771::find_equal(corpus, comp6771::euclidean_vector{5}).empty());
+}
+
+TEST_CASE("euclidean_vector hash function tests") {
+	auto const hasher = std::hash<comp6771::euclidean_vector>();
+	auto vec = comp6771::euclidean_vector{1.5, -2.5, 3.5, 4.5, 5.5};
+
+	SECTION("equal euclidean_vectors hash alike test") {
+		CHECK(hasher(vec) == hasher(comp6771::euclidean_vector{1.5, -2.5, 3.5, 4.5, 5.5}));
+		CHECK(hasher(comp6771::euclidean_vector{0.0, -0.0}) == hasher(comp6771::euclidean_vector{-0.0, 0.0}));
+	}
+
+	SECTION("differing magnitudes, order and dimensions change the hash test") {
+		CHECK(hasher(vec) != hasher(comp6771::euclidean_vector{1.5, -2.5, 3.5, 4.5, 5.25}));
+		CHECK(hasher(vec) != hasher(comp6771::euclidean_vector{-2.5, 1.5, 3.5, 4.5, 5.5}));
+		CHECK(hasher(comp6771::euclidean_vector(2, 0.0)) != hasher(comp6771::euclidean_vector(3, 0.0)));
+	}
+
+	SECTION("cached hash is refreshed after modification test") {
+		auto const before = hasher(vec);
+		vec[4] = 6.5;
+		CHECK(hasher(vec) == hasher(comp6771::euclidean_vector{1.5, -2.5, 3.5, 4.5, 6.5}));
+		CHECK(hasher(vec) != before);
+		vec *= 2;
+		CHECK(hasher(vec) == hasher(comp6771::euclidean_vector{3, -5, 7, 9, 13}));
+	}
+
+	SECTION("euclidean_vector usable as unordered_map key test") {
+		auto cache = std::unordered_map<comp6771::euclidean_vector, int>();
+		cache[vec] = 1;
+		cache[comp6771::euclidean_vector{1, 2}] = 2;
+
+		CHECK(cache.at(comp6771::euclidean_vector{1.5, -2.5, 3.5, 4.5, 5.5}) == 1);
+		CHECK(cache.at(comp6771::euclidean_vector{1, 2}) == 2);
+		CHECK(cache.count(comp6771::euclidean_vector{2, 1}) == 0);
+	}
+}
+
+TEST_CASE("euclidean_vector distance function tests") {
+	auto v1 = comp6771::euclidean_vector{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+	auto v2 = comp6771::euclidean_vector{1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 7};
+
+	SECTION("distance and squared_distance match euclidean_norm of the difference test") {
+		CHECK(squared_distance(v1, v2) == 25);
+		CHECK(distance(v1, v2) == 5);
+		CHECK(distance(v1, v2) == euclidean_norm(v1 - v2));
+		CHECK(distance(v1, v1) == 0);
+	}
+
+	SECTION("manhattan_distance sums absolute differences test") {
+		CHECK(manhattan_distance(v1, v2) == 7);
+		CHECK(manhattan_distance(comp6771::euclidean_vector{-1, 1}, comp6771::euclidean_vector{1, -1})
+		      == 4);
+	}
+
+	SECTION("chebyshev_distance takes the largest absolute difference test") {
+		CHECK(chebyshev_distance(v1, v2) == 4);
+		CHECK(chebyshev_distance(comp6771::euclidean_vector{-1, 1}, comp6771::euclidean_vector{2, 1})
+		      == 3);
+	}
+
+	SECTION("distance functions on zero dimension euclidean_vectors test") {
+		auto v0 = comp6771::euclidean_vector(0, 0);
+		CHECK(distance(v0, v0) == 0);
+		CHECK(manhattan_distance(v0, v0) == 0);
+		CHECK(chebyshev_distance(v0, v0) == 0);
+	}
+
+	SECTION("distance functions throw for euclidean_vectors of different dimensions test") {
+		auto v3 = comp6771::euclidean_vector(3, 3);
+		REQUIRE_THROWS_WITH(distance(v1, v3), "Dimensions of LHS(11) and RHS(3) do not match");
+		REQUIRE_THROWS_AS(squared_distance(v1, v3), std::invalid_argument);
+		REQUIRE_THROWS_AS(manhattan_distance(v1, v3), std::invalid_argument);
+		REQUIRE_THROWS_AS(chebyshev_distance(v1, v3), std::invalid_argument);
+	}
+}
+
+TEST_CASE("euclidean_vector cosine similarity function tests") {
+	auto v1 = comp6771::euclidean_vector{3, 4};
+	auto v2 = comp6771::euclidean_vector{4, 3};
+
+	SECTION("cosine_similarity matches dot over the product of norms test") {
+		CHECK(cosine_similarity(v1, v2) == Approx(24.0 / 25.0));
+		CHECK(cosine_similarity(v1, v1) == Approx(1.0));
+		CHECK(cosine_similarity(v1, -v1) == Approx(-1.0));
+		CHECK(cosine_similarity(v1, comp6771::euclidean_vector{-4, 3}) == Approx(0.0));
+	}
+
+	SECTION("cosine_similarity fills the norm caches of both operands test") {
+		cosine_similarity(v1, v2);
+		CHECK(euclidean_norm(v1) == 5);
+		CHECK(euclidean_norm(v2) == 5);
+		v2[0] = 0;
+		CHECK(cosine_similarity(v1, v2) == Approx(12.0 / 15.0));
+		CHECK(euclidean_norm(v2) == 3);
+	}
+
+	SECTION("cosine_similarity throws for zero norm and mismatched dimensions test") {
+		REQUIRE_THROWS_WITH(cosine_similarity(v1, comp6771::euclidean_vector(2, 0.0)),
+		                    "euclidean_vector with zero euclidean normal does not have a cosine "
+		                    "similarity");
+		REQUIRE_THROWS_WITH(cosine_similarity(v1, comp6771::euclidean_vector(3, 1.0)),
+		                    "Dimensions of LHS(2) and RHS(3) do not match");
+	}
+
+	SECTION("batched cosine_similarity scores every candidate test") {
+		auto candidates = std::vector<comp6771::euclidean_vector>{v1, v2, comp6771::euclidean_vector{0, 2}};
+		auto const scores = cosine_similarity(v1, candidates);
+
+		REQUIRE(scores.size() == 3);
+		CHECK(scores[0] == Approx(1.0));
+		CHECK(scores[1] == Approx(24.0 / 25.0));
+		CHECK(scores[2] == Approx(4.0 / 5.0));
+	}
+}
+
+TEST_CASE("euclidean_vector scaled euclidean norm tests") {
+	SECTION("euclidean norm of very large magnitudes does not overflow test") {
+		auto vec = comp6771::euclidean_vector{3e200, 4e200};
+		CHECK(euclidean_norm(vec) == Approx(5e200));
+		CHECK(unit(vec).at(0) == Approx(0.6));
+	}
+
+	SECTION("euclidean norm of very small magnitudes does not underflow test") {
+		auto vec = comp6771::euclidean_vector{3e-200, 4e-200};
+		CHECK(euclidean_norm(vec) == Approx(5e-200).epsilon(1e-12));
+		CHECK(unit(vec).at(1) == Approx(0.8));
+	}
+
+	SECTION("euclidean norm of mixed magnitudes test") {
+		auto vec = comp6771::euclidean_vector{1e300, 1.0, 1e-300};
+		CHECK(euclidean_norm(vec) == Approx(1e300));
+	}
+
+	SECTION("euclidean norm propagates infinity and NaN test") {
+		auto const inf = std::numeric_limits<double>::infinity();
+		CHECK(euclidean_norm(comp6771::euclidean_vector{1.0, inf}) == inf);
+		CHECK(std::isnan(euclidean_norm(comp6771::euclidean_vector{1.0, std::nan("")})));
+	}
+}
+
+TEST_CASE("euclidean_vector BLAS-style update function tests") {
+	auto x = comp6771::euclidean_vector{1, 2, 3, 4, 5, 6, 7, 8, 9};
+	auto y = comp6771::euclidean_vector(9, 1.0);
+
+	SECTION("axpy adds a multiple of x to y in place test") {
+		auto& result = axpy(2.0, x, y);
+
+		CHECK(&result == &y);
+		CHECK(y == comp6771::euclidean_vector{3, 5, 7, 9, 11, 13, 15, 17, 19});
+		CHECK(x == comp6771::euclidean_vector{1, 2, 3, 4, 5, 6, 7, 8, 9});
+	}
+
+	SECTION("axpby scales both operands test") {
+		axpby(2.0, x, -3.0, y);
+		CHECK(y == comp6771::euclidean_vector{-1, 1, 3, 5, 7, 9, 11, 13, 15});
+	}
+
+	SECTION("axpy and axpby keep the norm cache up to date test") {
+		CHECK(euclidean_norm(y) == 3);
+		axpy(-1.0, comp6771::euclidean_vector(9, 1.0), y);
+		CHECK(euclidean_norm(y) == 0);
+		axpby(1.0, x, 0.0, y);
+		CHECK(euclidean_norm(y) == euclidean_norm(comp6771::euclidean_vector(x)));
+	}
+
+	SECTION("lincomb combines several euclidean_vectors test") {
+		auto const vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 0},
+		                                                             comp6771::euclidean_vector{0, 1},
+		                                                             comp6771::euclidean_vector{1, 1}};
+		auto const coefficients = std::vector<double>{2, 3, -1};
+		auto out = comp6771::euclidean_vector(2);
+
+		lincomb(coefficients, vectors, out);
+		CHECK(out == comp6771::euclidean_vector{1, 2});
+		CHECK(euclidean_norm(out) == Approx(std::sqrt(5.0)));
+
+		lincomb(std::span<double const>(), std::span<comp6771::euclidean_vector const>(), out);
+		CHECK(out == comp6771::euclidean_vector(2, 0.0));
+	}
+
+	SECTION("lincomb handles an output that is also an input test") {
+		auto vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{1, 2},
+		                                                       comp6771::euclidean_vector{3, 4}};
+		auto const coefficients = std::vector<double>{1, 2};
+
+		lincomb(coefficients, vectors, vectors[1]);
+		CHECK(vectors[1] == comp6771::euclidean_vector{7, 10});
+	}
+
+	SECTION("BLAS-style updates throw for mismatched arguments test") {
+		auto const short_vec = comp6771::euclidean_vector(2);
+		auto const coefficients = std::vector<double>{1};
+		auto const vectors = std::vector<comp6771::euclidean_vector>{x, x};
+
+		REQUIRE_THROWS_WITH(axpy(1.0, short_vec, y), "Dimensions of LHS(2) and RHS(9) do not match");
+		REQUIRE_THROWS_AS(axpby(1.0, short_vec, 1.0, y), std::invalid_argument);
+		REQUIRE_THROWS_WITH(lincomb(coefficients, vectors, y),
+		                    "Number of coefficients(1) and vectors(2) do not match");
+	}
+}
+
+TEST_CASE("euclidean_vector parallel reduction tests") {
+	// Long enough to span several reduction blocks, with a partial block at the end
+	auto const dims = 100003;
+	auto x = comp6771::euclidean_vector(dims);
+	auto y = comp6771::euclidean_vector(dims);
+	for (auto i = 0; i < dims; ++i) {
+		x[i] = std::sin(i * 0.5) * 1e3;
+		y[i] = std::cos(i * 0.25) - 0.5;
+	}
+
+	auto expected_dot = 0.0;
+	for (auto i = 0; i < dims; ++i)
+		expected_dot += x[i] * y[i];
+
+	auto const default_threshold = comp6771::parallel_threshold();
+	CHECK(default_threshold == std::size_t{1} << 20);
+
+	comp6771::set_parallel_threshold(std::numeric_limits<std::size_t>::max());
+	auto const serial_dot = dot(x, y);
+	auto const serial_norm = euclidean_norm(comp6771::euclidean_vector(x));
+	auto const serial_distance = distance(x, y);
+	auto serial_sum = x;
+	serial_sum += y;
+	auto serial_axpy = y;
+	axpy(0.5, x, serial_axpy);
+
+	comp6771::set_parallel_threshold(0);
+	CHECK(comp6771::parallel_threshold() == 0);
+
+	SECTION("parallel reductions match the serial results exactly test") {
+		CHECK(dot(x, y) == Approx(expected_dot));
+		CHECK(dot(x, y) == serial_dot);
+		CHECK(euclidean_norm(comp6771::euclidean_vector(x)) == serial_norm);
+		CHECK(distance(x, y) == serial_distance);
+	}
+
+	SECTION("parallel compound operators and updates match the serial results test") {
+		auto sum = x;
+		sum += y;
+		CHECK(sum == serial_sum);
+		CHECK(euclidean_norm(sum) == euclidean_norm(serial_sum));
+		CHECK(euclidean_norm(sum) == euclidean_norm(comp6771::euclidean_vector(sum)));
+
+		sum -= y;
+		CHECK(approx_equal(sum, x, 1e-12, 1e-12));
+		sum *= 2;
+		CHECK(sum[dims - 1] == 2 * x[dims - 1]);
+
+		auto updated = y;
+		axpy(0.5, x, updated);
+		CHECK(updated == serial_axpy);
+		CHECK(euclidean_norm(updated) == euclidean_norm(serial_axpy));
+	}
+
+	SECTION("parallel equality finds a difference in the last block test") {
+		auto changed = x;
+		CHECK(changed == x);
+		changed[dims - 1] += 1;
+		CHECK(changed != x);
+	}
+
+	comp6771::set_parallel_threshold(default_threshold);
+}
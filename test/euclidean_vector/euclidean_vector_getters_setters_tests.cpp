@@ -89,3 +89,31 @@ TEST_CASE("euclidean_vector setter tests") {
 		CHECK(vec[2] == 3.6);
 	}
 }
+
+TEST_CASE("euclidean_vector index policy tests") {
+	auto vec = comp6771::euclidean_vector{1.6, 2.6, 3.6};
+	auto const& const_vec = vec;
+
+	SECTION("checked policy throws the same error as at()") {
+		REQUIRE_THROWS_AS(vec.at<comp6771::index_policy::checked>(3), std::out_of_range);
+		REQUIRE_THROWS_WITH(const_vec.at<comp6771::index_policy::checked>(-1),
+		                    "Index -1 is not valid for this euclidean_vector object");
+		CHECK(const_vec.at<comp6771::index_policy::checked>(2) == 3.6);
+	}
+
+	SECTION("unchecked and debug_assert policies read and write valid indices") {
+		vec.at<comp6771::index_policy::unchecked>(0) = 1.1;
+		vec.at<comp6771::index_policy::debug_assert>(1) = 2.1;
+
+		CHECK(const_vec.at<comp6771::index_policy::unchecked>(0) == 1.1);
+		CHECK(const_vec.at<comp6771::index_policy::debug_assert>(1) == 2.1);
+		CHECK(vec.at(2) == 3.6);
+	}
+
+	SECTION("writes through a policy accessor invalidate the cached norm") {
+		auto v = comp6771::euclidean_vector{3, 4};
+		CHECK(euclidean_norm(v) == 5);
+		v.at<comp6771::index_policy::unchecked>(1) = 0;
+		CHECK(euclidean_norm(v) == 3);
+	}
+}
@@ -50,7 +50,7 @@ TEST_CASE("euclidean_vector copy assignment overload tests") {
 		CHECK(vec.at(0) == 1.1);
 		CHECK(vec.at(1) == 2.2);
 		CHECK_THROWS(vec.at(2));
-		CHECK(&a1[0] != &vec[0]);
+		CHECK(&v1[0] != &vec[0]);
 	}
 
 	SECTION("copy assignment test between intialised non-zero euclidean_vector and constructor "
@@ -442,3 +442,89 @@ TEST_CASE("euclidean_vector casting to std::list tests") {
 		CHECK(static_cast<std::list<double>>(e_vec) == empty_list);
 	}
 }
+
+TEST_CASE("euclidean_vector releasing to std::vector tests") {
+	SECTION("Non-zero dimension euclidean_vector released without copying") {
+		auto e_vec = comp6771::euclidean_vector{-6, 1};
+		auto const* buffer = &e_vec[0];
+		auto std_vec = std::move(e_vec).release_to_vector();
+
+		CHECK(std_vec == std::vector<double>{-6, 1});
+		CHECK(std_vec.data() == buffer);
+		CHECK(e_vec.dimensions() == 0);
+		CHECK_THROWS(e_vec.at(0));
+	}
+
+	SECTION("rvalue euclidean_vector cast to std::vector moves its buffer") {
+		auto e_vec = comp6771::euclidean_vector{-6, 1};
+		auto const* buffer = &e_vec[0];
+		auto std_vec = static_cast<std::vector<double>>(std::move(e_vec));
+
+		CHECK(std_vec.data() == buffer);
+		CHECK(e_vec.dimensions() == 0);
+	}
+
+	SECTION("round trip through std::vector keeps the same buffer") {
+		auto e_vec = comp6771::euclidean_vector{1.5, 2.5, 3.5};
+		auto const* buffer = &e_vec[0];
+		auto round_trip =
+		   comp6771::euclidean_vector::from(std::move(e_vec).release_to_vector());
+
+		CHECK(round_trip.dimensions() == 3);
+		CHECK(round_trip.at(2) == 3.5);
+		CHECK(&round_trip[0] == buffer);
+	}
+}
+
+TEST_CASE("euclidean_vector normalize tests") {
+	SECTION("normalize scales a euclidean_vector to unit length in place") {
+		auto vec = comp6771::euclidean_vector{3, 4};
+		auto const* buffer = &vec[0];
+		auto* const result = &vec.normalize();
+
+		CHECK(result == &vec);
+		CHECK(&vec[0] == buffer);
+		CHECK(vec.at(0) == Approx(0.6));
+		CHECK(vec.at(1) == Approx(0.8));
+		CHECK(euclidean_norm(vec) == 1);
+	}
+
+	SECTION("normalize agrees with unit") {
+		auto vec = comp6771::euclidean_vector{1, 2, 2, 2, 6, 1, 1, 1, 1, 3};
+		auto const expected = unit(vec);
+		vec.normalize();
+
+		CHECK(approx_equal(vec, expected, 0.0, 1e-15));
+	}
+
+	SECTION("normalize agrees with unit for a subnormal norm") {
+		auto vec = comp6771::euclidean_vector{1e-310, 0.0};
+		vec.normalize();
+
+		CHECK(vec == comp6771::euclidean_vector{1.0, 0.0});
+		CHECK(vec == unit(comp6771::euclidean_vector{1e-310, 0.0}));
+		CHECK(euclidean_norm(vec) == 1);
+	}
+
+	SECTION("normalize throws like unit for zero dimension and zero norm euclidean_vectors") {
+		auto v0 = comp6771::euclidean_vector(0, 0);
+		auto zeros = comp6771::euclidean_vector(3, 0.0);
+
+		REQUIRE_THROWS_WITH(v0.normalize(),
+		                    "euclidean_vector with no dimensions does not have a unit vector");
+		REQUIRE_THROWS_WITH(zeros.normalize(),
+		                    "euclidean_vector with zero euclidean normal does not have a unit "
+		                    "vector");
+	}
+
+	SECTION("normalize_all normalizes every euclidean_vector in a collection") {
+		auto vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector{3, 4},
+		                                                       comp6771::euclidean_vector{0, 2},
+		                                                       comp6771::euclidean_vector{5}};
+		comp6771::normalize_all(vectors);
+
+		CHECK(vectors[0].at(0) == Approx(0.6));
+		CHECK(vectors[1].at(1) == 1);
+		CHECK(vectors[2].at(0) == 1);
+	}
+}
@@ -0,0 +1,204 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/hnsw_index.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+Testing rationale
+
+HNSW is approximate, so it is judged by its mean recall@10 against brute_force_knn rather than by
+exact answers, for both metrics and for indexes built serially and in parallel. The thresholds are
+well below what the default parameters reach on this data, so the tests only fail when the graph
+is genuinely broken. Saving and loading must give back an index that answers identically and keeps
+accepting insertions. Exact answers are still expected where the answer is unambiguous: a stored
+vector must find itself.
+*/
+namespace {
+	auto make_corpus(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto mean_recall(comp6771::hnsw_index const& index,
+	                 std::vector<comp6771::euclidean_vector> const& corpus,
+	                 std::vector<comp6771::euclidean_vector> const& queries,
+	                 std::size_t k) -> double {
+		auto total = 0.0;
+		for (auto const& query : queries) {
+			auto const exact = comp6771::brute_force_knn(corpus, query, k, index.metric());
+			total += comp6771::recall(index.search(query, k), exact);
+		}
+		return total / static_cast<double>(queries.size());
+	}
+} // namespace
+
+TEST_CASE("Empty index") {
+	auto const index = comp6771::hnsw_index(4);
+	CHECK(index.size() == 0);
+	CHECK(index.dimensions() == 4);
+	CHECK(index.search(comp6771::euclidean_vector(4), 5).empty());
+}
+
+TEST_CASE("Parameters are validated") {
+	CHECK_THROWS_AS(comp6771::hnsw_index(4, comp6771::search_metric::l2, {.m = 1}),
+	                std::invalid_argument);
+
+	auto index = comp6771::hnsw_index(2);
+	CHECK_THROWS_WITH(index.add(comp6771::euclidean_vector{1, 2, 3}),
+	                  "Dimensions of LHS(2) and RHS(3) do not match");
+	CHECK(index.size() == 0);
+	index.add(comp6771::euclidean_vector{1, 2});
+	CHECK_THROWS_WITH(index.search(comp6771::euclidean_vector{1}, 1),
+	                  "Dimensions of LHS(2) and RHS(1) do not match");
+}
+
+TEST_CASE("Single insertions") {
+	auto index = comp6771::hnsw_index(2);
+	CHECK(index.add(comp6771::euclidean_vector{0, 0}) == 0);
+	CHECK(index.add(comp6771::euclidean_vector{3, 4}) == 1);
+	CHECK(index.add(comp6771::euclidean_vector{10, 10}) == 2);
+	CHECK(index.size() == 3);
+	CHECK(index.view(1)[1] == 4);
+
+	auto const found = index.search(comp6771::euclidean_vector{0, 0}, 2);
+	REQUIRE(found.size() == 2);
+	CHECK(found[0] == comp6771::neighbour{0, 0.0});
+	CHECK(found[1] == comp6771::neighbour{1, 5.0});
+}
+
+TEST_CASE("Recall against brute force") {
+	auto const corpus = make_corpus(2000, 16, 1);
+	auto const queries = make_corpus(50, 16, 2);
+	auto const parameters = comp6771::hnsw_parameters{.m = 12, .ef_construction = 100};
+
+	SECTION("L2, built one vector at a time") {
+		auto index = comp6771::hnsw_index(16, comp6771::search_metric::l2, parameters);
+		for (auto const& v : corpus)
+			index.add(v);
+		CHECK(mean_recall(index, corpus, queries, 10) >= 0.9);
+
+		// Every stored vector finds itself
+		for (auto id = std::size_t{0}; id < corpus.size(); id += 97)
+			CHECK(index.search(corpus[id], 1).front() == comp6771::neighbour{id, 0.0});
+	}
+
+	SECTION("L2, built in parallel") {
+		auto pool = comp6771::thread_pool(4);
+		auto index = comp6771::hnsw_index(16, comp6771::search_metric::l2, parameters);
+		index.reserve(corpus.size());
+		CHECK(index.add_all(std::span(corpus).first(500), pool) == 0);
+		CHECK(index.add_all(std::span(corpus).subspan(500), pool) == 500);
+		REQUIRE(index.size() == corpus.size());
+		CHECK(mean_recall(index, corpus, queries, 10) >= 0.9);
+	}
+
+	SECTION("Inner product") {
+		auto index = comp6771::hnsw_index(16, comp6771::search_metric::inner_product, parameters);
+		index.add_all(corpus);
+		CHECK(mean_recall(index, corpus, queries, 10) >= 0.85);
+
+		auto const found = index.search(queries[0], 3);
+		REQUIRE(found.size() == 3);
+		CHECK(found[0].distance == Approx(-dot(corpus[found[0].id], queries[0])));
+	}
+
+	SECTION("A larger ef does not lower recall") {
+		auto index = comp6771::hnsw_index(16, comp6771::search_metric::l2, parameters);
+		index.add_all(corpus);
+		index.set_ef_search(10);
+		auto const narrow = mean_recall(index, corpus, queries, 10);
+		index.set_ef_search(200);
+		auto const wide = mean_recall(index, corpus, queries, 10);
+		CHECK(wide >= narrow);
+		CHECK(wide >= 0.95);
+	}
+}
+
+TEST_CASE("Save and load") {
+	auto const corpus = make_corpus(600, 8, 3);
+	auto const queries = make_corpus(10, 8, 4);
+	auto const path = std::string("hnsw_index_tests.bin");
+
+	auto original = comp6771::hnsw_index(8, comp6771::search_metric::l2, {.m = 8, .seed = 7});
+	original.add_all(std::span(corpus).first(400));
+	original.save(path);
+	auto loaded = comp6771::hnsw_index::load(path);
+
+	CHECK(loaded.size() == original.size());
+	CHECK(loaded.dimensions() == 8);
+	CHECK(loaded.metric() == comp6771::search_metric::l2);
+	CHECK(loaded.parameters().m == 8);
+	for (auto const& query : queries)
+		CHECK(loaded.search(query, 5) == original.search(query, 5));
+
+	// Both continue with the same level generator, so single insertions keep them identical
+	for (auto const& v : std::span(corpus).subspan(400)) {
+		original.add(v);
+		loaded.add(v);
+	}
+	for (auto const& query : queries)
+		CHECK(loaded.search(query, 5) == original.search(query, 5));
+
+	SECTION("Files with out-of-range levels or links are rejected") {
+		auto const saved = [&] {
+			auto in = std::ifstream(path, std::ios::binary);
+			return std::string(std::istreambuf_iterator<char>(in), {});
+		}();
+		auto const write = [&](std::string const& contents) {
+			auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+			out << contents;
+		};
+		auto const patch = [&](std::size_t offset, std::uint32_t value) {
+			auto contents = saved;
+			std::memcpy(contents.data() + offset, &value, sizeof(value));
+			write(contents);
+		};
+
+		// magic, version, dimensions, metric, parameters, entry point and max level, then the
+		// levels and the layer 0 links, each preceded by a 64-bit size
+		auto const levels = 4 + 4 + sizeof(int) + sizeof(comp6771::search_metric)
+		                    + sizeof(comp6771::hnsw_parameters) + 4 + sizeof(int) + 8;
+		auto const base_links = levels + 400 * sizeof(int) + 8;
+		REQUIRE_NOTHROW(comp6771::hnsw_index::load(path));
+
+		// Vector 0's first neighbour
+		patch(base_links + 4, 400);
+		CHECK_THROWS_AS(comp6771::hnsw_index::load(path), std::runtime_error);
+		// More neighbours than a vector may have
+		patch(base_links, 17);
+		CHECK_THROWS_AS(comp6771::hnsw_index::load(path), std::runtime_error);
+		// A level that does not match the stored upper layers
+		patch(levels, 50);
+		CHECK_THROWS_AS(comp6771::hnsw_index::load(path), std::runtime_error);
+	}
+
+	SECTION("Files that are not an index are rejected") {
+		{
+			auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+			out << "not an index";
+		}
+		CHECK_THROWS_AS(comp6771::hnsw_index::load(path), std::runtime_error);
+		CHECK_THROWS_AS(comp6771::hnsw_index::load("does/not/exist.bin"), std::runtime_error);
+	}
+	std::remove(path.c_str());
+}
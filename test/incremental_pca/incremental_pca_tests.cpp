@@ -0,0 +1,198 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/incremental_pca.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+/*
+Testing rationale
+
+Samples drawn from a low-rank distribution have components that are known exactly, so the
+incremental update can be checked without a reference decomposition: the components must span
+the subspace, reconstruct every sample, and be the same whether the stream arrives one sample at
+a time or in batches of any size. Both ways of solving an update are exercised, with batches
+smaller and larger than the dimensions. With noise added and fewer components than the data's
+rank, the leading directions must still be recovered. The mean, explained variance and the
+batched transform are checked against direct computation, and partial results before the data
+spans enough directions are checked too.
+*/
+namespace {
+	// `rank` orthonormal directions
+	auto make_basis(int dimensions, int rank, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto basis = std::vector<comp6771::euclidean_vector>();
+		while (static_cast<int>(basis.size()) < rank) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			for (auto const& b : basis)
+				axpy(-dot(b, v), b, v);
+			v /= euclidean_norm(v);
+			basis.push_back(v);
+		}
+		return basis;
+	}
+
+	// centre + sum of basis[j] * N(0, spread[j]), plus N(0, noise) in every dimension
+	auto make_samples(std::vector<comp6771::euclidean_vector> const& basis,
+	                  std::vector<double> const& spread,
+	                  double centre,
+	                  double noise,
+	                  std::size_t count,
+	                  unsigned seed) -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto const dimensions = basis.front().dimensions();
+		auto samples = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions, centre);
+			for (auto j = std::size_t{0}; j < basis.size(); ++j)
+				axpy(spread[j] * value(random), basis[j], v);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] += noise * value(random);
+			samples.push_back(v);
+		}
+		return samples;
+	}
+
+	auto fit(int dimensions,
+	         std::size_t components,
+	         std::span<comp6771::euclidean_vector const> samples,
+	         std::size_t batch) -> comp6771::incremental_pca {
+		auto pca = comp6771::incremental_pca(dimensions, components);
+		for (auto first = std::size_t{0}; first < samples.size(); first += batch)
+			pca.partial_fit(samples.subspan(first, std::min(batch, samples.size() - first)));
+		return pca;
+	}
+
+	void check_orthonormal(std::span<comp6771::euclidean_vector const> components) {
+		for (auto i = std::size_t{0}; i < components.size(); ++i)
+			for (auto j = std::size_t{0}; j < components.size(); ++j)
+				CHECK(dot(components[i], components[j]) == Approx(i == j ? 1.0 : 0.0).margin(1e-9));
+	}
+} // namespace
+
+TEST_CASE("Construction is validated") {
+	CHECK_THROWS_AS(comp6771::incremental_pca(0, 1), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::incremental_pca(4, 0), std::invalid_argument);
+	CHECK_THROWS_WITH(comp6771::incremental_pca(4, 5),
+	                  "Number of components(5) must be between 1 and the dimensions(4)");
+
+	auto pca = comp6771::incremental_pca(4, 2);
+	CHECK(pca.dimensions() == 4);
+	CHECK(pca.max_components() == 2);
+	CHECK(pca.samples_seen() == 0);
+	CHECK(pca.components().empty());
+	CHECK_THROWS_WITH(pca.partial_fit(comp6771::euclidean_vector(3)),
+	                  "Dimensions of LHS(4) and RHS(3) do not match");
+	CHECK_THROWS_WITH(pca.transform(comp6771::euclidean_vector(5)),
+	                  "Dimensions of LHS(4) and RHS(5) do not match");
+}
+
+TEST_CASE("Components appear as the data spans more directions") {
+	auto const basis = make_basis(6, 3, 1);
+	auto const samples = make_samples(basis, {3.0, 2.0, 1.0}, 5.0, 0.0, 4, 2);
+	auto pca = comp6771::incremental_pca(6, 3);
+
+	pca.partial_fit(samples[0]);
+	CHECK(pca.samples_seen() == 1);
+	CHECK(pca.components().empty());
+	CHECK(pca.transform(samples[0]).dimensions() == 0);
+	CHECK(pca.inverse_transform(comp6771::euclidean_vector(0)) == samples[0]);
+
+	pca.partial_fit(samples[1]);
+	CHECK(pca.components().size() == 1);
+	pca.partial_fit(std::span(samples).subspan(2));
+	CHECK(pca.components().size() == 3);
+	CHECK(pca.explained_variance().size() == 3);
+}
+
+TEST_CASE("Low-rank data is decomposed exactly") {
+	SECTION("as the stream is split") {
+		// 8 dimensions take the scatter-matrix path for large batches; 120 take the Gram path
+		auto const dimensions = GENERATE(8, 120);
+		auto const basis = make_basis(dimensions, 3, 3);
+		auto const samples = make_samples(basis, {5.0, 2.0, 0.5}, -1.0, 0.0, 300, 4);
+
+		auto const reference = fit(dimensions, 3, samples, samples.size());
+		REQUIRE(reference.components().size() == 3);
+		check_orthonormal(reference.components());
+		for (auto const& v : samples)
+			CHECK(approx_equal(reference.inverse_transform(reference.transform(v)), v, 1e-9, 1e-9));
+
+		auto mean = comp6771::euclidean_vector(dimensions);
+		for (auto const& v : samples)
+			axpy(1.0 / static_cast<double>(samples.size()), v, mean);
+		CHECK(approx_equal(reference.mean(), mean, 1e-12, 1e-12));
+
+		for (auto const batch : {std::size_t{1}, std::size_t{7}, std::size_t{100}}) {
+			auto const pca = fit(dimensions, 3, samples, batch);
+			CHECK(pca.samples_seen() == samples.size());
+			REQUIRE(pca.components().size() == 3);
+			for (auto i = std::size_t{0}; i < 3; ++i) {
+				CHECK(approx_equal(pca.components()[i], reference.components()[i], 1e-8, 1e-8));
+				CHECK(pca.singular_values()[i] == Approx(reference.singular_values()[i]));
+			}
+			CHECK(approx_equal(pca.mean(), mean, 1e-12, 1e-12));
+		}
+	}
+
+	SECTION("with the variance of each coordinate") {
+		auto const basis = make_basis(10, 2, 5);
+		auto const samples = make_samples(basis, {4.0, 1.0}, 2.0, 0.0, 200, 6);
+		auto const pca = fit(10, 3, samples, 16);
+		// The third component asked for does not exist in rank-2 data
+		REQUIRE(pca.components().size() == 2);
+
+		auto const variance = pca.explained_variance();
+		auto const ratio = pca.explained_variance_ratio();
+		CHECK(variance[0] > variance[1]);
+		CHECK(ratio[0] + ratio[1] == Approx(1.0));
+		for (auto i = 0; i < 2; ++i) {
+			auto sum_of_squares = 0.0;
+			for (auto const& v : samples)
+				sum_of_squares += std::pow(pca.transform(v)[i], 2);
+			CHECK(variance[static_cast<std::size_t>(i)]
+			      == Approx(sum_of_squares / static_cast<double>(samples.size() - 1)));
+		}
+	}
+}
+
+TEST_CASE("Leading directions are recovered from noisy data") {
+	auto const basis = make_basis(60, 4, 7);
+	auto const samples = make_samples(basis, {8.0, 5.0, 3.0, 2.0}, 0.5, 0.05, 2000, 8);
+	auto const pca = fit(60, 3, samples, 50);
+	REQUIRE(pca.components().size() == 3);
+	check_orthonormal(pca.components());
+	for (auto i = std::size_t{0}; i < 3; ++i)
+		CHECK(std::abs(dot(pca.components()[i], basis[i])) > 0.99);
+
+	auto const variance = pca.explained_variance();
+	CHECK(variance[0] == Approx(64.0).epsilon(0.1));
+	CHECK(variance[1] == Approx(25.0).epsilon(0.1));
+	CHECK(variance[2] == Approx(9.0).epsilon(0.1));
+}
+
+TEST_CASE("transform_all matches transform") {
+	auto pool = comp6771::thread_pool(4);
+	auto const basis = make_basis(8, 4, 9);
+	auto const samples = make_samples(basis, {4.0, 3.0, 2.0, 1.0}, 1.0, 0.1, 1100, 10);
+	auto pca = comp6771::incremental_pca(8, 3);
+	pca.partial_fit(samples, pool);
+
+	// More than one gemm block
+	auto const projected = pca.transform_all(samples, pool);
+	REQUIRE(projected.size() == samples.size());
+	for (auto i = std::size_t{0}; i < samples.size(); ++i)
+		CHECK(approx_equal(projected[i], pca.transform(samples[i]), 1e-12, 1e-12));
+
+	CHECK(comp6771::incremental_pca(8, 2).transform_all(samples).front().dimensions() == 0);
+}
@@ -0,0 +1,180 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/ivf_index.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+Probing every list must make a flat IVF index exact, which pins down the list bookkeeping and the
+top-k merge against brute_force_knn. With fewer probes the index is judged by recall on clustered
+data, where the coarse quantizer has real structure to find. Residual codes are tested for recall
+only, since their distances are estimates, and are scanned on a pool to check that the probes
+share nothing but the read-only query. Results must not depend on the pool size, and vectors
+added in several batches must be filed exactly as one batch would be.
+*/
+namespace {
+	// `count` vectors around 20 random centres
+	auto make_clustered(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto centre_value = std::uniform_real_distribution<double>(-10.0, 10.0);
+		auto noise = std::normal_distribution<double>(0.0, 1.0);
+		auto centres = std::vector<comp6771::euclidean_vector>();
+		for (auto c = 0; c < 20; ++c) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = centre_value(random);
+			centres.push_back(v);
+		}
+
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = centres[i % centres.size()];
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] += noise(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto mean_recall(comp6771::ivf_index const& index,
+	                 std::vector<comp6771::euclidean_vector> const& corpus,
+	                 std::vector<comp6771::euclidean_vector> const& queries,
+	                 std::size_t k) -> double {
+		auto total = 0.0;
+		for (auto const& query : queries) {
+			auto const exact = comp6771::brute_force_knn(corpus, query, k, index.metric());
+			total += comp6771::recall(index.search(query, k), exact);
+		}
+		return total / static_cast<double>(queries.size());
+	}
+} // namespace
+
+TEST_CASE("Training and adding") {
+	auto const corpus = make_clustered(2000, 8, 1);
+	auto index = comp6771::ivf_index::train(corpus, comp6771::search_metric::l2, {.lists = 16});
+	CHECK(index.size() == 0);
+	CHECK(index.dimensions() == 8);
+	CHECK(index.centroids().size() == 16);
+
+	CHECK(index.add_all(std::span(corpus).first(1500)) == 0);
+	CHECK(index.add(corpus[1500]) == 1500);
+	CHECK(index.add_all(std::span(corpus).subspan(1501)) == 1501);
+	REQUIRE(index.size() == corpus.size());
+
+	auto total = std::size_t{0};
+	for (auto list = std::size_t{0}; list < 16; ++list)
+		total += index.list_size(list);
+	CHECK(total == corpus.size());
+
+	CHECK_THROWS_WITH(index.add(comp6771::euclidean_vector(3)),
+	                  "Dimensions of LHS(8) and RHS(3) do not match");
+	CHECK_THROWS_WITH(index.search(comp6771::euclidean_vector(3), 1),
+	                  "Dimensions of LHS(8) and RHS(3) do not match");
+	CHECK_THROWS_AS(comp6771::ivf_index::train({}), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::ivf_index::train(std::span(corpus).first(10),
+	                                           comp6771::search_metric::l2,
+	                                           {.lists = 11}),
+	                std::invalid_argument);
+}
+
+TEST_CASE("Probing every list is exact") {
+	auto const corpus = make_clustered(3000, 12, 2);
+	auto const queries = make_clustered(20, 12, 3);
+	auto const metric = GENERATE(comp6771::search_metric::l2,
+	                             comp6771::search_metric::inner_product);
+	auto index = comp6771::ivf_index::train(std::span(corpus).first(1000), metric, {.lists = 32});
+	index.add_all(corpus);
+
+	auto pool = comp6771::thread_pool(4);
+	for (auto const& query : queries) {
+		auto const exact = comp6771::brute_force_knn(corpus, query, 10, metric);
+		auto const found = index.search(query, 10, 32, pool);
+		REQUIRE(found.size() == exact.size());
+		for (auto i = std::size_t{0}; i < found.size(); ++i) {
+			CHECK(found[i].id == exact[i].id);
+			CHECK(found[i].distance == Approx(exact[i].distance));
+		}
+		CHECK(index.search(query, 10, 32, comp6771::default_thread_pool()) == found);
+	}
+}
+
+TEST_CASE("Recall with few probes") {
+	auto const corpus = make_clustered(4000, 16, 4);
+	auto const queries = make_clustered(40, 16, 5);
+
+	SECTION("Full vectors") {
+		auto index = comp6771::ivf_index::train(corpus,
+		                                        comp6771::search_metric::l2,
+		                                        {.lists = 40, .nprobe = 4});
+		index.add_all(corpus);
+		CHECK(mean_recall(index, corpus, queries, 10) >= 0.9);
+	}
+
+	// Fewer k-means iterations keep the residual quantizer quick to train
+	auto const quick = comp6771::kmeans_options{.max_iterations = 10};
+
+	SECTION("Residual codes") {
+		auto index = comp6771::ivf_index::train(
+		   std::span(corpus).first(2000),
+		   comp6771::search_metric::l2,
+		   {.lists = 40, .nprobe = 4, .code_size = 8, .kmeans = quick});
+		index.add_all(corpus);
+		auto const coded = mean_recall(index, corpus, queries, 10);
+		CHECK(coded >= 0.5);
+
+		index.set_nprobe(40);
+		CHECK(mean_recall(index, corpus, queries, 10) >= coded);
+	}
+
+	SECTION("Residual codes with inner product") {
+		auto index = comp6771::ivf_index::train(
+		   std::span(corpus).first(2000),
+		   comp6771::search_metric::inner_product,
+		   {.lists = 20, .nprobe = 20, .code_size = 8, .kmeans = quick});
+		index.add_all(corpus);
+		CHECK(mean_recall(index, corpus, queries, 10) >= 0.5);
+	}
+}
+
+TEST_CASE("Batches are filed as a single batch would be") {
+	auto const corpus = make_clustered(1000, 6, 6);
+	auto const queries = make_clustered(10, 6, 7);
+	auto const parameters = comp6771::ivf_parameters{.lists = 10, .nprobe = 3, .code_size = 3};
+	auto whole = comp6771::ivf_index::train(corpus, comp6771::search_metric::l2, parameters);
+	auto pieces = whole;
+	whole.add_all(corpus);
+
+	auto pool = comp6771::thread_pool(3);
+	for (auto first = std::size_t{0}; first < corpus.size(); first += 170)
+		pieces.add_all(std::span(corpus).subspan(first, std::min<std::size_t>(170, 1000 - first)),
+		               pool);
+
+	for (auto list = std::size_t{0}; list < 10; ++list)
+		CHECK(whole.list_size(list) == pieces.list_size(list));
+	for (auto const& query : queries)
+		CHECK(whole.search(query, 5) == pieces.search(query, 5, pool));
+}
+
+TEST_CASE("Residual codes are scanned in parallel without sharing the query's state") {
+	// Each probed list forms its own residual from the one query, so a pool must give the same
+	// estimates as a serial scan
+	auto const corpus = make_clustered(1000, 8, 8);
+	auto const queries = make_clustered(10, 8, 9);
+	auto const parameters = comp6771::ivf_parameters{.lists = 10, .nprobe = 10, .code_size = 4};
+	auto serial = comp6771::thread_pool(1);
+	auto pool = comp6771::thread_pool(4);
+	for (auto const metric : {comp6771::search_metric::l2, comp6771::search_metric::inner_product}) {
+		auto index = comp6771::ivf_index::train(corpus, metric, parameters);
+		index.add_all(corpus);
+		for (auto const& query : queries)
+			CHECK(index.search(query, 5, pool) == index.search(query, 5, serial));
+	}
+}
@@ -0,0 +1,169 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/kmeans.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <random>
+#include <set>
+#include <vector>
+
+/*
+Testing rationale
+
+Seeding is tested first, since every clustering test depends on it. Clustering is then checked on
+well separated blobs, where the answer is known, and on unstructured data, where every vector must
+end up assigned to its nearest final centroid despite the pruned assignment steps. Results are
+compared across pool sizes to confirm they do not depend on the thread count. Mini-batch mode is
+fed the blobs in small batches and must recover the same centres.
+*/
+namespace {
+	auto const blob_centres = std::vector<comp6771::euclidean_vector>{
+	   comp6771::euclidean_vector{0, 0, 0},
+	   comp6771::euclidean_vector{20, 20, 0},
+	   comp6771::euclidean_vector{-20, 20, 5}};
+
+	// `per_blob` vectors scattered uniformly within 1 of each blob centre, interleaved by blob
+	auto make_blobs(std::size_t per_blob, unsigned seed) -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto offset = std::uniform_real_distribution<double>(-1.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < per_blob; ++i)
+			for (auto const& centre : blob_centres) {
+				auto v = centre;
+				for (auto d = 0; d < v.dimensions(); ++d)
+					v[d] += offset(random);
+				vectors.push_back(v);
+			}
+		return vectors;
+	}
+
+	auto make_noise(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::uniform_real_distribution<double>(-5.0, 5.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	// Index of the blob centre nearest to `v`
+	auto blob_of(comp6771::euclidean_vector const& v) -> std::size_t {
+		return comp6771::nearest_centroid(blob_centres, v);
+	}
+} // namespace
+
+TEST_CASE("kmeans_plus_plus tests") {
+	auto const data = make_blobs(50, 1);
+
+	SECTION("kmeans_plus_plus picks one vector from each well separated blob") {
+		auto const centroids = comp6771::kmeans_plus_plus(data, 3, 42);
+		REQUIRE(centroids.size() == 3);
+		auto blobs = std::set<std::size_t>();
+		for (auto const& c : centroids)
+			blobs.insert(blob_of(c));
+		CHECK(blobs.size() == 3);
+	}
+
+	SECTION("kmeans_plus_plus is reproducible from its seed") {
+		auto single = comp6771::thread_pool(1);
+		auto several = comp6771::thread_pool(4);
+		CHECK(comp6771::kmeans_plus_plus(data, 5, 7, single)
+		      == comp6771::kmeans_plus_plus(data, 5, 7, several));
+	}
+
+	SECTION("kmeans_plus_plus handles duplicates and rejects a bad cluster count") {
+		auto const same = std::vector<comp6771::euclidean_vector>(4, comp6771::euclidean_vector{1, 2});
+		CHECK(comp6771::kmeans_plus_plus(same, 3, 0).size() == 3);
+		REQUIRE_THROWS_WITH(comp6771::kmeans_plus_plus(same, 5, 0),
+		                    "Number of clusters(5) must be between 1 and the number of vectors(4)");
+		REQUIRE_THROWS_AS(comp6771::kmeans_plus_plus(same, 0, 0), std::invalid_argument);
+	}
+}
+
+TEST_CASE("kmeans tests") {
+	SECTION("kmeans recovers well separated blobs") {
+		auto const data = make_blobs(200, 2);
+		auto const result = comp6771::kmeans(data, 3);
+
+		CHECK(result.converged);
+		CHECK(result.assignments.size() == data.size());
+		for (auto const& c : result.centroids)
+			CHECK(distance(c, blob_centres[blob_of(c)]) < 0.2);
+		for (auto i = std::size_t{0}; i < data.size(); ++i)
+			CHECK(blob_of(result.centroids[result.assignments[i]]) == blob_of(data[i]));
+		CHECK(result.inertia < static_cast<double>(data.size()) * 3);
+	}
+
+	SECTION("kmeans assigns every vector to its nearest centroid") {
+		auto const data = make_noise(3000, 6, 3);
+		auto const result = comp6771::kmeans(data, 12, {.max_iterations = 500, .seed = 5});
+
+		CHECK(result.converged);
+		auto mismatches = 0;
+		auto inertia = 0.0;
+		for (auto i = std::size_t{0}; i < data.size(); ++i) {
+			mismatches += comp6771::nearest_centroid(result.centroids, data[i]) != result.assignments[i];
+			inertia += squared_distance(data[i], result.centroids[result.assignments[i]]);
+		}
+		CHECK(mismatches == 0);
+		CHECK(result.inertia == Approx(inertia));
+	}
+
+	SECTION("kmeans gives the same result on any pool") {
+		auto const data = make_noise(2500, 4, 4);
+		auto single = comp6771::thread_pool(1);
+		auto several = comp6771::thread_pool(3);
+		auto const a = comp6771::kmeans(data, 6, {.seed = 9}, single);
+		auto const b = comp6771::kmeans(data, 6, {.seed = 9}, several);
+
+		CHECK(a.centroids == b.centroids);
+		CHECK(a.assignments == b.assignments);
+		CHECK(a.iterations == b.iterations);
+	}
+
+	SECTION("kmeans stops at the iteration limit or tolerance") {
+		auto const data = make_noise(500, 3, 6);
+		auto const limited = comp6771::kmeans(data, 10, {.max_iterations = 1});
+		CHECK(limited.iterations == 1);
+
+		auto const loose = comp6771::kmeans(data, 10, {.tolerance = 1e6});
+		CHECK(loose.iterations == 1);
+		CHECK(loose.converged);
+	}
+
+	SECTION("kmeans throws for mismatched dimensions") {
+		auto data = make_noise(10, 3, 7);
+		data.push_back(comp6771::euclidean_vector(2));
+		REQUIRE_THROWS_WITH(comp6771::kmeans(data, 2), "Dimensions of LHS(3) and RHS(2) do not match");
+	}
+}
+
+TEST_CASE("minibatch_kmeans tests") {
+	auto const data = make_blobs(300, 8);
+	auto model = comp6771::minibatch_kmeans(3, 11);
+	CHECK(model.centroids().empty());
+	REQUIRE_THROWS_AS(model.predict(data[0]), std::invalid_argument);
+
+	auto pool = comp6771::thread_pool(2);
+	auto const all = std::span<comp6771::euclidean_vector const>(data);
+	for (auto first = std::size_t{0}; first < data.size(); first += 60)
+		model.partial_fit(all.subspan(first, std::min(std::size_t{60}, data.size() - first)), pool);
+
+	REQUIRE(model.centroids().size() == 3);
+	auto blobs = std::set<std::size_t>();
+	for (auto const& c : model.centroids()) {
+		blobs.insert(blob_of(c));
+		CHECK(distance(c, blob_centres[blob_of(c)]) < 0.5);
+	}
+	CHECK(blobs.size() == 3);
+	CHECK(blob_of(model.centroids()[model.predict(blob_centres[1])]) == 1);
+	REQUIRE_THROWS_AS(model.partial_fit(std::vector<comp6771::euclidean_vector>{
+	                     comp6771::euclidean_vector(5)}),
+	                  std::invalid_argument);
+}
@@ -0,0 +1,338 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/krylov.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+Each solver is judged by the true residual ||b - A x|| of the x it returns, on a symmetric
+positive definite system (the 1D Poisson matrix) and, for the solvers that allow it, a
+nonsymmetric one (1D convection-diffusion). GMRES is also run with a restart length short enough
+to force several restarts, and with one long enough to solve exactly. The edge cases are an exact
+initial guess, a zero right-hand side, running out of iterations, a breakdown on an indefinite
+matrix, and invalid arguments. The promise that solves allocate nothing once a workspace has been
+sized is checked by counting calls to operator new.
+*/
+// Every form of operator new and delete is replaced, so that each allocation is counted and is
+// released by the allocator that made it
+namespace {
+	std::atomic<bool> counting_allocations = false;
+	std::atomic<std::size_t> allocations = 0;
+
+	auto allocate(std::size_t size, std::size_t alignment) noexcept -> void* {
+		if (counting_allocations)
+			++allocations;
+		size = std::max(size, std::size_t{1});
+		if (alignment <= alignof(std::max_align_t))
+			return std::malloc(size);
+		// aligned_alloc needs a size that is a multiple of the alignment
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	}
+
+	auto allocate_or_throw(std::size_t size, std::size_t alignment) -> void* {
+		if (auto* const p = allocate(size, alignment))
+			return p;
+		throw std::bad_alloc();
+	}
+
+	auto alignment_of(std::align_val_t alignment) noexcept -> std::size_t {
+		return static_cast<std::size_t>(alignment);
+	}
+} // namespace
+
+auto operator new(std::size_t size) -> void* {
+	return allocate_or_throw(size, 0);
+}
+
+auto operator new[](std::size_t size) -> void* {
+	return allocate_or_throw(size, 0);
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+	return allocate_or_throw(size, alignment_of(alignment));
+}
+
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void* {
+	return allocate_or_throw(size, alignment_of(alignment));
+}
+
+auto operator new(std::size_t size, std::nothrow_t const&) noexcept -> void* {
+	return allocate(size, 0);
+}
+
+auto operator new[](std::size_t size, std::nothrow_t const&) noexcept -> void* {
+	return allocate(size, 0);
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+   -> void* {
+	return allocate(size, alignment_of(alignment));
+}
+
+auto operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+   -> void* {
+	return allocate(size, alignment_of(alignment));
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept {
+	std::free(p);
+}
+
+namespace {
+	// Tridiagonal with constant diagonals, applied without allocating
+	auto tridiagonal(double lower, double diagonal, double upper) -> comp6771::linear_operator {
+		return [=](comp6771::euclidean_vector const& x, comp6771::euclidean_vector& y) {
+			auto const n = x.dimensions();
+			auto const* const in = x.data();
+			auto* const out = y.mutable_data();
+			for (auto i = 0; i < n; ++i) {
+				out[i] = diagonal * in[i];
+				if (i > 0)
+					out[i] += lower * in[i - 1];
+				if (i + 1 < n)
+					out[i] += upper * in[i + 1];
+			}
+		};
+	}
+
+	auto const poisson = tridiagonal(-1.0, 2.0, -1.0);
+	auto const convection_diffusion = tridiagonal(-1.5, 4.0, -0.5);
+
+	auto make_vector(int dimensions, unsigned seed) -> comp6771::euclidean_vector {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto v = comp6771::euclidean_vector(dimensions);
+		for (auto d = 0; d < dimensions; ++d)
+			v[d] = value(random);
+		return v;
+	}
+
+	auto true_residual(comp6771::linear_operator const& a,
+	                   comp6771::euclidean_vector const& b,
+	                   comp6771::euclidean_vector const& x) -> double {
+		auto ax = comp6771::euclidean_vector(x.dimensions());
+		a(x, ax);
+		return distance(b, ax);
+	}
+
+	using solver = comp6771::solver_result (*)(comp6771::linear_operator const&,
+	                                           comp6771::euclidean_vector const&,
+	                                           comp6771::euclidean_vector&,
+	                                           comp6771::solver_options const&);
+
+	auto const all_solvers = std::vector<solver>{comp6771::conjugate_gradient,
+	                                             comp6771::bicgstab,
+	                                             comp6771::gmres};
+	auto const general_solvers = std::vector<solver>{comp6771::bicgstab, comp6771::gmres};
+} // namespace
+
+TEST_CASE("Solvers converge") {
+	auto options = comp6771::solver_options();
+	options.tolerance = 1e-10;
+	options.restart = 200;
+
+	SECTION("on a symmetric positive definite system") {
+		auto const b = make_vector(100, 1);
+		for (auto const solve : all_solvers) {
+			auto x = comp6771::euclidean_vector(100);
+			auto const result = solve(poisson, b, x, options);
+			CHECK(result.converged);
+			CHECK(result.residual_norm <= 1e-10 * euclidean_norm(b));
+			CHECK(true_residual(poisson, b, x) <= 1e-9 * euclidean_norm(b));
+		}
+	}
+
+	SECTION("on a nonsymmetric system") {
+		auto const b = make_vector(300, 2);
+		for (auto const solve : general_solvers) {
+			auto x = make_vector(300, 3);
+			auto const result = solve(convection_diffusion, b, x, options);
+			CHECK(result.converged);
+			CHECK(true_residual(convection_diffusion, b, x) <= 1e-9 * euclidean_norm(b));
+		}
+	}
+}
+
+TEST_CASE("GMRES restarts") {
+	auto const b = make_vector(60, 4);
+	auto options = comp6771::solver_options();
+
+	SECTION("with a short basis") {
+		options.restart = 4;
+		auto x = comp6771::euclidean_vector(60);
+		auto const result = comp6771::gmres(convection_diffusion, b, x, options);
+		CHECK(result.converged);
+		CHECK(result.iterations > 4);
+		CHECK(true_residual(convection_diffusion, b, x) <= 1e-9 * euclidean_norm(b));
+	}
+
+	SECTION("with a basis as large as the system") {
+		// Without rounding error GMRES is exact after n steps
+		options.restart = 60;
+		auto x = comp6771::euclidean_vector(60);
+		auto const result = comp6771::gmres(poisson, b, x, options);
+		CHECK(result.converged);
+		CHECK(result.iterations <= 60);
+	}
+}
+
+TEST_CASE("Solvers handle edge cases") {
+	auto const b = make_vector(20, 5);
+
+	SECTION("an exact initial guess") {
+		for (auto const solve : all_solvers) {
+			auto x = comp6771::euclidean_vector(20, 1.0);
+			auto rhs = comp6771::euclidean_vector(20);
+			poisson(x, rhs);
+			auto const result = solve(poisson, rhs, x, {});
+			CHECK(result.converged);
+			CHECK(result.iterations == 0);
+			CHECK(x == comp6771::euclidean_vector(20, 1.0));
+		}
+	}
+
+	SECTION("a zero right-hand side") {
+		for (auto const solve : all_solvers) {
+			auto x = make_vector(20, 6);
+			auto const result = solve(poisson, comp6771::euclidean_vector(20), x, {});
+			CHECK(result.converged);
+			CHECK(result.iterations == 0);
+			CHECK(x == comp6771::euclidean_vector(20));
+		}
+	}
+
+	SECTION("too few iterations") {
+		auto options = comp6771::solver_options();
+		options.max_iterations = 3;
+		options.restart = 2;
+		for (auto const solve : all_solvers) {
+			auto x = comp6771::euclidean_vector(20);
+			auto const result = solve(poisson, b, x, options);
+			CHECK_FALSE(result.converged);
+			CHECK(result.iterations == 3);
+			CHECK(true_residual(poisson, b, x) < euclidean_norm(b));
+		}
+	}
+
+	SECTION("an indefinite matrix in conjugate_gradient") {
+		auto const indefinite = [](comp6771::euclidean_vector const& x,
+		                           comp6771::euclidean_vector& y) {
+			y[0] = x[0];
+			y[1] = -x[1];
+		};
+		auto x = comp6771::euclidean_vector(2);
+		auto const result =
+		   comp6771::conjugate_gradient(indefinite, comp6771::euclidean_vector{1.0, 1.0}, x);
+		CHECK_FALSE(result.converged);
+		CHECK(result.iterations == 1);
+	}
+
+	SECTION("invalid arguments") {
+		auto x = comp6771::euclidean_vector(19);
+		for (auto const solve : all_solvers) {
+			CHECK_THROWS_WITH(solve(poisson, b, x, {}),
+			                  "Dimensions of LHS(20) and RHS(19) do not match");
+
+			auto options = comp6771::solver_options();
+			options.tolerance = -1.0;
+			auto y = comp6771::euclidean_vector(20);
+			CHECK_THROWS_AS(solve(poisson, b, y, options), std::invalid_argument);
+
+			auto const resizing = [](comp6771::euclidean_vector const&,
+			                         comp6771::euclidean_vector& out) {
+				out = comp6771::euclidean_vector(3);
+			};
+			CHECK_THROWS_WITH(solve(resizing, b, y, {}),
+			                  "Dimensions of LHS(20) and RHS(3) do not match");
+		}
+
+		auto options = comp6771::solver_options();
+		options.restart = 0;
+		auto y = comp6771::euclidean_vector(20);
+		CHECK_THROWS_AS(comp6771::gmres(poisson, b, y, options), std::invalid_argument);
+	}
+}
+
+TEST_CASE("A sized workspace makes solves allocation-free") {
+	// Symmetric positive definite and well conditioned, so that restarted GMRES converges quickly
+	auto const a = tridiagonal(-1.0, 3.0, -1.0);
+	auto const b = make_vector(200, 7);
+	auto options = comp6771::solver_options();
+	options.restart = 10;
+	auto workspace = comp6771::krylov_workspace();
+
+	using workspace_solver = comp6771::solver_result (*)(comp6771::linear_operator const&,
+	                                                     comp6771::euclidean_vector const&,
+	                                                     comp6771::euclidean_vector&,
+	                                                     comp6771::solver_options const&,
+	                                                     comp6771::krylov_workspace&);
+	// GMRES first, since it needs the most vectors
+	for (auto const solve : {static_cast<workspace_solver>(comp6771::gmres),
+	                         static_cast<workspace_solver>(comp6771::conjugate_gradient),
+	                         static_cast<workspace_solver>(comp6771::bicgstab)}) {
+		auto x = comp6771::euclidean_vector(200);
+		solve(a, b, x, options, workspace);
+
+		auto y = comp6771::euclidean_vector(200);
+		allocations = 0;
+		counting_allocations = true;
+		auto const result = solve(a, b, y, options, workspace);
+		counting_allocations = false;
+		CHECK(result.converged);
+		CHECK(result.iterations > 10);
+		CHECK(allocations == 0);
+	}
+}
@@ -0,0 +1,187 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/lsh_index.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+LSH is probabilistic, so tests use the case it exists for, near-duplicate detection: each query is
+a slightly perturbed copy of a stored vector, which must be found nearly every time. Multi-probing
+must only ever add candidates. Removal is tested for both its effect on results and its
+bookkeeping (size, contains, id reuse). A batch insertion must build the same tables as inserting
+one at a time. Candidates are always checked exactly, so no result may be further away than
+reported.
+*/
+namespace {
+	auto make_corpus(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto perturb(comp6771::euclidean_vector v, double amount, unsigned seed)
+	   -> comp6771::euclidean_vector {
+		auto random = std::mt19937(seed);
+		auto noise = std::normal_distribution<double>(0.0, amount);
+		for (auto d = 0; d < v.dimensions(); ++d)
+			v[d] += noise(random);
+		return v;
+	}
+} // namespace
+
+TEST_CASE("Parameters are validated") {
+	using comp6771::lsh_family;
+	CHECK_THROWS_AS(comp6771::lsh_index(4, lsh_family::p_stable, {.tables = 0}),
+	                std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::lsh_index(4, lsh_family::p_stable, {.hash_bits = 65}),
+	                std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::lsh_index(4, lsh_family::p_stable, {.bucket_width = 0.0}),
+	                std::invalid_argument);
+
+	auto index = comp6771::lsh_index(4, lsh_family::random_hyperplane);
+	CHECK_THROWS_WITH(index.insert(comp6771::euclidean_vector(3)),
+	                  "Dimensions of LHS(4) and RHS(3) do not match");
+	CHECK_THROWS_WITH(index.query(comp6771::euclidean_vector(5), 1),
+	                  "Dimensions of LHS(4) and RHS(5) do not match");
+	CHECK(index.size() == 0);
+	CHECK(index.query(comp6771::euclidean_vector(4), 3).empty());
+}
+
+TEST_CASE("Near duplicates are found") {
+	auto const corpus = make_corpus(2000, 32, 1);
+	auto const family = GENERATE(comp6771::lsh_family::random_hyperplane,
+	                             comp6771::lsh_family::p_stable);
+	auto index = comp6771::lsh_index(32, family, {.tables = 10, .hash_bits = 10});
+	auto const ids = index.insert_all(corpus);
+	REQUIRE(index.size() == corpus.size());
+
+	auto found = 0;
+	for (auto i = std::size_t{0}; i < corpus.size(); i += 20) {
+		auto const query = perturb(corpus[i], 0.05, static_cast<unsigned>(i));
+		auto const result = index.query(query, 1, 2);
+		found += not result.empty() and result.front().id == ids[i];
+	}
+	CHECK(found >= 95);
+
+	// An exact copy always lands in its own bucket, at distance 0
+	for (auto i = std::size_t{0}; i < corpus.size(); i += 97) {
+		auto const result = index.query(corpus[i], 1);
+		REQUIRE(result.size() == 1);
+		CHECK(result.front().id == ids[i]);
+		CHECK(result.front().distance == Approx(0.0).margin(1e-12));
+	}
+}
+
+TEST_CASE("Results are ranked by their family's distance") {
+	auto const corpus = make_corpus(300, 8, 2);
+	auto const query = make_corpus(1, 8, 3).front();
+
+	SECTION("p_stable reports Euclidean distances") {
+		auto index = comp6771::lsh_index(8, comp6771::lsh_family::p_stable, {.hash_bits = 2});
+		index.insert_all(corpus);
+		auto const result = index.query(query, 10, 4);
+		REQUIRE(not result.empty());
+		CHECK(std::ranges::is_sorted(result, {}, &comp6771::neighbour::distance));
+		for (auto const& n : result)
+			CHECK(n.distance == Approx(distance(corpus[n.id], query)));
+	}
+
+	SECTION("random_hyperplane reports cosine distances") {
+		auto index = comp6771::lsh_index(8, comp6771::lsh_family::random_hyperplane, {.hash_bits = 3});
+		index.insert_all(corpus);
+		auto const result = index.query(query, 10, 4);
+		REQUIRE(not result.empty());
+		CHECK(std::ranges::is_sorted(result, {}, &comp6771::neighbour::distance));
+		for (auto const& n : result)
+			CHECK(n.distance == Approx(1 - cosine_similarity(corpus[n.id], query)));
+
+		// Scaling does not change the direction
+		auto const scaled = index.query(corpus[5] * 3.0, 1);
+		REQUIRE(scaled.size() == 1);
+		CHECK(scaled.front().id == 5);
+	}
+}
+
+TEST_CASE("Multi-probing only adds candidates") {
+	auto const corpus = make_corpus(3000, 16, 4);
+	auto const family = GENERATE(comp6771::lsh_family::random_hyperplane,
+	                             comp6771::lsh_family::p_stable);
+	auto index = comp6771::lsh_index(16, family, {.tables = 4, .hash_bits = 14});
+	index.insert_all(corpus);
+
+	auto grew = false;
+	for (auto const& query : make_corpus(20, 16, 5)) {
+		auto const base = index.candidates(query);
+		auto const probed = index.candidates(query, 16);
+		CHECK(std::ranges::includes(probed, base));
+		grew = grew or probed.size() > base.size();
+	}
+	CHECK(grew);
+}
+
+TEST_CASE("Insertion and removal") {
+	auto const corpus = make_corpus(500, 12, 6);
+	auto one_by_one = comp6771::lsh_index(12, comp6771::lsh_family::p_stable);
+	for (auto const& v : corpus)
+		one_by_one.insert(v);
+	auto batched = comp6771::lsh_index(12, comp6771::lsh_family::p_stable);
+	auto pool = comp6771::thread_pool(3);
+	auto const ids = batched.insert_all(corpus, pool);
+	CHECK(ids.front() == 0);
+	CHECK(ids.back() == 499);
+
+	for (auto const& query : make_corpus(10, 12, 7))
+		CHECK(one_by_one.candidates(query, 3) == batched.candidates(query, 3));
+	// A stored vector is hashed exactly as a query for it is, however it was inserted
+	for (auto id = std::size_t{0}; id < corpus.size(); ++id) {
+		CHECK(std::ranges::binary_search(one_by_one.candidates(corpus[id], 0), id));
+		CHECK(std::ranges::binary_search(batched.candidates(corpus[id], 0), id));
+	}
+
+	SECTION("Removed vectors are no longer found") {
+		for (auto id = std::size_t{0}; id < 500; id += 2)
+			batched.remove(id);
+		CHECK(batched.size() == 250);
+		CHECK(not batched.contains(10));
+		CHECK(batched.contains(11));
+		CHECK_THROWS_AS(batched.remove(10), std::out_of_range);
+		CHECK_THROWS_AS(batched.remove(500), std::out_of_range);
+
+		for (auto i = std::size_t{0}; i < corpus.size(); i += 25) {
+			auto const candidates = batched.candidates(corpus[i], 8);
+			CHECK(std::ranges::none_of(candidates, [](std::size_t id) { return id % 2 == 0; }));
+		}
+		CHECK(batched.query(corpus[11], 1).front().id == 11);
+
+		// Freed ids are reused
+		auto const reused = batched.insert(corpus[0]);
+		CHECK(reused % 2 == 0);
+		CHECK(reused < 500);
+		CHECK(batched.size() == 251);
+		CHECK(batched.query(corpus[0], 1).front().id == reused);
+	}
+
+	SECTION("An index can be emptied and refilled") {
+		for (auto id = std::size_t{0}; id < 500; ++id)
+			batched.remove(id);
+		CHECK(batched.size() == 0);
+		CHECK(batched.candidates(corpus[3], 8).empty());
+		batched.insert_all(std::span(corpus).first(10));
+		CHECK(batched.size() == 10);
+	}
+}
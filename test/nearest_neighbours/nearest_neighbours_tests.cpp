@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+Brute-force search is the reference that the approximate indexes are measured against, so it is
+checked against a naive sort on a corpus large enough to span several scan chunks, for both
+metrics and for more than one pool size. Tie-breaking by id is checked on duplicated vectors,
+since the indexes' recall relies on a stable answer. recall() is checked on hand-written lists.
+*/
+namespace {
+	auto make_corpus(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::uniform_real_distribution<double>(-1.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto naive_knn(std::vector<comp6771::euclidean_vector> const& corpus,
+	               comp6771::euclidean_vector const& query,
+	               std::size_t k,
+	               comp6771::search_metric metric) -> std::vector<comp6771::neighbour> {
+		auto all = std::vector<comp6771::neighbour>();
+		for (auto i = std::size_t{0}; i < corpus.size(); ++i)
+			all.push_back({i,
+			               metric == comp6771::search_metric::l2
+			                  ? euclidean_norm(corpus[i] - query)
+			                  : -dot(corpus[i], query)});
+		std::ranges::stable_sort(all, {}, &comp6771::neighbour::distance);
+		all.resize(k);
+		return all;
+	}
+} // namespace
+
+TEST_CASE("brute_force_knn matches a full sort") {
+	auto const corpus = make_corpus(10'000, 8, 1);
+	auto const queries = make_corpus(5, 8, 2);
+	auto pool = comp6771::thread_pool(3);
+
+	for (auto const metric : {comp6771::search_metric::l2, comp6771::search_metric::inner_product}) {
+		for (auto const& query : queries) {
+			auto const expected = naive_knn(corpus, query, 10, metric);
+			auto const found = comp6771::brute_force_knn(corpus, query, 10, metric, pool);
+			REQUIRE(found.size() == expected.size());
+			for (auto i = std::size_t{0}; i < found.size(); ++i) {
+				CHECK(found[i].id == expected[i].id);
+				CHECK(found[i].distance == Approx(expected[i].distance));
+			}
+		}
+
+		auto const batch = comp6771::brute_force_knn(corpus, queries, 10, metric, pool);
+		REQUIRE(batch.size() == queries.size());
+		for (auto q = std::size_t{0}; q < queries.size(); ++q)
+			CHECK(batch[q] == comp6771::brute_force_knn(corpus, queries[q], 10, metric));
+	}
+}
+
+TEST_CASE("brute_force_knn edge cases") {
+	auto const corpus = std::vector<comp6771::euclidean_vector>{
+	   comp6771::euclidean_vector{1, 1},
+	   comp6771::euclidean_vector{0, 0},
+	   comp6771::euclidean_vector{1, 1},
+	   comp6771::euclidean_vector{0, 0}};
+
+	SECTION("Equal distances are ordered by id") {
+		auto const found = comp6771::brute_force_knn(corpus, comp6771::euclidean_vector{0, 0}, 3);
+		REQUIRE(found.size() == 3);
+		CHECK(found[0] == comp6771::neighbour{1, 0.0});
+		CHECK(found[1] == comp6771::neighbour{3, 0.0});
+		CHECK(found[2].id == 0);
+	}
+
+	SECTION("k larger than the corpus returns everything") {
+		CHECK(comp6771::brute_force_knn(corpus, comp6771::euclidean_vector{0, 0}, 10).size() == 4);
+	}
+
+	SECTION("Mismatched dimensions throw") {
+		CHECK_THROWS_WITH(comp6771::brute_force_knn(corpus, comp6771::euclidean_vector{0, 0, 0}, 1),
+		                  "Dimensions of LHS(2) and RHS(3) do not match");
+	}
+}
+
+TEST_CASE("recall") {
+	auto const exact = std::vector<comp6771::neighbour>{{1, 0.0}, {2, 0.0}, {3, 0.0}, {4, 0.0}};
+	CHECK(comp6771::recall(exact, exact) == 1.0);
+	CHECK(comp6771::recall(std::vector<comp6771::neighbour>{{4, 0.0}, {9, 0.0}}, exact) == 0.25);
+	CHECK(comp6771::recall({}, exact) == 0.0);
+	CHECK(comp6771::recall(exact, {}) == 1.0);
+}
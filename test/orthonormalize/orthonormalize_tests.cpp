@@ -0,0 +1,210 @@
+#include <catch2/catch.hpp>
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/orthonormalize.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <vector>
+
+/*
+Testing rationale
+
+Both methods are checked against the defining properties of a QR factorisation rather than a
+reference: Q is orthonormal, R is upper triangular with a nonnegative diagonal, and Q R gives back
+the input. With a nonnegative diagonal the factorisation is unique, so the two methods must also
+agree with each other. Householder is run on sets wider than one panel. Nearly parallel inputs,
+which make a single pass of Gram-Schmidt lose orthogonality, check the second pass. Dependent
+vectors and sets larger than the dimensions check rank detection. orthogonalize() is checked on
+its own, since Krylov methods call it with one new vector at a time.
+*/
+namespace {
+	using comp6771::orthonormalization_method;
+
+	auto const all_methods = {orthonormalization_method::modified_gram_schmidt,
+	                          orthonormalization_method::householder};
+
+	auto make_vectors(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto largest_off_orthonormality(std::span<comp6771::euclidean_vector const> vectors) -> double {
+		auto largest = 0.0;
+		for (auto i = std::size_t{0}; i < vectors.size(); ++i)
+			for (auto j = i; j < vectors.size(); ++j) {
+				auto const expected = i == j ? 1.0 : 0.0;
+				largest = std::max(largest, std::abs(dot(vectors[i], vectors[j]) - expected));
+			}
+		return largest;
+	}
+
+	void check_factorisation(std::span<comp6771::euclidean_vector const> original,
+	                         std::span<comp6771::euclidean_vector const> q,
+	                         comp6771::dense_matrix const& r) {
+		auto const k = static_cast<int>(original.size());
+		REQUIRE(r.rows() == k);
+		REQUIRE(r.cols() == k);
+		for (auto row = 0; row < k; ++row) {
+			CHECK(r(row, row) >= 0.0);
+			for (auto col = 0; col < row; ++col)
+				CHECK(r(row, col) == 0.0);
+		}
+
+		for (auto col = 0; col < k; ++col) {
+			auto coefficients = std::vector<double>();
+			for (auto row = 0; row < k; ++row)
+				coefficients.push_back(r(row, col));
+			auto rebuilt = comp6771::euclidean_vector(original.front().dimensions());
+			lincomb(coefficients, q, rebuilt);
+			CHECK(approx_equal(rebuilt, original[static_cast<std::size_t>(col)], 1e-10, 1e-10));
+		}
+	}
+} // namespace
+
+TEST_CASE("Inputs are validated") {
+	auto vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector(3),
+	                                                       comp6771::euclidean_vector(4)};
+	for (auto const method : all_methods) {
+		CHECK_THROWS_WITH(comp6771::qr(vectors, method),
+		                  "Dimensions of LHS(3) and RHS(4) do not match");
+		CHECK_THROWS_WITH(comp6771::orthonormalize(vectors, method),
+		                  "Dimensions of LHS(3) and RHS(4) do not match");
+	}
+
+	auto none = std::vector<comp6771::euclidean_vector>();
+	CHECK(comp6771::orthonormalize(none) == 0);
+	CHECK(comp6771::qr(none).rows() == 0);
+
+	auto empty_vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector(0),
+	                                                             comp6771::euclidean_vector(0)};
+	for (auto const method : all_methods) {
+		auto const r = comp6771::qr(empty_vectors, method);
+		CHECK(r.rows() == 2);
+		CHECK(r(0, 0) == 0.0);
+		CHECK(r(1, 1) == 0.0);
+		CHECK(comp6771::orthonormalize(empty_vectors, method) == 0);
+	}
+
+	auto v = comp6771::euclidean_vector(3);
+	auto coefficients = std::vector<double>(1);
+	CHECK_THROWS_WITH(comp6771::orthogonalize(vectors, v, coefficients),
+	                  "Number of coefficients(1) and vectors(2) do not match");
+}
+
+TEST_CASE("QR factorises a set of vectors") {
+	auto pool = comp6771::thread_pool(4);
+	// 70 vectors covers more than two Householder panels
+	auto const count = GENERATE(std::size_t{1}, std::size_t{5}, std::size_t{70});
+	auto const original = make_vectors(count, 90, 1);
+
+	auto results = std::vector<std::vector<comp6771::euclidean_vector>>();
+	auto factors = std::vector<comp6771::dense_matrix>();
+	for (auto const method : all_methods) {
+		auto q = original;
+		auto const r = comp6771::qr(q, method, pool);
+		CHECK(largest_off_orthonormality(q) < 1e-12);
+		check_factorisation(original, q, r);
+		results.push_back(q);
+		factors.push_back(r);
+	}
+
+	for (auto i = std::size_t{0}; i < count; ++i)
+		CHECK(approx_equal(results[0][i], results[1][i], 1e-9, 1e-9));
+	for (auto row = 0; row < factors[0].rows(); ++row)
+		for (auto col = 0; col < factors[0].cols(); ++col)
+			CHECK(factors[0](row, col) == Approx(factors[1](row, col)).margin(1e-9));
+}
+
+TEST_CASE("Nearly parallel vectors stay orthogonal") {
+	// Unit vectors within about 1e-7 radians of each other: a single pass of modified
+	// Gram-Schmidt loses orthogonality in proportion to the condition number, about 1e7 here
+	auto const direction = comp6771::euclidean_vector(40, 1.0);
+	auto vectors = make_vectors(12, 40, 2);
+	for (auto& v : vectors) {
+		v *= 1e-7;
+		v += direction;
+	}
+
+	for (auto const method : all_methods) {
+		auto q = vectors;
+		CHECK(comp6771::orthonormalize(q, method) == q.size());
+		CHECK(largest_off_orthonormality(q) < 1e-12);
+	}
+}
+
+TEST_CASE("Dependent vectors are detected") {
+	SECTION("within the dimensions") {
+		auto vectors = make_vectors(5, 8, 3);
+		// Only vector 2 depends on the ones before it
+		vectors[2] = vectors[0] + vectors[1];
+
+		for (auto const method : all_methods) {
+			auto q = vectors;
+			CHECK(comp6771::orthonormalize(q, method) == 4);
+			CHECK(q[2] == comp6771::euclidean_vector(8));
+			auto const kept = std::vector<comp6771::euclidean_vector>{q[0], q[1], q[3], q[4]};
+			CHECK(largest_off_orthonormality(kept) < 1e-12);
+
+			auto r_input = vectors;
+			auto const r = comp6771::qr(r_input, method);
+			CHECK(r(2, 2) == Approx(0.0).margin(1e-12));
+			check_factorisation(vectors, r_input, r);
+		}
+	}
+
+	SECTION("past the dimensions") {
+		auto const vectors = make_vectors(6, 4, 4);
+		for (auto const method : all_methods) {
+			auto q = vectors;
+			CHECK(comp6771::orthonormalize(q, method) == 4);
+			CHECK(largest_off_orthonormality(std::span(q).first(4)) < 1e-12);
+			CHECK(q[4] == comp6771::euclidean_vector(4));
+			CHECK(q[5] == comp6771::euclidean_vector(4));
+		}
+	}
+
+	SECTION("zero vectors") {
+		auto vectors = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector(3),
+		                                                       comp6771::euclidean_vector{1, 2, 3}};
+		for (auto const method : all_methods) {
+			auto q = vectors;
+			CHECK(comp6771::orthonormalize(q, method) == 1);
+			CHECK(q[0] == comp6771::euclidean_vector(3));
+			CHECK(euclidean_norm(q[1]) == Approx(1.0));
+		}
+	}
+}
+
+TEST_CASE("orthogonalize() removes the components along a basis") {
+	auto basis = make_vectors(6, 20, 5);
+	REQUIRE(comp6771::orthonormalize(basis) == 6);
+
+	auto const original = make_vectors(1, 20, 6).front();
+	auto v = original;
+	auto coefficients = std::vector<double>(basis.size());
+	auto const length = comp6771::orthogonalize(basis, v, coefficients);
+
+	CHECK(length == Approx(euclidean_norm(v)));
+	for (auto i = std::size_t{0}; i < basis.size(); ++i) {
+		CHECK(dot(basis[i], v) == Approx(0.0).margin(1e-14));
+		CHECK(coefficients[i] == Approx(dot(basis[i], original)));
+	}
+
+	auto rebuilt = comp6771::euclidean_vector(20);
+	lincomb(coefficients, basis, rebuilt);
+	rebuilt += v;
+	CHECK(approx_equal(rebuilt, original, 1e-12, 1e-12));
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+#include <comp6771/dense_matrix.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/pairwise.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/*
+Testing rationale
+
+Every metric is checked entry by entry against the euclidean_vector friend function it mirrors,
+using collections larger than one tile and not a multiple of the tile size, so that the partial
+tiles at the right and bottom edges are covered. Streaming is then checked to deliver each entry
+exactly once, and the Gram matrix to be symmetric.
+*/
+namespace {
+	auto make_vectors(std::size_t count, int dimensions, double seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = std::sin(seed + static_cast<double>(i) * 1.3 + d * 0.7);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+} // namespace
+
+TEST_CASE("pairwise_matrix tests") {
+	auto pool = comp6771::thread_pool(3);
+	auto const x = make_vectors(300, 19, 0.0);
+	auto const y = make_vectors(270, 19, 2.0);
+
+	SECTION("pairwise_matrix matches the friend functions for every metric") {
+		auto const inner = comp6771::pairwise_matrix(x, y, comp6771::pairwise_metric::inner_product, pool);
+		auto const squared = comp6771::pairwise_matrix(x, y, comp6771::pairwise_metric::squared_l2, pool);
+		auto const l2 = comp6771::pairwise_matrix(x, y, comp6771::pairwise_metric::l2, pool);
+		auto const cosine = comp6771::pairwise_matrix(x, y, comp6771::pairwise_metric::cosine, pool);
+
+		CHECK(inner.rows() == 300);
+		CHECK(inner.cols() == 270);
+		auto mismatches = 0;
+		for (auto i = 0; i < 300; ++i)
+			for (auto j = 0; j < 270; ++j) {
+				auto const& a = x[static_cast<std::size_t>(i)];
+				auto const& b = y[static_cast<std::size_t>(j)];
+				mismatches += inner(i, j) != Approx(dot(a, b)).margin(1e-12);
+				mismatches += squared(i, j) != Approx(squared_distance(a, b)).margin(1e-12);
+				mismatches += l2(i, j) != Approx(distance(a, b)).margin(1e-6);
+				mismatches += cosine(i, j) != Approx(cosine_similarity(a, b)).margin(1e-12);
+			}
+		CHECK(mismatches == 0);
+	}
+
+	SECTION("pairwise_matrix of a collection with itself has a zero diagonal") {
+		auto const l2 = comp6771::pairwise_matrix(x, x, comp6771::pairwise_metric::l2);
+		for (auto i = 0; i < 300; ++i)
+			CHECK(l2(i, i) == Approx(0.0).margin(1e-6));
+	}
+
+	SECTION("pairwise_matrix throws for mismatched dimensions and zero vectors") {
+		auto const short_vectors = make_vectors(2, 18, 0.0);
+		REQUIRE_THROWS_WITH(comp6771::pairwise_matrix(x, short_vectors, comp6771::pairwise_metric::l2),
+		                    "Dimensions of LHS(19) and RHS(18) do not match");
+
+		auto const zero = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector(19)};
+		REQUIRE_THROWS_WITH(comp6771::pairwise_matrix(x, zero, comp6771::pairwise_metric::cosine),
+		                    "euclidean_vector with zero euclidean normal does not have a cosine "
+		                    "similarity");
+		CHECK(comp6771::pairwise_matrix(x, zero, comp6771::pairwise_metric::l2)(0, 0)
+		      == Approx(euclidean_norm(x[0])));
+	}
+}
+
+TEST_CASE("for_each_pairwise_tile tests") {
+	auto pool = comp6771::thread_pool(4);
+	auto const x = make_vectors(101, 7, 1.0);
+	auto const y = make_vectors(53, 7, 3.0);
+	auto const expected = comp6771::pairwise_matrix(x, y, comp6771::pairwise_metric::cosine);
+
+	auto mutex = std::mutex();
+	auto visits = std::vector<int>(101 * 53);
+	auto matches = true;
+	auto largest_tile = std::size_t{0};
+	comp6771::for_each_pairwise_tile(
+	   x,
+	   y,
+	   comp6771::pairwise_metric::cosine,
+	   [&](comp6771::pairwise_tile const& tile) {
+		   auto const lock = std::lock_guard(mutex);
+		   largest_tile = std::max({largest_tile, tile.rows, tile.cols});
+		   for (auto i = std::size_t{0}; i < tile.rows; ++i)
+			   for (auto j = std::size_t{0}; j < tile.cols; ++j) {
+				   auto const row = tile.row_offset + i;
+				   auto const col = tile.col_offset + j;
+				   ++visits[row * 53 + col];
+				   matches = matches
+				             and tile(i, j)
+				                    == expected(static_cast<int>(row), static_cast<int>(col));
+			   }
+	   },
+	   16,
+	   pool);
+
+	CHECK(largest_tile == 16);
+	CHECK(visits == std::vector<int>(101 * 53, 1));
+	CHECK(matches);
+}
+
+TEST_CASE("gram_matrix tests") {
+	auto const x = make_vectors(517, 11, 0.5);
+	auto const gram = comp6771::gram_matrix(x);
+
+	CHECK(gram.rows() == 517);
+	CHECK(gram.cols() == 517);
+	auto symmetric = true;
+	auto mismatches = 0;
+	for (auto i = 0; i < 517; ++i)
+		for (auto j = 0; j < 517; ++j) {
+			symmetric = symmetric and gram(i, j) == gram(j, i);
+			mismatches += gram(i, j)
+			              != Approx(dot(x[static_cast<std::size_t>(i)], x[static_cast<std::size_t>(j)]))
+			                    .margin(1e-12);
+		}
+	CHECK(symmetric);
+	CHECK(mismatches == 0);
+	CHECK(comp6771::gram_matrix(std::vector<comp6771::euclidean_vector>()).rows() == 0);
+}
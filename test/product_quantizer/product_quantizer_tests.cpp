@@ -0,0 +1,176 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/nearest_neighbours.hpp>
+#include <comp6771/product_quantizer.hpp>
+#include <comp6771/thread_pool.hpp>
+#include <comp6771/vector_file.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+Testing rationale
+
+Quantization is lossy, so the quantizer is tested on data it can represent exactly (few distinct
+sub-vectors) where encode/decode must round trip, and otherwise through invariants: the distance
+table must reproduce the exact distance to the decoded vector, and more centroids must not raise
+the reconstruction error. Search quality is checked as recall@10 against brute_force_knn, where
+re-ranking against the vector_file must do clearly better than codes alone. The vector_file is
+tested on its own for round trips and rejected input.
+*/
+namespace {
+	auto make_corpus(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto reconstruction_error(comp6771::product_quantizer const& pq,
+	                          std::vector<comp6771::euclidean_vector> const& vectors) -> double {
+		auto total = 0.0;
+		for (auto const& v : vectors)
+			total += squared_distance(pq.decode(pq.encode(v)), v);
+		return total;
+	}
+} // namespace
+
+TEST_CASE("Training validates its input") {
+	auto const training = make_corpus(50, 8, 1);
+	CHECK_THROWS_AS(comp6771::product_quantizer::train({}, 2), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::product_quantizer::train(training, 0), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::product_quantizer::train(training, 9), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::product_quantizer::train(training, 2, 257), std::invalid_argument);
+
+	auto const pq = comp6771::product_quantizer::train(training, 3);
+	CHECK(pq.dimensions() == 8);
+	CHECK(pq.code_size() == 3);
+	CHECK(pq.centroids() == 50);
+	CHECK_THROWS_WITH(pq.encode(comp6771::euclidean_vector(7)),
+	                  "Dimensions of LHS(8) and RHS(7) do not match");
+	CHECK_THROWS_AS(pq.decode(std::vector<std::uint8_t>{0, 0}), std::invalid_argument);
+}
+
+TEST_CASE("Representable data round trips") {
+	// Each half of every vector is one of four patterns, so four centroids per subspace suffice.
+	// Centroids are means of equal values, so they may be an ulp off.
+	auto const patterns = make_corpus(4, 3, 2);
+	auto vectors = std::vector<comp6771::euclidean_vector>();
+	for (auto i = std::size_t{0}; i < 4; ++i)
+		for (auto j = std::size_t{0}; j < 4; ++j)
+			for (auto copy = 0; copy < 3; ++copy)
+				vectors.push_back(comp6771::euclidean_vector{patterns[i][0],
+				                                             patterns[i][1],
+				                                             patterns[i][2],
+				                                             patterns[j][0],
+				                                             patterns[j][1],
+				                                             patterns[j][2]});
+
+	auto const pq = comp6771::product_quantizer::train(vectors, 2, 4);
+	auto const codes = pq.encode_all(vectors);
+	REQUIRE(codes.size() == 2 * vectors.size());
+	for (auto i = std::size_t{0}; i < vectors.size(); ++i) {
+		auto const code = std::span(codes).subspan(2 * i, 2);
+		CHECK(approx_equal(pq.decode(code), vectors[i], 1e-12, 1e-12));
+		CHECK(pq.encode(vectors[i]) == std::vector<std::uint8_t>(code.begin(), code.end()));
+	}
+}
+
+TEST_CASE("Distance tables match the decoded vectors") {
+	auto const training = make_corpus(600, 10, 3);
+	// 10 dimensions over 4 subspaces gives uneven widths
+	auto const pq = comp6771::product_quantizer::train(training, 4, 32);
+	auto const query = make_corpus(1, 10, 4).front();
+
+	auto const l2 = pq.distance_table(query, comp6771::search_metric::l2);
+	auto const ip = pq.distance_table(query, comp6771::search_metric::inner_product);
+	REQUIRE(l2.size() == 4 * 32);
+	for (auto i = std::size_t{0}; i < training.size(); i += 37) {
+		auto const code = pq.encode(training[i]);
+		auto const decoded = pq.decode(code);
+		CHECK(pq.adc_distance(l2, code) == Approx(squared_distance(decoded, query)));
+		CHECK(pq.adc_distance(ip, code) == Approx(-dot(decoded, query)));
+	}
+}
+
+TEST_CASE("More centroids lower the reconstruction error") {
+	auto const training = make_corpus(1000, 8, 5);
+	auto const coarse = comp6771::product_quantizer::train(training, 4, 4);
+	auto const fine = comp6771::product_quantizer::train(training, 4, 64);
+	auto const finer = comp6771::product_quantizer::train(training, 8, 64);
+	CHECK(reconstruction_error(fine, training) < reconstruction_error(coarse, training));
+	CHECK(reconstruction_error(finer, training) < reconstruction_error(fine, training));
+}
+
+TEST_CASE("vector_file") {
+	auto const path = std::string("product_quantizer_tests_vectors.bin");
+	auto const vectors = make_corpus(20, 5, 6);
+	comp6771::vector_file::write(path, vectors);
+
+	auto const file = comp6771::vector_file(path);
+	CHECK(file.size() == 20);
+	CHECK(file.dimensions() == 5);
+	for (auto i = std::size_t{0}; i < vectors.size(); ++i)
+		CHECK(file.read(i) == vectors[i]);
+	CHECK_THROWS_AS(file.read(20), std::out_of_range);
+
+	auto const mismatched = std::vector<comp6771::euclidean_vector>{comp6771::euclidean_vector(2),
+	                                                                comp6771::euclidean_vector(3)};
+	CHECK_THROWS_WITH(comp6771::vector_file::write(path, mismatched),
+	                  "Dimensions of LHS(2) and RHS(3) do not match");
+	CHECK_THROWS_AS(comp6771::vector_file("does/not/exist.bin"), std::runtime_error);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("pq_index search") {
+	auto const corpus = make_corpus(3000, 32, 7);
+	auto const queries = make_corpus(30, 32, 8);
+	auto pool = comp6771::thread_pool(3);
+	auto const pq =
+	   comp6771::product_quantizer::train(std::span(corpus).first(1500), 8, 64, {}, pool);
+
+	auto index = comp6771::pq_index(pq);
+	CHECK(index.add_all(std::span(corpus).first(1000), pool) == 0);
+	CHECK(index.add_all(std::span(corpus).subspan(1000), pool) == 1000);
+	REQUIRE(index.size() == corpus.size());
+	CHECK(index.code(5).size() == 8);
+
+	auto const path = std::string("product_quantizer_tests_corpus.bin");
+	comp6771::vector_file::write(path, corpus);
+	auto const originals = comp6771::vector_file(path);
+
+	auto codes_only = 0.0;
+	auto reranked = 0.0;
+	for (auto const& query : queries) {
+		auto const exact = comp6771::brute_force_knn(corpus, query, 10);
+		auto const approximate = index.search(query, 10, pool);
+		REQUIRE(approximate.size() == 10);
+		CHECK(std::ranges::is_sorted(approximate, {}, &comp6771::neighbour::distance));
+		codes_only += comp6771::recall(approximate, exact);
+
+		auto const refined = index.search(query, 10, 200, originals, pool);
+		REQUIRE(refined.size() == 10);
+		reranked += comp6771::recall(refined, exact);
+		// Re-ranked distances are exact
+		for (auto const& n : refined)
+			CHECK(n.distance == Approx(distance(corpus[n.id], query)));
+
+		CHECK(approximate == index.search(query, 10, comp6771::default_thread_pool()));
+	}
+	codes_only /= static_cast<double>(queries.size());
+	reranked /= static_cast<double>(queries.size());
+	CHECK(codes_only >= 0.3);
+	CHECK(reranked >= 0.9);
+	CHECK(reranked > codes_only);
+	std::remove(path.c_str());
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/quantized_euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+Quantization is checked against its contract: every dequantized magnitude lies within half a step
+of the original, and the extremes of the range map to -127 and 127. The integer dot and distance
+kernels are checked against the same operations on the dequantized euclidean_vectors, which they
+must match to rounding, including vectors long enough to cross a 32-bit accumulation run. Edge
+cases are constant vectors (a zero scale), empty vectors, non-finite input, and finite input whose
+range overflows.
+*/
+namespace {
+	auto make_vector(int dimensions, double low, double high, unsigned seed)
+	   -> comp6771::euclidean_vector {
+		auto random = std::mt19937(seed);
+		auto value = std::uniform_real_distribution<double>(low, high);
+		auto v = comp6771::euclidean_vector(dimensions);
+		for (auto i = 0; i < dimensions; ++i)
+			v[i] = value(random);
+		return v;
+	}
+} // namespace
+
+TEST_CASE("Quantizing") {
+	auto const v = make_vector(300, -3.0, 5.0, 1);
+	auto const q = comp6771::quantized_euclidean_vector(v);
+	REQUIRE(q.dimensions() == 300);
+
+	SECTION("Every magnitude is within half a step") {
+		for (auto i = 0; i < v.dimensions(); ++i)
+			CHECK(std::fabs(q[i] - v[i]) <= q.scale() / 2 * (1 + 1e-12));
+		CHECK(approx_equal(q.dequantize(), static_cast<comp6771::euclidean_vector>(q), 0.0, 0.0));
+	}
+
+	SECTION("The range is spread over [-127, 127]") {
+		CHECK(std::ranges::min(q.values()) == -127);
+		CHECK(std::ranges::max(q.values()) == 127);
+	}
+
+	SECTION("The norm is the original's") {
+		CHECK(euclidean_norm(q) == euclidean_norm(v));
+	}
+}
+
+TEST_CASE("Quantizing edge cases") {
+	SECTION("Constant vectors are exact") {
+		auto const q = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector(5, 2.5));
+		CHECK(q.scale() == 0.0);
+		CHECK(q.dequantize() == comp6771::euclidean_vector(5, 2.5));
+		CHECK(dot(q, q) == Approx(31.25));
+		CHECK(distance(q, q) == 0.0);
+	}
+
+	SECTION("Empty vectors") {
+		auto const q = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector(0));
+		CHECK(q.dimensions() == 0);
+		CHECK(euclidean_norm(q) == 0.0);
+		CHECK(dot(q, q) == 0.0);
+	}
+
+	SECTION("Non-finite magnitudes throw") {
+		auto const infinity = std::numeric_limits<double>::infinity();
+		CHECK_THROWS_AS(comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{1, infinity}),
+		                std::invalid_argument);
+		auto const nan = std::numeric_limits<double>::quiet_NaN();
+		CHECK_THROWS_AS(comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{nan}),
+		                std::invalid_argument);
+	}
+
+	SECTION("Magnitudes whose range overflows are quantized") {
+		auto const v = comp6771::euclidean_vector{-1e308, 0.5e308, 1e308};
+		auto const q = comp6771::quantized_euclidean_vector(v);
+		CHECK(q.offset() == 0.0);
+		CHECK(std::isfinite(q.scale()));
+		CHECK(q.values().front() == -127);
+		CHECK(q.values().back() == 127);
+		for (auto i = 0; i < v.dimensions(); ++i)
+			CHECK(std::fabs(q[i] - v[i]) <= q.scale() / 2 * (1 + 1e-12));
+
+		auto const dequantized = q.dequantize();
+		CHECK(std::isfinite(dequantized[0]));
+		CHECK(std::isfinite(dequantized[2]));
+		auto const ones = comp6771::euclidean_vector(3, 1.0);
+		CHECK(dot(q, ones) == Approx(dot(dequantized, ones)));
+	}
+}
+
+TEST_CASE("Integer kernels match the dequantized vectors") {
+	// 70000 dimensions crosses the 32-bit accumulation runs
+	auto const dimensions = GENERATE(1, 7, 64, 70000);
+	auto const x = comp6771::quantized_euclidean_vector(make_vector(dimensions, -1.0, 2.0, 2));
+	auto const y = comp6771::quantized_euclidean_vector(make_vector(dimensions, -4.0, 0.5, 3));
+	auto const dx = x.dequantize();
+	auto const dy = y.dequantize();
+
+	CHECK(dot(x, y) == Approx(dot(dx, dy)).margin(1e-9));
+	CHECK(squared_distance(x, y) == Approx(squared_distance(dx, dy)).margin(1e-9));
+	CHECK(distance(x, y) == Approx(distance(dx, dy)).margin(1e-9));
+
+	auto const query = make_vector(dimensions, -1.0, 1.0, 4);
+	CHECK(dot(x, query) == Approx(dot(dx, query)).margin(1e-9));
+
+	// Sharing a scale and offset takes the exact integer path
+	auto const shifted = comp6771::quantized_euclidean_vector(dx * 1.0);
+	CHECK(squared_distance(x, shifted) == Approx(0.0).margin(1e-9));
+}
+
+TEST_CASE("Shared scale and offset") {
+	auto const a = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{0, 1, 2, 3, 4});
+	auto const b = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{4, 3, 2, 1, 0});
+	REQUIRE(a.scale() == b.scale());
+	REQUIRE(a.offset() == b.offset());
+	CHECK(squared_distance(a, b)
+	      == Approx(squared_distance(a.dequantize(), b.dequantize())).margin(1e-12));
+	CHECK(distance(a, b) == Approx(std::sqrt(40.0)).epsilon(0.01));
+}
+
+TEST_CASE("Dimension mismatches throw") {
+	auto const a = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{1, 2});
+	auto const b = comp6771::quantized_euclidean_vector(comp6771::euclidean_vector{1, 2, 3});
+	CHECK_THROWS_WITH(dot(a, b), "Dimensions of LHS(2) and RHS(3) do not match");
+	CHECK_THROWS_WITH(squared_distance(a, b), "Dimensions of LHS(2) and RHS(3) do not match");
+	CHECK_THROWS_WITH(dot(a, comp6771::euclidean_vector(1)),
+	                  "Dimensions of LHS(2) and RHS(1) do not match");
+}
+
+TEST_CASE("quantize_all") {
+	auto vectors = std::vector<comp6771::euclidean_vector>();
+	for (auto i = 0u; i < 100; ++i)
+		vectors.push_back(make_vector(16, -1.0, 1.0, i));
+	auto pool = comp6771::thread_pool(3);
+	auto const quantized = comp6771::quantize_all(vectors, pool);
+	REQUIRE(quantized.size() == vectors.size());
+	for (auto i = std::size_t{0}; i < vectors.size(); ++i)
+		CHECK(quantized[i] == comp6771::quantized_euclidean_vector(vectors[i]));
+
+	vectors[50][3] = std::numeric_limits<double>::infinity();
+	CHECK_THROWS_AS(comp6771::quantize_all(vectors, pool), std::invalid_argument);
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/random_projection.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+/*
+Testing rationale
+
+Each kind is checked for the Johnson-Lindenstrauss property it promises: squared lengths and
+pairwise distances are preserved on average, and individually within a loose tolerance at the
+chosen output size. Projections must be linear and reproducible from the seed. The batched path
+must agree with projecting one vector at a time, across a gemm block boundary, and must reuse
+output storage. fast_hadamard is also tested on an input size that is not a power of two.
+*/
+namespace {
+	auto make_vectors(std::size_t count, int dimensions, unsigned seed)
+	   -> std::vector<comp6771::euclidean_vector> {
+		auto random = std::mt19937(seed);
+		auto value = std::normal_distribution<double>(0.0, 1.0);
+		auto vectors = std::vector<comp6771::euclidean_vector>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			auto v = comp6771::euclidean_vector(dimensions);
+			for (auto d = 0; d < dimensions; ++d)
+				v[d] = value(random);
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	auto const all_kinds = {comp6771::random_projection_kind::gaussian,
+	                        comp6771::random_projection_kind::achlioptas,
+	                        comp6771::random_projection_kind::fast_hadamard};
+} // namespace
+
+TEST_CASE("Construction is validated") {
+	using comp6771::random_projection_kind;
+	CHECK_THROWS_AS(comp6771::random_projection(0, 4), std::invalid_argument);
+	CHECK_THROWS_AS(comp6771::random_projection(4, 0), std::invalid_argument);
+	// 5 inputs pad to 8, so at most 8 outputs
+	CHECK_NOTHROW(comp6771::random_projection(5, 8, random_projection_kind::fast_hadamard));
+	CHECK_THROWS_AS(comp6771::random_projection(5, 9, random_projection_kind::fast_hadamard),
+	                std::invalid_argument);
+
+	auto const projection = comp6771::random_projection(6, 3);
+	CHECK(projection.input_dimensions() == 6);
+	CHECK(projection.output_dimensions() == 3);
+	CHECK_THROWS_WITH(projection.apply(comp6771::euclidean_vector(5)),
+	                  "Dimensions of LHS(6) and RHS(5) do not match");
+}
+
+TEST_CASE("Distances are preserved") {
+	auto const vectors = make_vectors(60, 600, 1);
+	for (auto const kind : all_kinds) {
+		auto const projection = comp6771::random_projection(600, 256, kind, 7);
+		auto const projected = projection.apply_all(vectors);
+
+		auto ratio_sum = 0.0;
+		auto pairs = 0;
+		for (auto i = std::size_t{0}; i < vectors.size(); ++i) {
+			for (auto j = i + 1; j < vectors.size(); j += 7) {
+				auto const ratio = squared_distance(projected[i], projected[j])
+				                   / squared_distance(vectors[i], vectors[j]);
+				CHECK(ratio > 0.6);
+				CHECK(ratio < 1.4);
+				ratio_sum += ratio;
+				++pairs;
+			}
+		}
+		CHECK(ratio_sum / pairs == Approx(1.0).epsilon(0.05));
+	}
+}
+
+TEST_CASE("Projections are linear and reproducible") {
+	auto const vectors = make_vectors(3, 100, 2);
+	for (auto const kind : all_kinds) {
+		auto const projection = comp6771::random_projection(100, 20, kind, 3);
+		auto const sum = projection.apply(vectors[0] + vectors[1] * 2.0);
+		auto const parts = projection.apply(vectors[0]) + projection.apply(vectors[1]) * 2.0;
+		CHECK(approx_equal(sum, parts, 1e-10, 1e-10));
+
+		CHECK(comp6771::random_projection(100, 20, kind, 3).apply(vectors[2])
+		      == projection.apply(vectors[2]));
+		CHECK(comp6771::random_projection(100, 20, kind, 4).apply(vectors[2])
+		      != projection.apply(vectors[2]));
+	}
+}
+
+TEST_CASE("Batches match single projections") {
+	// More than one gemm block of 1024
+	auto const vectors = make_vectors(1100, 37, 4);
+	auto pool = comp6771::thread_pool(3);
+	for (auto const kind : all_kinds) {
+		auto const projection = comp6771::random_projection(37, 16, kind, 5);
+		auto out =
+		   std::vector<comp6771::euclidean_vector>(vectors.size(), comp6771::euclidean_vector(16));
+		auto const* const storage = out[1050].data();
+		projection.apply_all(vectors, out, pool);
+		CHECK(out[1050].data() == storage);
+
+		for (auto i = std::size_t{0}; i < vectors.size(); i += 50)
+			CHECK(approx_equal(out[i], projection.apply(vectors[i]), 1e-12, 1e-12));
+		CHECK(euclidean_norm(out[3]) == Approx(euclidean_norm(projection.apply(vectors[3]))));
+
+		auto too_few = std::vector<comp6771::euclidean_vector>(5);
+		CHECK_THROWS_WITH(projection.apply_all(vectors, too_few, pool),
+		                  "Number of vectors(1100) and outputs(5) do not match");
+	}
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+#include <comp6771/euclidean_vector.hpp>
+#include <comp6771/thread_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+Testing rationale
+
+The pool is tested on its own first: every index must be visited exactly once, subranges must
+respect the grain, and exceptions and nested loops must come back out of parallel_for. Pools are
+built with an explicit thread count so that stealing happens even on a single-core machine. The
+batch functions that run on a pool are then checked to give the same results as a plain loop.
+*/
+namespace {
+	// Runs parallel_for and records how many times each index was visited
+	auto visit_counts(comp6771::thread_pool& pool, std::size_t n, std::size_t grain)
+	   -> std::vector<int> {
+		auto counts = std::vector<std::atomic<int>>(n);
+		pool.parallel_for(n, grain, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				counts[i].fetch_add(1);
+		});
+		auto result = std::vector<int>();
+		for (auto const& count : counts)
+			result.push_back(count.load());
+		return result;
+	}
+} // namespace
+
+TEST_CASE("thread_pool parallel_for tests") {
+	auto pool = comp6771::thread_pool(4);
+	CHECK(pool.size() == 4);
+
+	SECTION("parallel_for visits every index exactly once") {
+		for (auto grain : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{5000}}) {
+			CHECK(visit_counts(pool, 10007, grain) == std::vector<int>(10007, 1));
+		}
+		CHECK(visit_counts(pool, 0, 1).empty());
+	}
+
+	SECTION("parallel_for never splits below the grain") {
+		auto mutex = std::mutex();
+		auto sizes = std::vector<std::size_t>();
+		pool.parallel_for(1000, 64, [&](std::size_t first, std::size_t last) {
+			auto const lock = std::lock_guard(mutex);
+			sizes.push_back(last - first);
+		});
+
+		CHECK(sizes.size() > 1);
+		for (auto size : sizes)
+			CHECK(size >= 64);
+	}
+
+	SECTION("parallel_for rethrows an exception from the loop body") {
+		auto const throwing = [](std::size_t first, std::size_t last) {
+			if (first <= 500 and 500 < last)
+				throw std::runtime_error("bad index");
+		};
+		REQUIRE_THROWS_WITH(pool.parallel_for(1000, 1, throwing), "bad index");
+		CHECK(visit_counts(pool, 100, 1) == std::vector<int>(100, 1));
+	}
+
+	SECTION("nested parallel_for calls complete") {
+		auto total = std::atomic<std::size_t>(0);
+		pool.parallel_for(16, 1, [&](std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i)
+				pool.parallel_for(100, 1, [&](std::size_t inner_first, std::size_t inner_last) {
+					total.fetch_add(inner_last - inner_first);
+				});
+		});
+		CHECK(total.load() == 1600);
+	}
+
+	SECTION("parallel_for_each calls the function on every element") {
+		auto values = std::vector<int>(513, 1);
+		pool.parallel_for_each(std::span<int>(values), [](int& value) { value *= 3; }, 16);
+		CHECK(values == std::vector<int>(513, 3));
+	}
+}
+
+TEST_CASE("thread_pool construction tests") {
+	SECTION("a pool of one runs on the calling thread") {
+		auto pool = comp6771::thread_pool(1);
+		auto const caller = std::this_thread::get_id();
+		auto same_thread = true;
+		pool.parallel_for(100, 1, [&](std::size_t, std::size_t) {
+			same_thread = same_thread and std::this_thread::get_id() == caller;
+		});
+		CHECK(same_thread);
+	}
+
+	SECTION("pinned pools and the default pool run work") {
+		auto pinned = comp6771::thread_pool(3, comp6771::thread_affinity::pinned);
+		CHECK(visit_counts(pinned, 999, 1) == std::vector<int>(999, 1));
+		CHECK(comp6771::default_thread_pool().size() >= 1);
+		CHECK(visit_counts(comp6771::default_thread_pool(), 999, 0) == std::vector<int>(999, 1));
+	}
+}
+
+TEST_CASE("thread_pool batch function tests") {
+	auto pool = comp6771::thread_pool(3);
+	auto vectors = std::vector<comp6771::euclidean_vector>();
+	for (auto i = 1; i <= 50; ++i)
+		vectors.emplace_back(i % 7 + 1, static_cast<double>(i));
+
+	SECTION("normalize_all on a pool normalises every euclidean_vector") {
+		comp6771::normalize_all(vectors, pool);
+		for (auto const& v : vectors)
+			CHECK(euclidean_norm(v) == Approx(1.0));
+	}
+
+	SECTION("normalize_all on a pool stops at the first euclidean_vector without a unit vector") {
+		vectors[20] = comp6771::euclidean_vector(3, 0.0);
+		vectors[30] = comp6771::euclidean_vector(0);
+		auto const untouched = vectors[40];
+
+		REQUIRE_THROWS_WITH(comp6771::normalize_all(vectors, pool),
+		                    "euclidean_vector with zero euclidean normal does not have a unit vector");
+		CHECK(euclidean_norm(vectors[19]) == Approx(1.0));
+		CHECK(vectors[40] == untouched);
+	}
+
+	SECTION("find_equal and cosine_similarity on a pool match a loop") {
+		vectors[45] = vectors[3];
+		CHECK(comp6771::find_equal(vectors, vectors[3], pool) == std::vector<std::size_t>{3, 45});
+
+		auto const candidates = std::vector<comp6771::euclidean_vector>{vectors[0] * 2,
+		                                                                vectors[7],
+		                                                                -vectors[0],
+		                                                                vectors[0]};
+		auto const similarities = comp6771::cosine_similarity(candidates[3], candidates, pool);
+		CHECK(similarities.size() == 4);
+		CHECK(similarities[0] == Approx(1.0));
+		CHECK(similarities[1] == Approx(1.0));
+		CHECK(similarities[2] == Approx(-1.0));
+		CHECK(similarities[3] == Approx(1.0));
+	}
+}